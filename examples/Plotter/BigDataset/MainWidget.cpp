@@ -66,6 +66,8 @@ MainWidget::MainWidget()
     m_plotter = new KDChart::Plotter;
     // 设置绘图仪的数据模型
     m_plotter->setModel(&m_model);
+    // 使用LTTB降采样，使重绘开销与数据点数量无关
+    m_plotter->setUseDataCompression(KDChart::Plotter::LTTB);
     // TODO: Qt5.15.2升级 检查KDChartAbstractDiagram::Private::get方法是否有变更
     // 启用绘制时间输出，用于性能分析
     KDChart::AbstractDiagram::Private::get(m_plotter)->doDumpPaintTime = true;
@@ -14,6 +14,7 @@
 #include <KDChartDataValueAttributes>
 #include <KDChartGlobal>
 #include <KDChartLineDiagram>
+#include <QStandardItemModel>
 #include <QtTest/QtTest>
 #include <TableModel.h>
 
@@ -137,6 +138,127 @@ private slots:
         QCOMPARE(b.isVisible(), false); // No sharing
     }
 
+    void testKDChartAttributesModelCellAttributes()
+    {
+        QStandardItemModel source(10, 4);
+        AttributesModel attributes(&source, nullptr);
+        QVERIFY(!attributes.hasCellAttributes(DatasetPenRole));
+
+        const QPen datasetPen(Qt::red);
+        const QPen cellPen(Qt::blue);
+        attributes.setHeaderData(1, Qt::Horizontal, QVariant::fromValue(datasetPen), DatasetPenRole);
+        QCOMPARE(attributes.attribute<QPen>(attributes.index(5, 1), DatasetPenRole), datasetPen);
+
+        // a cell attribute overrides the dataset attribute of this cell only
+        attributes.setData(attributes.index(5, 1), QVariant::fromValue(cellPen), DatasetPenRole);
+        QVERIFY(attributes.hasCellAttributes(DatasetPenRole));
+        QCOMPARE(attributes.attribute<QPen>(attributes.index(5, 1), DatasetPenRole), cellPen);
+        QCOMPARE(attributes.data(attributes.index(5, 1), DatasetPenRole).value<QPen>(), cellPen);
+        QCOMPARE(attributes.attribute<QPen>(attributes.index(4, 1), DatasetPenRole), datasetPen);
+
+        // changing the dataset attribute is seen by all cells without their own attribute
+        const QPen otherPen(Qt::green);
+        attributes.setHeaderData(1, Qt::Horizontal, QVariant::fromValue(otherPen), DatasetPenRole);
+        QCOMPARE(attributes.attribute<QPen>(attributes.index(4, 1), DatasetPenRole), otherPen);
+        QCOMPARE(attributes.attribute<QPen>(attributes.index(5, 1), DatasetPenRole), cellPen);
+
+        // removing a column moves the attributes of the columns behind it
+        source.removeColumn(0);
+        QCOMPARE(attributes.attribute<QPen>(attributes.index(5, 0), DatasetPenRole), cellPen);
+        QVERIFY(attributes.attribute<QPen>(attributes.index(5, 1), DatasetPenRole) != cellPen);
+
+        // resetting the only cell attribute leaves no cell attributes
+        attributes.resetData(attributes.index(5, 0), DatasetPenRole);
+        QVERIFY(!attributes.hasCellAttributes(DatasetPenRole));
+        QVERIFY(attributes.attribute<QPen>(attributes.index(5, 0), DatasetPenRole) != cellPen);
+
+        AttributesModel copy(&source, nullptr);
+        copy.initFrom(&attributes);
+        QVERIFY(copy.compare(&attributes));
+        copy.setData(copy.index(2, 2), true, DataHiddenRole);
+        QVERIFY(!copy.compare(&attributes));
+
+        // cells set in any order, overwritten and reset are found by their row
+        AttributesModel sparse(&source, nullptr);
+        for (int row : {7, 2, 9, 0, 2}) {
+            sparse.setData(sparse.index(row, 1), QVariant::fromValue(QPen(QColor(row, 0, 0))), DatasetPenRole);
+        }
+        sparse.resetData(sparse.index(9, 1), DatasetPenRole);
+        sparse.resetData(sparse.index(4, 1), DatasetPenRole);
+        for (int row = 0; row < 10; ++row) {
+            const bool hasPen = row == 0 || row == 2 || row == 7;
+            QCOMPARE(sparse.data(sparse.index(row, 1), DatasetPenRole).value<QPen>() == QPen(QColor(row, 0, 0)), hasPen);
+        }
+        AttributesModel reordered(&source, nullptr);
+        for (int row : {0, 7, 2}) {
+            reordered.setData(reordered.index(row, 1), QVariant::fromValue(QPen(QColor(row, 0, 0))), DatasetPenRole);
+        }
+        QVERIFY(reordered.compare(&sparse));
+        reordered.resetData(reordered.index(0, 1), DatasetPenRole);
+        QVERIFY(!reordered.compare(&sparse));
+    }
+
+    void testKDChartAttributesModelSourceSuppliesRole()
+    {
+        QStandardItemModel source(10, 3);
+        AttributesModel attributes(&source, nullptr);
+        source.setData(source.index(5, 1), QVariant::fromValue(QPen(Qt::green)), DatasetPenRole);
+        QVERIFY(!attributes.sourceSuppliesRole(0, DatasetPenRole));
+        QVERIFY(attributes.sourceSuppliesRole(1, DatasetPenRole));
+        QVERIFY(!attributes.sourceSuppliesRole(1, DatasetBrushRole));
+        QVERIFY(!attributes.sourceSuppliesRole(3, DatasetPenRole));
+
+        // changed and inserted cells are seen after the columns were searched
+        QVERIFY(!attributes.sourceSuppliesRole(2, DatasetPenRole));
+        source.setData(source.index(8, 2), QVariant::fromValue(QPen(Qt::blue)), DatasetPenRole);
+        QVERIFY(attributes.sourceSuppliesRole(2, DatasetPenRole));
+        auto *insertedItem = new QStandardItem();
+        insertedItem->setData(QVariant::fromValue(QPen(Qt::red)), DatasetPenRole);
+        source.insertRow(10, insertedItem);
+        QVERIFY(attributes.sourceSuppliesRole(0, DatasetPenRole));
+
+        // a reset searches the columns again
+        source.clear();
+        source.setRowCount(4);
+        source.setColumnCount(3);
+        QVERIFY(!attributes.sourceSuppliesRole(0, DatasetPenRole));
+        QVERIFY(!attributes.sourceSuppliesRole(1, DatasetPenRole));
+    }
+
+    void testKDChartAttributesModelSourceSuppliesRoleBelowRoot()
+    {
+        QStandardItemModel source(2, 1);
+        auto *parentItem = new QStandardItem();
+        parentItem->setColumnCount(2);
+        parentItem->appendRow({new QStandardItem(), new QStandardItem()});
+        parentItem->appendRow({new QStandardItem(), new QStandardItem()});
+        source.setItem(1, 0, parentItem);
+        AttributesModel attributes(&source, nullptr);
+        const QModelIndex root = attributes.mapFromSource(parentItem->index());
+
+        QVERIFY(!attributes.sourceSuppliesRole(1, DatasetPenRole, root));
+        // the cached result of the root follows changes below it
+        parentItem->child(1, 1)->setData(QVariant::fromValue(QPen(Qt::red)), DatasetPenRole);
+        QVERIFY(attributes.sourceSuppliesRole(1, DatasetPenRole, root));
+        QVERIFY(!attributes.sourceSuppliesRole(0, DatasetPenRole, root));
+        QVERIFY(!attributes.sourceSuppliesRole(0, DatasetPenRole));
+
+        // rows removed above the root do not mix its cache up with the top level's
+        source.removeRow(0);
+        QVERIFY(!attributes.sourceSuppliesRole(0, DatasetPenRole));
+        QVERIFY(attributes.sourceSuppliesRole(1, DatasetPenRole, attributes.mapFromSource(parentItem->index())));
+    }
+
+    void testKDChartAttributesModelSourceSuppliesRoleForLongColumns()
+    {
+        // long columns are not searched, their cells are looked up one by one
+        QStandardItemModel source(5000, 1);
+        AttributesModel attributes(&source, nullptr);
+        QVERIFY(attributes.sourceSuppliesRole(0, DatasetPenRole));
+        source.setRowCount(10);
+        QVERIFY(!attributes.sourceSuppliesRole(0, DatasetPenRole));
+    }
+
     void cleanupTestCase()
     {
         delete m_plane;
@@ -13,6 +13,9 @@
 #include <KDChartChart>
 #include <KDChartGlobal>
 #include <KDChartThreeDBarAttributes>
+#include <QImage>
+#include <QPainter>
+#include <QStandardItemModel>
 #include <QtTest/QtTest>
 
 #include <TableModel.h>
@@ -176,6 +179,36 @@ private slots:
         QVERIFY(m_bars->threeDBarAttributes().angle() == 75);
     }
 
+    void testBarsMapToCells()
+    {
+        QStandardItemModel model(50, 3);
+        for (int row = 0; row < model.rowCount(); ++row) {
+            for (int column = 0; column < model.columnCount(); ++column) {
+                // some bars point downwards
+                model.setData(model.index(row, column), (row % 7 - 2) * (column + 1) + 0.5);
+            }
+        }
+        Chart chart;
+        auto *bars = new BarDiagram();
+        bars->setModel(&model);
+        chart.coordinatePlane()->replaceDiagram(bars);
+
+        QImage image(800, 400, QImage::Format_ARGB32_Premultiplied);
+        QPainter painter(&image);
+        chart.paint(&painter, image.rect());
+
+        for (int row = 0; row < model.rowCount(); ++row) {
+            for (int column = 0; column < model.columnCount(); ++column) {
+                const QModelIndex index = bars->model()->index(row, column);
+                const QRect rect = bars->visualRect(index);
+                QVERIFY(!rect.isEmpty());
+                QCOMPARE(bars->indexesAt(rect.center()), QModelIndexList() << index);
+                QVERIFY(!bars->visualRegion(index).isEmpty());
+            }
+        }
+        QVERIFY(bars->indexesAt(QPoint(-10, -10)).isEmpty());
+    }
+
     void cleanupTestCase()
     {
     }
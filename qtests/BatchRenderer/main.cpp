@@ -0,0 +1,186 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#include <QFile>
+#include <QImage>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+#include <KDChartBatchRenderer>
+
+using namespace KDChart;
+
+static const int DataFileCount = 4;
+
+class TestBatchRenderer : public QObject
+{
+    Q_OBJECT
+private slots:
+
+    void initTestCase()
+    {
+        qRegisterMetaType<BatchRenderer::JobResult>();
+        QVERIFY(m_dir.isValid());
+        for (int file = 0; file < DataFileCount; ++file) {
+            QByteArray csv = "\"Sales " + QByteArray::number(file) + "\",\"North\",\"South\",\"East\"\n";
+            for (int row = 0; row < 8; ++row) {
+                csv += "\"Q" + QByteArray::number(row) + "\"";
+                for (int column = 0; column < 3; ++column) {
+                    csv += ',' + QByteArray::number((row * 7 + column * 5 + file * 3) % 11 + 1);
+                }
+                csv += '\n';
+            }
+            writeFile(dataFile(file), csv);
+        }
+    }
+
+    void testReadJobs()
+    {
+        writeFile(m_dir.filePath(QStringLiteral("jobs.json")),
+                  "{ \"jobs\": ["
+                  "  { \"type\": \"bar\", \"subType\": \"stacked\", \"data\": \"data0.csv\", \"output\": \"bars.pdf\","
+                  "    \"width\": 640, \"height\": 480, \"legend\": false, \"title\": \"Bars\" },"
+                  "  { \"data\": \"data1.csv\", \"background\": \"transparent\" }"
+                  "] }");
+        QString errorString;
+        const QVector<BatchRenderer::Job> jobs = BatchRenderer::readJobs(m_dir.filePath(QStringLiteral("jobs.json")),
+                                                                         &errorString);
+        QVERIFY2(errorString.isEmpty(), qPrintable(errorString));
+        QCOMPARE(jobs.count(), 2);
+
+        QCOMPARE(jobs.at(0).type, BatchRenderer::Bar);
+        QCOMPARE(jobs.at(0).subType, BatchRenderer::Stacked);
+        QCOMPARE(jobs.at(0).dataFile, dataFile(0));
+        QCOMPARE(jobs.at(0).outputFile, m_dir.filePath(QStringLiteral("bars.pdf")));
+        QCOMPARE(jobs.at(0).size, QSize(640, 480));
+        QCOMPARE(jobs.at(0).legend, false);
+        QCOMPARE(jobs.at(0).title, QStringLiteral("Bars"));
+
+        const BatchRenderer::Job defaults;
+        QCOMPARE(jobs.at(1).type, defaults.type);
+        QCOMPARE(jobs.at(1).size, defaults.size);
+        QCOMPARE(jobs.at(1).legend, defaults.legend);
+        QVERIFY(jobs.at(1).outputFile.isEmpty());
+        QCOMPARE(jobs.at(1).background.alpha(), 0);
+
+        writeFile(m_dir.filePath(QStringLiteral("broken.json")), "[ { \"type\": \"radar\", \"data\": \"data0.csv\" } ]");
+        QVERIFY(BatchRenderer::readJobs(m_dir.filePath(QStringLiteral("broken.json")), &errorString).isEmpty());
+        QVERIFY(!errorString.isEmpty());
+    }
+
+    void testParallelMatchesSerial()
+    {
+        const QVector<BatchRenderer::Job> jobs = imageJobs();
+
+        BatchRenderer serialRenderer;
+        serialRenderer.setMaxThreadCount(1);
+        const QVector<BatchRenderer::JobResult> references = serialRenderer.render(jobs);
+
+        BatchRenderer renderer;
+        renderer.setMaxThreadCount(qMax(4, QThread::idealThreadCount()));
+        QSignalSpy finishedSpy(&renderer, &BatchRenderer::jobFinished);
+        const QVector<BatchRenderer::JobResult> results = renderer.render(jobs);
+        QCOMPARE(finishedSpy.count(), jobs.count());
+
+        QCOMPARE(results.count(), jobs.count());
+        for (int i = 0; i < jobs.count(); ++i) {
+            QVERIFY2(results.at(i).success, qPrintable(results.at(i).errorString));
+            QCOMPARE(results.at(i).job, i);
+            QCOMPARE(results.at(i).image.size(), jobs.at(i).size);
+            QVERIFY(results.at(i).paintTime > 0);
+            QVERIFY2(results.at(i).image == references.at(i).image, qPrintable(QString::fromLatin1("job %1").arg(i)));
+        }
+    }
+
+    void testReusedChartMatchesNewChart()
+    {
+        // the chart that rendered the first job is reused for the second one
+        const QVector<BatchRenderer::Job> jobs = imageJobs();
+        BatchRenderer::Job first = jobs.at(0);
+        first.dataFile = dataFile(3);
+        first.size = QSize(900, 300);
+        const BatchRenderer::Job second = jobs.at(0);
+
+        BatchRenderer reusingRenderer;
+        reusingRenderer.setMaxThreadCount(1);
+        const QVector<BatchRenderer::JobResult> reused = reusingRenderer.render({first, second});
+
+        BatchRenderer renderer;
+        const QVector<BatchRenderer::JobResult> fresh = renderer.render({second});
+        QVERIFY(reused.at(1).image == fresh.at(0).image);
+    }
+
+    void testFiles()
+    {
+        BatchRenderer::Job job;
+        job.type = BatchRenderer::Bar;
+        job.dataFile = dataFile(0);
+        job.size = QSize(500, 400);
+
+        QVector<BatchRenderer::Job> jobs;
+        for (const char *suffix : {"png", "pdf", "svg"}) {
+            job.outputFile = m_dir.filePath(QStringLiteral("chart.") + QLatin1String(suffix));
+            jobs.append(job);
+        }
+        job.dataFile = m_dir.filePath(QStringLiteral("missing.csv"));
+        job.outputFile = m_dir.filePath(QStringLiteral("missing.png"));
+        jobs.append(job);
+
+        BatchRenderer renderer;
+        const QVector<BatchRenderer::JobResult> results = renderer.render(jobs);
+        for (int i = 0; i < 3; ++i) {
+            QVERIFY2(results.at(i).success, qPrintable(results.at(i).errorString));
+            QVERIFY(QFileInfo(jobs.at(i).outputFile).size() > 0);
+        }
+        QCOMPARE(QImage(jobs.at(0).outputFile).size(), QSize(500, 400));
+
+        QVERIFY(!results.at(3).success);
+        QVERIFY(!results.at(3).errorString.isEmpty());
+        QVERIFY(!QFile::exists(jobs.at(3).outputFile));
+    }
+
+private:
+    QString dataFile(int number) const
+    {
+        return m_dir.filePath(QString::fromLatin1("data%1.csv").arg(number));
+    }
+
+    static void writeFile(const QString &fileName, const QByteArray &contents)
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(contents);
+    }
+
+    // all kinds of charts, more of them than there are threads, so that charts get reused
+    QVector<BatchRenderer::Job> imageJobs() const
+    {
+        QVector<BatchRenderer::Job> jobs;
+        for (int i = 0; i < 36; ++i) {
+            BatchRenderer::Job job;
+            job.type = static_cast<BatchRenderer::ChartType>(i % 3);
+            job.subType = static_cast<BatchRenderer::SubType>(i / 3 % 3);
+            job.dataFile = dataFile(i % DataFileCount);
+            job.size = QSize(300 + i % 5 * 60, 200 + i % 4 * 50);
+            job.legend = i % 4 != 3;
+            if (i % 6 == 5) {
+                job.title = QString::fromLatin1("Job %1").arg(i);
+            }
+            jobs.append(job);
+        }
+        return jobs;
+    }
+
+    QTemporaryDir m_dir;
+};
+
+QTEST_MAIN(TestBatchRenderer)
+
+#include "main.moc"
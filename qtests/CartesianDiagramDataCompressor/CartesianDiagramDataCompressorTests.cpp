@@ -14,7 +14,11 @@
 #include <QtDebug>
 #include <QtTest/QtTest>
 
+#include <KDABLibFakes>
+#include <KDChartAttributesModel.h>
 #include <KDChartCartesianDiagramDataCompressor_p.h>
+#include <KDChartColumnarDataSource_p.h>
+#include <KDChartRingBufferModel.h>
 
 typedef KDChart::CartesianDiagramDataCompressor::CachePosition CachePosition;
 
@@ -29,6 +33,47 @@ struct Match
     QModelIndex index;
 };
 
+// counts the values read by the compressor
+class CountingModel : public QStandardItemModel
+{
+public:
+    CountingModel(int rows, int columns)
+        : QStandardItemModel(rows, columns)
+    {
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override
+    {
+        if (role == Qt::DisplayRole)
+            ++displayRoleReads;
+        ++reads;
+        return QStandardItemModel::data(index, role);
+    }
+
+    mutable int displayRoleReads = 0;
+    mutable int reads = 0;
+};
+
+// datasets stored in plain vectors
+class VectorDataSource : public KDChart::ColumnarDataSource
+{
+public:
+    int datasetCount() const override
+    {
+        return datasets.size();
+    }
+    int sampleCount() const override
+    {
+        return datasets.isEmpty() ? 0 : datasets.first().size();
+    }
+    const double *values(int dataset) const override
+    {
+        return datasets.at(dataset).constData();
+    }
+
+    QVector<QVector<double>> datasets;
+};
+
 class CartesianDiagramDataCompressorTests : public QObject
 {
     Q_OBJECT
@@ -179,6 +224,474 @@ private slots:
                  "datasetDimension == 1 should restore the old column count");
     }
 
+    void minMaxTest()
+    {
+        // a noisy signal with a single spike and a single dropout
+        QStandardItemModel spikes(SpikeRowCount, 1);
+        for (int row = 0; row < SpikeRowCount; ++row) {
+            qreal value = (row * 7919) % 13;
+            if (row == 4711)
+                value = 1000.0;
+            if (row == 8888)
+                value = -1000.0;
+            spikes.setData(spikes.index(row, 0), value);
+        }
+
+        KDChart::CartesianDiagramDataCompressor minMax;
+        minMax.setApproximationMode(KDChart::CartesianDiagramDataCompressor::MinMax);
+        minMax.setModel(&spikes);
+        minMax.setResolution(width, height);
+        const int pointsPerPixel = KDChart::CartesianDiagramDataCompressor::MinMaxPointsPerPixel;
+        QCOMPARE(minMax.modelDataRows(), width * pointsPerPixel);
+
+        // every pixel column has to show the same extremes and end points as the
+        // undecimated data, which makes the rendered lines identical
+        bool sawSpike = false;
+        bool sawDropout = false;
+        for (int pixel = 0; pixel < width; ++pixel) {
+            const int firstRow = (pixel * SpikeRowCount + width - 1) / width;
+            const int endRow = ((pixel + 1) * SpikeRowCount + width - 1) / width;
+            qreal minValue = std::numeric_limits<qreal>::max();
+            qreal maxValue = -std::numeric_limits<qreal>::max();
+            for (int row = firstRow; row < endRow; ++row) {
+                const qreal value = spikes.data(spikes.index(row, 0)).toReal();
+                minValue = qMin(minValue, value);
+                maxValue = qMax(maxValue, value);
+            }
+
+            qreal pointMin = std::numeric_limits<qreal>::max();
+            qreal pointMax = -std::numeric_limits<qreal>::max();
+            qreal lastKey = -1;
+            for (int i = 0; i < pointsPerPixel; ++i) {
+                const CachePosition position(pixel * pointsPerPixel + i, 0);
+                const KDChart::CartesianDiagramDataCompressor::DataPoint &point = minMax.data(position);
+                QVERIFY(!point.hidden);
+                QVERIFY2(point.key >= lastKey, "points of a pixel column need to be in row order");
+                QVERIFY(point.key >= firstRow && point.key < endRow);
+                QCOMPARE(minMax.mapToCache(point.index), CachePosition(pixel * pointsPerPixel, 0));
+                lastKey = point.key;
+                pointMin = qMin(pointMin, point.value);
+                pointMax = qMax(pointMax, point.value);
+            }
+            QCOMPARE(minMax.data(CachePosition(pixel * pointsPerPixel, 0)).key, qreal(firstRow));
+            QCOMPARE(minMax.data(CachePosition(pixel * pointsPerPixel + pointsPerPixel - 1, 0)).key, qreal(endRow - 1));
+            QCOMPARE(pointMin, minValue);
+            QCOMPARE(pointMax, maxValue);
+            sawSpike = sawSpike || pointMax == 1000.0;
+            sawDropout = sawDropout || pointMin == -1000.0;
+        }
+        QVERIFY(sawSpike && sawDropout);
+        const QPair<QPointF, QPointF> boundaries = minMax.dataBoundaries();
+        QCOMPARE(boundaries.first.y(), -1000.0);
+        QCOMPARE(boundaries.second.y(), 1000.0);
+
+        // changing a single value needs to update its pixel column
+        const CachePosition spikePosition = minMax.mapToCache(spikes.index(4711, 0));
+        spikes.setData(spikes.index(4711, 0), 0.0);
+        for (int i = 0; i < pointsPerPixel; ++i) {
+            const CachePosition position(spikePosition.row + i, 0);
+            QVERIFY(minMax.data(position).value < 1000.0);
+        }
+
+        // appending rows rebuilds the buckets
+        spikes.insertRows(SpikeRowCount, SpikeRowCount);
+        QCOMPARE(minMax.modelDataRows(), width * pointsPerPixel);
+        QCOMPARE(minMax.mapToCache(spikes.index(2 * SpikeRowCount - 1, 0)),
+                 CachePosition((width - 1) * pointsPerPixel, 0));
+    }
+
+    void samplingTest()
+    {
+        CountingModel sampled(SpikeRowCount * 10, 1);
+        for (int row = 0; row < sampled.rowCount(); ++row)
+            sampled.setData(sampled.index(row, 0), qreal(row % 2 ? 1.0 : 3.0));
+
+        KDChart::CartesianDiagramDataCompressor sampling;
+        sampling.setApproximationMode(KDChart::CartesianDiagramDataCompressor::SamplingSeven);
+        sampling.setModel(&sampled);
+        sampling.setResolution(width, height);
+        QVERIFY2(sampling.m_sampleStep > 1, "500 indexes per pixel should result in sampling");
+        QCOMPARE(sampling.m_sampleStep % 2, 1u);
+
+        sampled.displayRoleReads = 0;
+        const qreal ipp = sampling.indexesPerPixel();
+        for (int pixel = 0; pixel < width; ++pixel) {
+            const KDChart::CartesianDiagramDataCompressor::DataPoint &point = sampling.data(CachePosition(pixel, 0));
+            QVERIFY(!point.hidden);
+            QVERIFY(point.key >= pixel * ipp && point.key < (pixel + 1) * ipp);
+            // an odd prime step alternates between both values
+            QVERIFY(point.value > 1.5 && point.value < 2.5);
+        }
+        QVERIFY2(sampled.displayRoleReads * 10 < sampled.rowCount(),
+                 "sampling should read only a fraction of the model");
+    }
+
+    void lttbTest()
+    {
+        // two-dimensional dataset with non-uniform keys and a single spike
+        QStandardItemModel xy(SpikeRowCount, 2);
+        for (int row = 0; row < SpikeRowCount; ++row) {
+            xy.setData(xy.index(row, 0), qreal(row) * row / SpikeRowCount);
+            xy.setData(xy.index(row, 1), row == 4711 ? 1000.0 : qreal(row % 5));
+        }
+
+        KDChart::CartesianDiagramDataCompressor lttb;
+        lttb.setDatasetDimension(2);
+        lttb.setApproximationMode(KDChart::CartesianDiagramDataCompressor::LargestTriangleThreeBuckets);
+        lttb.setModel(&xy);
+        lttb.setResolution(width, height);
+        const int pointCount = width * KDChart::CartesianDiagramDataCompressor::LttbPointsPerPixel;
+        QCOMPARE(lttb.modelDataColumns(), 1);
+        QCOMPARE(lttb.modelDataRows(), pointCount);
+
+        QCOMPARE(lttb.data(CachePosition(0, 0)).index.row(), 0);
+        QCOMPARE(lttb.data(CachePosition(pointCount - 1, 0)).index.row(), SpikeRowCount - 1);
+        qreal lastKey = -1;
+        bool sawSpike = false;
+        for (int row = 0; row < pointCount; ++row) {
+            const KDChart::CartesianDiagramDataCompressor::DataPoint &point = lttb.data(CachePosition(row, 0));
+            QVERIFY(!point.hidden);
+            QVERIFY2(point.key > lastKey, "selected points need to be in key order");
+            QCOMPARE(point.key, xy.data(point.index).toReal());
+            lastKey = point.key;
+            sawSpike = sawSpike || point.value == 1000.0;
+        }
+        QVERIFY2(sawSpike, "the most significant point has to be selected");
+
+        // a change anywhere in the dataset reselects the points
+        xy.setData(xy.index(4711, 1), 0.0);
+        for (int row = 0; row < pointCount; ++row)
+            QVERIFY(lttb.data(CachePosition(row, 0)).value < 1000.0);
+    }
+
+    void insertColumnTest_data()
+    {
+        QTest::addColumn<int>("mode");
+        QTest::newRow("MinMax") << int(KDChart::CartesianDiagramDataCompressor::MinMax);
+        QTest::newRow("LargestTriangleThreeBuckets")
+            << int(KDChart::CartesianDiagramDataCompressor::LargestTriangleThreeBuckets);
+    }
+
+    void insertColumnTest()
+    {
+        QFETCH(int, mode);
+        QStandardItemModel columns(SpikeRowCount, 2);
+        for (int row = 0; row < SpikeRowCount; ++row)
+            for (int column = 0; column < 2; ++column)
+                columns.setData(columns.index(row, column), qreal((row * 7919 + column) % 13));
+
+        KDChart::CartesianDiagramDataCompressor inserted;
+        inserted.setApproximationMode(KDChart::CartesianDiagramDataCompressor::ApproximationMode(mode));
+        inserted.setModel(&columns);
+        inserted.setResolution(width, height);
+        const int rowCount = inserted.modelDataRows();
+        QVERIFY(rowCount > width);
+
+        columns.insertColumns(1, 1);
+        for (int row = 0; row < SpikeRowCount; ++row)
+            columns.setData(columns.index(row, 1), qreal(row % 17));
+        QCOMPARE(inserted.modelDataColumns(), 3);
+        for (int column = 0; column < inserted.m_data.size(); ++column)
+            QCOMPARE(inserted.m_data.at(column).size(), rowCount);
+
+        // the inserted column must be cached like the ones that were there before
+        KDChart::CartesianDiagramDataCompressor fresh;
+        fresh.setApproximationMode(KDChart::CartesianDiagramDataCompressor::ApproximationMode(mode));
+        fresh.setModel(&columns);
+        fresh.setResolution(width, height);
+        QCOMPARE(inserted.modelDataRows(), fresh.modelDataRows());
+        for (int column = 0; column < fresh.modelDataColumns(); ++column) {
+            for (int row = 0; row < fresh.modelDataRows(); ++row) {
+                const CachePosition position(row, column);
+                const KDChart::CartesianDiagramDataCompressor::DataPoint expected = fresh.data(position);
+                const KDChart::CartesianDiagramDataCompressor::DataPoint &actual = inserted.data(position);
+                QCOMPARE(actual.index, expected.index);
+                QCOMPARE(actual.key, expected.key);
+                QCOMPARE(actual.value, expected.value);
+            }
+        }
+    }
+
+    void pyramidTest_data()
+    {
+        QTest::addColumn<int>("mode");
+        QTest::newRow("Precise") << int(KDChart::CartesianDiagramDataCompressor::Precise);
+        QTest::newRow("MinMax") << int(KDChart::CartesianDiagramDataCompressor::MinMax);
+    }
+
+    void pyramidTest()
+    {
+        QFETCH(int, mode);
+        CountingModel values(SpikeRowCount, 2);
+        for (int row = 0; row < SpikeRowCount; ++row) {
+            values.setData(values.index(row, 0), qreal((row * 7919) % 101));
+            // a few missing values
+            if (row % 977)
+                values.setData(values.index(row, 1), qreal(row % 13) - 6.0);
+        }
+
+        KDChart::CartesianDiagramDataCompressor direct;
+        KDChart::CartesianDiagramDataCompressor pyramid;
+        for (KDChart::CartesianDiagramDataCompressor *compressor : {&direct, &pyramid}) {
+            compressor->setApproximationMode(KDChart::CartesianDiagramDataCompressor::ApproximationMode(mode));
+            compressor->setModel(&values);
+        }
+        pyramid.setUsePyramid(true);
+
+        // resolutions as they appear when zooming in
+        const int resolutions[] = {width, 3 * width, 7 * width, SpikeRowCount / 3, SpikeRowCount};
+        for (int resolution : resolutions) {
+            direct.setResolution(resolution, height);
+            pyramid.setResolution(resolution, height);
+            if (resolution != width) {
+                values.reads = 0;
+            }
+            QCOMPARE(pyramid.modelDataRows(), direct.modelDataRows());
+            for (int column = 0; column < direct.modelDataColumns(); ++column) {
+                for (int row = 0; row < direct.modelDataRows(); ++row) {
+                    const CachePosition position(row, column);
+                    const KDChart::CartesianDiagramDataCompressor::DataPoint expected = direct.data(position);
+                    const int readsBefore = values.reads;
+                    const KDChart::CartesianDiagramDataCompressor::DataPoint &actual = pyramid.data(position);
+                    if (resolution != width) {
+                        QVERIFY2(values.reads == readsBefore, "the pyramid must not read the model again");
+                    }
+                    QCOMPARE(actual.index, expected.index);
+                    QCOMPARE(actual.key, expected.key);
+                    QCOMPARE(actual.hidden, expected.hidden);
+                    if (ISNAN(expected.value))
+                        QVERIFY(ISNAN(actual.value));
+                    else
+                        QVERIFY(qFuzzyCompare(actual.value + 1000.0, expected.value + 1000.0));
+                }
+            }
+        }
+
+        // changed values are taken over into the pyramid
+        direct.setResolution(width, height);
+        pyramid.setResolution(width, height);
+        values.setData(values.index(4711, 0), 5000.0);
+        QCOMPARE(pyramid.dataBoundaries().second.y(), direct.dataBoundaries().second.y());
+    }
+
+    void columnarDataSourceTest()
+    {
+        VectorDataSource source;
+        QStandardItemModel values(SpikeRowCount, 2);
+        source.datasets.resize(2);
+        for (int column = 0; column < 2; ++column) {
+            for (int row = 0; row < SpikeRowCount; ++row) {
+                const double value = column == 0 ? (row * 31) % 97 : std::numeric_limits<double>::quiet_NaN();
+                source.datasets[column].append(value);
+                if (!ISNAN(value))
+                    values.setData(values.index(row, column), value);
+            }
+        }
+        KDChart::ColumnarDataModel sourceModel(&source, 1);
+        QCOMPARE(sourceModel.rowCount(), SpikeRowCount);
+        QCOMPARE(sourceModel.columnCount(), 2);
+        QVERIFY(!sourceModel.data(sourceModel.index(0, 1)).isValid());
+
+        KDChart::CartesianDiagramDataCompressor direct;
+        KDChart::CartesianDiagramDataCompressor columnar;
+        direct.setModel(&values);
+        columnar.setModel(&sourceModel);
+        columnar.setColumnarModel(&sourceModel);
+        direct.setResolution(width, height);
+        columnar.setResolution(width, height);
+
+        QCOMPARE(columnar.modelDataRows(), direct.modelDataRows());
+        for (int column = 0; column < direct.modelDataColumns(); ++column) {
+            for (int row = 0; row < direct.modelDataRows(); ++row) {
+                const CachePosition position(row, column);
+                const KDChart::CartesianDiagramDataCompressor::DataPoint expected = direct.data(position);
+                const KDChart::CartesianDiagramDataCompressor::DataPoint &actual = columnar.data(position);
+                QCOMPARE(actual.key, expected.key);
+                QCOMPARE(actual.index.row(), expected.index.row());
+                if (ISNAN(expected.value))
+                    QVERIFY(ISNAN(actual.value));
+                else
+                    QVERIFY(qFuzzyCompare(actual.value, expected.value));
+            }
+        }
+
+        // in-place changes are picked up after a dataChanged() notification
+        source.datasets[0][42] = 1000000.0;
+        Q_EMIT source.dataChanged(0, 0, 42, 42);
+        QVERIFY(columnar.dataBoundaries().second.y() > 10000.0);
+
+        // so are changes of the sample count after reset()
+        for (QVector<double> &dataset : source.datasets)
+            dataset.resize(width / 2);
+        Q_EMIT source.reset();
+        QCOMPARE(columnar.modelDataRows(), width / 2);
+    }
+
+    void columnarHiddenTest()
+    {
+        VectorDataSource source;
+        source.datasets.resize(2);
+        for (QVector<double> &dataset : source.datasets) {
+            for (int row = 0; row < SpikeRowCount; ++row)
+                dataset.append(row == 4711 ? 1000.0 : (row * 7919) % 13);
+        }
+        KDChart::ColumnarDataModel sourceModel(&source, 1);
+        KDChart::AttributesModel attributes(&sourceModel);
+
+        KDChart::CartesianDiagramDataCompressor minMax;
+        minMax.setApproximationMode(KDChart::CartesianDiagramDataCompressor::MinMax);
+        minMax.setModel(&attributes);
+        minMax.setColumnarModel(&sourceModel);
+        minMax.setResolution(width, height);
+        const CachePosition spikePosition = minMax.mapToCache(attributes.index(4711, 0));
+        auto spikePixelMaximum = [&minMax, spikePosition]() {
+            qreal maximum = -std::numeric_limits<qreal>::max();
+            for (int i = 0; i < KDChart::CartesianDiagramDataCompressor::MinMaxPointsPerPixel; ++i)
+                maximum = qMax(maximum, minMax.data(CachePosition(spikePosition.row + i, 0)).value);
+            return maximum;
+        };
+        QCOMPARE(spikePixelMaximum(), 1000.0);
+
+        // a hidden dataset hides all of its points
+        attributes.setHeaderData(1, Qt::Horizontal, true, KDChart::DataHiddenRole);
+        for (int row = 0; row < minMax.modelDataRows(); ++row) {
+            QVERIFY(!minMax.data(CachePosition(row, 0)).hidden);
+            QVERIFY(minMax.data(CachePosition(row, 1)).hidden);
+        }
+
+        // a hidden cell is skipped, and shown again once its attribute is reset
+        attributes.setData(attributes.index(4711, 0), true, KDChart::DataHiddenRole);
+        QVERIFY(spikePixelMaximum() < 1000.0);
+        attributes.resetData(attributes.index(4711, 0), KDChart::DataHiddenRole);
+        QCOMPARE(spikePixelMaximum(), 1000.0);
+        QVERIFY(minMax.data(CachePosition(0, 1)).hidden);
+    }
+
+    void ringBufferTest_data()
+    {
+        QTest::addColumn<int>("mode");
+        QTest::addColumn<int>("appended");
+        for (int appended : {1, 5, 3, 40, 2 * RowCount}) {
+            QTest::newRow(qPrintable(QStringLiteral("Precise, %1 rows").arg(appended)))
+                << int(KDChart::CartesianDiagramDataCompressor::Precise) << appended;
+            QTest::newRow(qPrintable(QStringLiteral("MinMax, %1 rows").arg(appended)))
+                << int(KDChart::CartesianDiagramDataCompressor::MinMax) << appended;
+        }
+    }
+
+    void ringBufferTest()
+    {
+        QFETCH(int, mode);
+        QFETCH(int, appended);
+        KDChart::RingBufferModel ring(RowCount, 2);
+        QVector<qreal> values;
+        for (int row = 0; row < RowCount; ++row)
+            values << qreal(row % 17) << qreal((row * 13) % 29);
+        ring.appendRows(values.constData(), RowCount);
+        QCOMPARE(ring.rowCount(), RowCount);
+
+        KDChart::CartesianDiagramDataCompressor shifted;
+        shifted.setApproximationMode(KDChart::CartesianDiagramDataCompressor::ApproximationMode(mode));
+        shifted.setModel(&ring);
+        shifted.setResolution(width, height);
+        for (int column = 0; column < shifted.modelDataColumns(); ++column)
+            for (int row = 0; row < shifted.modelDataRows(); ++row)
+                shifted.data(CachePosition(row, column));
+
+        QSignalSpy shifts(&ring, &KDChart::RingBufferModel::rowsShifted);
+        ring.appendRows(values.constData(), qMin(appended, RowCount - 1));
+        for (int row = RowCount - 1; row < appended; ++row)
+            ring.appendRow({qreal(row), qreal(-row)});
+        QCOMPARE(ring.rowCount(), RowCount);
+        QCOMPARE(shifts.count(), 1 + qMax(0, appended - RowCount + 1));
+        QCOMPARE(ring.value(RowCount - 1, 0), appended < RowCount ? values.at(2 * (appended - 1)) : qreal(appended - 1));
+
+        // the slided cache must match a freshly filled one
+        KDChart::CartesianDiagramDataCompressor fresh;
+        fresh.setApproximationMode(KDChart::CartesianDiagramDataCompressor::ApproximationMode(mode));
+        fresh.setModel(&ring);
+        fresh.setResolution(width, height);
+        QCOMPARE(shifted.modelDataRows(), fresh.modelDataRows());
+        for (int column = 0; column < fresh.modelDataColumns(); ++column) {
+            for (int row = 0; row < fresh.modelDataRows(); ++row) {
+                const CachePosition position(row, column);
+                const KDChart::CartesianDiagramDataCompressor::DataPoint expected = fresh.data(position);
+                const KDChart::CartesianDiagramDataCompressor::DataPoint &actual = shifted.data(position);
+                QCOMPARE(actual.index, expected.index);
+                QCOMPARE(actual.key, expected.key);
+                QCOMPARE(actual.value, expected.value);
+            }
+        }
+    }
+
+    void boundariesTest()
+    {
+        CountingModel values(RowCount, 2);
+        for (int row = 0; row < RowCount; ++row) {
+            values.setData(values.index(row, 0), qreal(row % 50));
+            values.setData(values.index(row, 1), qreal(-(row % 70)));
+        }
+        KDChart::CartesianDiagramDataCompressor compressor;
+        compressor.setModel(&values);
+        // one cache row per model row
+        compressor.setResolution(2 * RowCount, height);
+
+        auto expectedBoundaries = [&values]() {
+            KDChart::CartesianDiagramDataCompressor fresh;
+            fresh.setModel(&values);
+            fresh.setResolution(2 * RowCount, height);
+            return fresh.dataBoundaries();
+        };
+        QCOMPARE(compressor.dataBoundaries(), expectedBoundaries());
+
+        // changing a value that is no extreme only reads that value
+        values.displayRoleReads = 0;
+        values.setData(values.index(10, 0), 100.0);
+        QCOMPARE(compressor.dataBoundaries().second.y(), 100.0);
+        QCOMPARE(values.displayRoleReads, 1);
+
+        // lowering the maximum needs a rescan
+        values.setData(values.index(10, 0), 10.0);
+        QCOMPARE(compressor.dataBoundaries(), expectedBoundaries());
+
+        // appending extends the boundaries
+        values.insertRows(RowCount, 1);
+        values.setData(values.index(RowCount, 1), -1000.0);
+        QCOMPARE(compressor.dataBoundaries(), expectedBoundaries());
+        QCOMPARE(compressor.dataBoundaries().first.y(), -1000.0);
+
+        // removing the extreme shrinks them again
+        values.removeRows(RowCount, 1);
+        QCOMPARE(compressor.dataBoundaries(), expectedBoundaries());
+        values.removeRows(0, 1);
+        QCOMPARE(compressor.dataBoundaries(), expectedBoundaries());
+    }
+
+    void approximationBenchmark_data()
+    {
+        QTest::addColumn<int>("mode");
+        QTest::newRow("Precise") << int(KDChart::CartesianDiagramDataCompressor::Precise);
+        QTest::newRow("MinMax") << int(KDChart::CartesianDiagramDataCompressor::MinMax);
+        QTest::newRow("SamplingSeven") << int(KDChart::CartesianDiagramDataCompressor::SamplingSeven);
+    }
+
+    void approximationBenchmark()
+    {
+        QFETCH(int, mode);
+        QStandardItemModel bigModel(SpikeRowCount * 10, 1);
+        for (int row = 0; row < bigModel.rowCount(); ++row)
+            bigModel.setData(bigModel.index(row, 0), qreal(row % 97));
+
+        KDChart::CartesianDiagramDataCompressor benchmarked;
+        benchmarked.setApproximationMode(KDChart::CartesianDiagramDataCompressor::ApproximationMode(mode));
+        benchmarked.setModel(&bigModel);
+        benchmarked.setResolution(width, height);
+        QBENCHMARK {
+            benchmarked.clearCache();
+            benchmarked.dataBoundaries();
+        }
+    }
+
     void cleanupTestCase()
     {
     }
@@ -188,12 +701,14 @@ private:
     QStandardItemModel model;
     static const int RowCount;
     static const int ColumnCount;
+    static const int SpikeRowCount;
     int width;
     int height;
 };
 
 const int CartesianDiagramDataCompressorTests::ColumnCount = 10;
 const int CartesianDiagramDataCompressorTests::RowCount = 1000;
+const int CartesianDiagramDataCompressorTests::SpikeRowCount = 10000;
 
 QTEST_MAIN(CartesianDiagramDataCompressorTests)
 
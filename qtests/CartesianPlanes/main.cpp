@@ -9,10 +9,15 @@
 ****************************************************************************/
 
 #include <KDChartBarDiagram>
+#include <KDChartCartesianAxis>
 #include <KDChartCartesianCoordinatePlane>
 #include <KDChartChart>
 #include <KDChartGridAttributes>
+#include <KDChartLegend>
+#include <KDChartLineDiagram>
 #include <KDChartPlotter>
+#include <QPaintEvent>
+#include <QPainter>
 #include <QPair>
 #include <QPointF>
 #include <QStandardItemModel>
@@ -79,6 +84,11 @@ private slots:
     void testGlobalGridAttributesSettings();
     void testGridAttributesSettings();
     void testAxesCalcModesSettings();
+    void testLayeredRendering();
+    void testPartialDataUpdate();
+    void testPartialDataUpdateNextToGap();
+    void testPaintRightAfterDataChange();
+    void testPlotterApproximationMode();
 
 private:
     void doTestRangeSettings(AbstractCartesianDiagram *diagram, const QPointF &min, const QPointF &max);
@@ -278,6 +288,220 @@ void TestCartesianPlanes::testAxesCalcModesSettings()
     QCOMPARE(m_plane->axesCalcModeY(), AbstractCoordinatePlane::Linear);
 }
 
+// the number of pixels that differ by more than antialiasing would explain
+static int differentPixels(const QImage &a, const QImage &b)
+{
+    const QImage imageA = a.convertToFormat(QImage::Format_ARGB32);
+    const QImage imageB = b.convertToFormat(QImage::Format_ARGB32);
+    if (imageA.size() != imageB.size()) {
+        return imageA.width() * imageA.height();
+    }
+    int count = 0;
+    for (int y = 0; y < imageA.height(); ++y) {
+        for (int x = 0; x < imageA.width(); ++x) {
+            const QRgb pixelA = imageA.pixel(x, y);
+            const QRgb pixelB = imageB.pixel(x, y);
+            if (qAbs(qRed(pixelA) - qRed(pixelB)) > 96 || qAbs(qGreen(pixelA) - qGreen(pixelB)) > 96
+                || qAbs(qBlue(pixelA) - qBlue(pixelB)) > 96) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+void TestCartesianPlanes::testLayeredRendering()
+{
+    m_model->setYValues(QList<qreal>() << 1 << 4 << 2 << 3);
+    m_chart->coordinatePlane()->replaceDiagram(m_bars);
+    auto *xAxis = new CartesianAxis(m_bars);
+    xAxis->setPosition(CartesianAxis::Bottom);
+    m_bars->addAxis(xAxis);
+    auto *yAxis = new CartesianAxis(m_bars);
+    yAxis->setPosition(CartesianAxis::Left);
+    m_bars->addAxis(yAxis);
+    m_chart->resize(400, 300);
+
+    QVERIFY(!m_chart->isLayeredRenderingEnabled());
+    const QImage direct = m_chart->grab().toImage();
+    m_chart->setLayeredRenderingEnabled(true);
+    QVERIFY(m_chart->isLayeredRenderingEnabled());
+    QCOMPARE(differentPixels(m_chart->grab().toImage(), direct), 0);
+
+    // new data within the same range reuses the backdrop
+    m_model->setYValues(QList<qreal>() << 3 << 1 << 4 << 2);
+    const QImage layered = m_chart->grab().toImage();
+    m_chart->setLayeredRenderingEnabled(false);
+    QCOMPARE(differentPixels(layered, m_chart->grab().toImage()), 0);
+    m_chart->setLayeredRenderingEnabled(true);
+
+    // a new range and new attributes are picked up
+    m_model->setYValues(QList<qreal>() << 30 << 10 << 40 << 20);
+    GridAttributes ga = m_chart->coordinatePlane()->globalGridAttributes();
+    ga.setGridPen(QPen(Qt::red));
+    m_chart->coordinatePlane()->setGlobalGridAttributes(ga);
+    const QImage changed = m_chart->grab().toImage();
+    m_chart->setLayeredRenderingEnabled(false);
+    QCOMPARE(differentPixels(changed, m_chart->grab().toImage()), 0);
+    m_chart->setLayeredRenderingEnabled(true);
+
+    // so are new header labels of the same size, on the axis and in the legend
+    auto *legend = new Legend(m_bars, m_chart);
+    m_chart->addLegend(legend);
+    for (int row = 0; row < m_model->rowCount(); ++row) {
+        m_model->setHeaderData(row, Qt::Vertical, QStringLiteral("A%1").arg(row));
+    }
+    m_model->setHeaderData(0, Qt::Horizontal, QStringLiteral("North"));
+    m_chart->grab();
+    for (int row = 0; row < m_model->rowCount(); ++row) {
+        m_model->setHeaderData(row, Qt::Vertical, QStringLiteral("B%1").arg(row));
+    }
+    m_model->setHeaderData(0, Qt::Horizontal, QStringLiteral("South"));
+    const QImage relabeled = m_chart->grab().toImage();
+    m_chart->setLayeredRenderingEnabled(false);
+    QCOMPARE(differentPixels(relabeled, m_chart->grab().toImage()), 0);
+}
+
+class PaintRegionRecorder : public QObject
+{
+public:
+    QRegion region;
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override
+    {
+        if (event->type() == QEvent::Paint) {
+            region |= static_cast<QPaintEvent *>(event)->region();
+        }
+        return QObject::eventFilter(watched, event);
+    }
+};
+
+void TestCartesianPlanes::testPartialDataUpdate()
+{
+    QList<qreal> values;
+    for (int i = 0; i < 20; ++i) {
+        values << i % 5;
+    }
+    m_model->setYValues(values);
+    m_chart->coordinatePlane()->replaceDiagram(m_bars);
+    m_chart->resize(400, 300);
+    m_chart->show();
+    QVERIFY(QTest::qWaitForWindowExposed(m_chart));
+    QTest::qWait(100);
+
+    PaintRegionRecorder recorder;
+    m_chart->installEventFilter(&recorder);
+    const QRect planeGeometry = m_chart->coordinatePlane()->geometry();
+
+    // a value within the data ranges only repaints the bars around its row
+    m_model->setData(m_model->index(10, 0), 3.5);
+    QTRY_VERIFY(!recorder.region.isEmpty());
+    QVERIFY(recorder.region.boundingRect().width() < planeGeometry.width() / 2);
+
+    // a new maximum rescales the plane, which is repainted as a whole
+    recorder.region = QRegion();
+    m_model->setData(m_model->index(10, 0), 40.0);
+    QTRY_VERIFY(recorder.region.boundingRect().contains(planeGeometry));
+    m_chart->removeEventFilter(&recorder);
+}
+
+void TestCartesianPlanes::testPartialDataUpdateNextToGap()
+{
+    QList<qreal> values;
+    for (int i = 0; i < 200; ++i) {
+        values << i % 5;
+    }
+    m_model->setYValues(values);
+    // a short gap of missing values and a long one
+    for (int i : {193, 194, 195, 196}) {
+        m_model->setData(m_model->index(i, 0), QVariant());
+    }
+    for (int i = 20; i < 180; ++i) {
+        m_model->setData(m_model->index(i, 0), QVariant());
+    }
+    auto *lines = new LineDiagram(m_chart);
+    lines->setModel(m_model);
+    m_chart->coordinatePlane()->replaceDiagram(lines);
+    m_chart->resize(400, 300);
+    m_chart->show();
+    QVERIFY(QTest::qWaitForWindowExposed(m_chart));
+    QTest::qWait(100);
+
+    PaintRegionRecorder recorder;
+    m_chart->installEventFilter(&recorder);
+    const QRect planeGeometry = m_chart->coordinatePlane()->geometry();
+
+    // the line is bridged to the neighbours behind a short gap...
+    m_model->setData(m_model->index(191, 0), 3.5);
+    QTRY_VERIFY(!recorder.region.isEmpty());
+    QVERIFY(recorder.region.boundingRect().width() < planeGeometry.width() / 2);
+
+    // ...while a long gap is not searched, but repainted as a whole
+    recorder.region = QRegion();
+    m_model->setData(m_model->index(18, 0), 3.5);
+    QTRY_VERIFY(recorder.region.boundingRect().contains(planeGeometry));
+    m_chart->removeEventFilter(&recorder);
+}
+
+static QImage paintChart(Chart *chart)
+{
+    QImage image(chart->size(), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    QPainter painter(&image);
+    chart->paint(&painter, image.rect());
+    return image;
+}
+
+void TestCartesianPlanes::testPaintRightAfterDataChange()
+{
+    m_model->setYValues(QList<qreal>() << 1 << 4 << 2 << 3);
+    m_chart->coordinatePlane()->replaceDiagram(m_bars);
+    m_chart->resize(400, 300);
+    QCoreApplication::processEvents();
+    const QImage before = paintChart(m_chart);
+
+    // a change within the data ranges, painted before the event loop runs again...
+    m_model->setData(m_model->index(1, 0), 2.0);
+    const QImage immediate = paintChart(m_chart);
+    QVERIFY(differentPixels(immediate, before) > 0);
+    // ...looks like it does afterwards
+    QCoreApplication::processEvents();
+    QCOMPARE(differentPixels(immediate, paintChart(m_chart)), 0);
+
+    // a new maximum is seen by the grid right away
+    m_model->setData(m_model->index(1, 0), 40.0);
+    const DataDimensionsList dimensions = m_chart->coordinatePlane()->gridDimensionsList();
+    QVERIFY(dimensions.last().end >= 40.0);
+    const QImage rescaled = paintChart(m_chart);
+    QCoreApplication::processEvents();
+    QCOMPARE(differentPixels(rescaled, paintChart(m_chart)), 0);
+}
+
+void TestCartesianPlanes::testPlotterApproximationMode()
+{
+    QCOMPARE(m_plotter->approximationMode(), AbstractCartesianDiagram::AverageApproximation);
+
+    // LTTB compression and the approximation mode do not overwrite each other
+    m_plotter->setUseDataCompression(Plotter::LTTB);
+    m_plotter->setApproximationMode(AbstractCartesianDiagram::MinMaxApproximation);
+    QCOMPARE(m_plotter->useDataCompression(), Plotter::LTTB);
+    QCOMPARE(m_plotter->approximationMode(), AbstractCartesianDiagram::MinMaxApproximation);
+
+    m_plotter->setApproximationMode(AbstractCartesianDiagram::AverageApproximation);
+    QCOMPARE(m_plotter->useDataCompression(), Plotter::LTTB);
+    QCOMPARE(m_plotter->approximationMode(), AbstractCartesianDiagram::AverageApproximation);
+
+    m_plotter->setApproximationMode(AbstractCartesianDiagram::SamplingApproximation);
+    m_plotter->setUseDataCompression(Plotter::NONE);
+    QCOMPARE(m_plotter->useDataCompression(), Plotter::NONE);
+    QCOMPARE(m_plotter->approximationMode(), AbstractCartesianDiagram::SamplingApproximation);
+
+    Plotter *clone = m_plotter->clone();
+    QCOMPARE(clone->approximationMode(), AbstractCartesianDiagram::SamplingApproximation);
+    delete clone;
+}
+
 QTEST_MAIN(TestCartesianPlanes)
 
 #include "main.moc"
@@ -50,6 +50,7 @@ private slots:
         ThreeDBarAttributes threeDAttrs;
         threeDAttrs.setUseShadowColors(false);
         diagram->setThreeDBarAttributes(threeDAttrs);
+        diagram->setFastDataValueTextOverlapTest(true);
         BarDiagram *clone = diagram->clone();
         QCOMPARE(diagram->type(), clone->type());
         // We do not clone the axes.
@@ -60,6 +61,7 @@ private slots:
         // And neither the plane.
         QCOMPARE(clone->coordinatePlane(), ( AbstractCoordinatePlane * )0);
         QCOMPARE(diagram->allowOverlappingDataValueTexts(), clone->allowOverlappingDataValueTexts());
+        QCOMPARE(diagram->fastDataValueTextOverlapTest(), clone->fastDataValueTextOverlapTest());
         QCOMPARE(diagram->antiAliasing(), clone->antiAliasing());
         QCOMPARE(diagram->percentMode(), clone->percentMode());
         QCOMPARE(diagram->datasetDimension(), clone->datasetDimension());
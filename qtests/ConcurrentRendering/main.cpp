@@ -0,0 +1,224 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#include <QImage>
+#include <QPainter>
+#include <QRegularExpression>
+#include <QStandardItemModel>
+#include <QThreadPool>
+#include <QtTest/QtTest>
+
+#include <KDChartBarDiagram>
+#include <KDChartCartesianAxis>
+#include <KDChartCartesianCoordinatePlane>
+#include <KDChartChart>
+#include <KDChartDataValueAttributes>
+#include <KDChartHeaderFooter>
+#include <KDChartLegend>
+#include <KDChartLineDiagram>
+#include <KDChartMarkerAttributes>
+
+using namespace KDChart;
+
+static const int ChartCount = 64;
+
+static Chart *createChart(int number)
+{
+    auto *chart = new Chart();
+    auto *model = new QStandardItemModel(12, 3, chart);
+    for (int row = 0; row < model->rowCount(); ++row) {
+        for (int column = 0; column < model->columnCount(); ++column) {
+            model->setData(model->index(row, column), (row * 7 + column * 5 + number) % 11 - 3);
+        }
+    }
+
+    AbstractCartesianDiagram *diagram = nullptr;
+    if (number % 2) {
+        auto *lines = new LineDiagram();
+        DataValueAttributes dva = lines->dataValueAttributes();
+        MarkerAttributes ma = dva.markerAttributes();
+        ma.setVisible(true);
+        ma.setMarkerStyle(MarkerAttributes::MarkerCircle);
+        dva.setMarkerAttributes(ma);
+        dva.setVisible(number % 4 == 1);
+        lines->setDataValueAttributes(dva);
+        diagram = lines;
+    } else {
+        diagram = new BarDiagram();
+    }
+    diagram->setModel(model);
+
+    auto *xAxis = new CartesianAxis(diagram);
+    xAxis->setPosition(CartesianAxis::Bottom);
+    xAxis->setTitleText(QString::fromLatin1("Rows"));
+    diagram->addAxis(xAxis);
+    auto *yAxis = new CartesianAxis(diagram);
+    yAxis->setPosition(CartesianAxis::Left);
+    diagram->addAxis(yAxis);
+    chart->coordinatePlane()->replaceDiagram(diagram);
+
+    auto *header = new HeaderFooter(chart);
+    header->setText(QString::fromLatin1("Chart %1").arg(number));
+    chart->addHeaderFooter(header);
+    chart->addLegend(new Legend(diagram, chart));
+
+    chart->resize(300 + number % 3 * 50, 200 + number % 5 * 40);
+    return chart;
+}
+
+// the share of the pixels that differ clearly between two images of the same size
+static qreal differingPixels(const QImage &a, const QImage &b)
+{
+    int count = 0;
+    for (int y = 0; y < a.height(); ++y) {
+        for (int x = 0; x < a.width(); ++x) {
+            const QRgb pixelA = a.pixel(x, y);
+            const QRgb pixelB = b.pixel(x, y);
+            if (qAbs(qRed(pixelA) - qRed(pixelB)) > 16 || qAbs(qGreen(pixelA) - qGreen(pixelB)) > 16
+                || qAbs(qBlue(pixelA) - qBlue(pixelB)) > 16) {
+                ++count;
+            }
+        }
+    }
+    return qreal(count) / (a.width() * a.height());
+}
+
+// each chart gets a size of its own, so that the renderings are scaled differently
+static QSize targetSize(int number)
+{
+    return QSize(240 + number % 7 * 60, 180 + number % 4 * 70);
+}
+
+static QImage render(Chart *chart, const QSize &size)
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    QPainter painter(&image);
+    chart->paint(&painter, QRect(QPoint(0, 0), size));
+    return image;
+}
+
+class TestConcurrentRendering : public QObject
+{
+    Q_OBJECT
+private slots:
+
+    void initTestCase()
+    {
+        for (int i = 0; i < ChartCount; ++i) {
+            m_charts.append(createChart(i));
+            // lay the chart out in the GUI thread before it is rendered elsewhere...
+            m_charts.last()->layoutForPainting(targetSize(i));
+            // ...where it has to look like it does here
+            m_references.append(render(m_charts.last(), targetSize(i)));
+        }
+    }
+
+    void cleanupTestCase()
+    {
+        qDeleteAll(m_charts);
+        m_charts.clear();
+        m_references.clear();
+    }
+
+    void testConcurrentPaint()
+    {
+        // the same renderings, one after the other and all at once, off the GUI thread
+        QVector<QImage> serialImages(ChartCount);
+        QThreadPool serialPool;
+        serialPool.setMaxThreadCount(1);
+        for (int i = 0; i < ChartCount; ++i) {
+            serialPool.start([this, &serialImages, i]() {
+                serialImages[i] = render(m_charts.at(i), targetSize(i));
+            });
+        }
+        serialPool.waitForDone();
+
+        QVector<QImage> images(ChartCount);
+        QThreadPool pool;
+        pool.setMaxThreadCount(qMax(4, QThread::idealThreadCount()));
+        for (int i = 0; i < ChartCount; ++i) {
+            pool.start([this, &images, i]() {
+                images[i] = render(m_charts.at(i), targetSize(i));
+            });
+        }
+        pool.waitForDone();
+
+        for (int i = 0; i < ChartCount; ++i) {
+            const QString message = QString::fromLatin1("chart %1").arg(i);
+            QCOMPARE(images.at(i).size(), targetSize(i));
+            QVERIFY2(images.at(i) == serialImages.at(i), qPrintable(message));
+            // only the GUI thread paints markers from sprites, whose antialiased edges differ a little
+            QVERIFY2(differingPixels(images.at(i), m_references.at(i)) < 0.01, qPrintable(message));
+        }
+    }
+
+    void testNoLayoutOffGuiThread()
+    {
+        // another size would need a new layout, which only the GUI thread may do
+        Chart *chart = m_charts.at(2);
+        const QSize otherSize = targetSize(2) + QSize(100, 100);
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression(QStringLiteral("not laid out")));
+        QImage image;
+        QThread *thread = QThread::create([chart, otherSize, &image]() {
+            image = render(chart, otherSize);
+        });
+        thread->start();
+        QVERIFY(thread->wait(30000));
+        delete thread;
+        QImage blank(otherSize, QImage::Format_ARGB32_Premultiplied);
+        blank.fill(Qt::white);
+        QCOMPARE(image, blank);
+
+        // the chart has kept its layout
+        QCOMPARE(render(chart, targetSize(2)), m_references.at(2));
+    }
+
+    void testScalingDoesNotLeak()
+    {
+        // a rendering does not leave its scaling behind for the next one
+        const QImage before = render(m_charts.first(), targetSize(0));
+        render(m_charts.at(1), QSize(1200, 900));
+        QCOMPARE(render(m_charts.first(), targetSize(0)), before);
+    }
+
+    void testPaintTiled()
+    {
+        const QImage before = render(m_charts.first(), targetSize(0));
+        const QSize size(1600, 1200);
+        for (int i = 0; i < 2; ++i) {
+            Chart *chart = m_charts.at(i);
+            const QImage reference = render(chart, size);
+
+            QImage tiled(size, QImage::Format_ARGB32_Premultiplied);
+            tiled.fill(Qt::white);
+            chart->paintTiled(&tiled, 8);
+            QCOMPARE(tiled.size(), size);
+            QVERIFY(differingPixels(tiled, reference) < 0.01);
+
+            // the bands depend on the number of threads, their seams must not show
+            QImage serial(size, QImage::Format_ARGB32_Premultiplied);
+            serial.fill(Qt::white);
+            chart->paintTiled(&serial, 1);
+            QVERIFY(differingPixels(serial, tiled) < 0.001);
+        }
+        // the tiled rendering leaves the layout of the chart as it found it
+        QCOMPARE(render(m_charts.first(), targetSize(0)), before);
+    }
+
+private:
+    QVector<Chart *> m_charts;
+    // the renderings made in the GUI thread
+    QVector<QImage> m_references;
+};
+
+QTEST_MAIN(TestConcurrentRendering)
+
+#include "main.moc"
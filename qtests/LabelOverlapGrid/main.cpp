@@ -0,0 +1,145 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#include <QPainterPath>
+#include <QPolygon>
+#include <QRandomGenerator>
+#include <QTransform>
+#include <QtTest/QtTest>
+
+#include <KDChartLabelOverlapGrid_p.h>
+
+using KDChart::LabelOverlapGrid;
+
+// what the diagrams did before the grid: test each new label against all others
+class LinearScan
+{
+public:
+    bool addIfFree(const QPolygonF &area)
+    {
+        QPainterPath path;
+        path.addPolygon(area);
+        for (int i = m_paths.count() - 1; i >= 0; --i) {
+            if (m_paths.at(i).intersects(path)) {
+                return false;
+            }
+        }
+        m_paths.append(path);
+        return true;
+    }
+
+private:
+    QList<QPainterPath> m_paths;
+};
+
+// a label of size at center, rotated like data value labels are
+static QPolygonF labelArea(const QPointF &center, const QSize &size, qreal rotation)
+{
+    QTransform transform;
+    transform.translate(center.x(), center.y());
+    transform.rotate(rotation);
+    return QPolygonF(transform.mapToPolygon(QRect(QPoint(-size.width() / 2, -size.height() / 2), size)));
+}
+
+class TestLabelOverlapGrid : public QObject
+{
+    Q_OBJECT
+private slots:
+
+    void testKeepsAndDrops()
+    {
+        LabelOverlapGrid grid;
+        QVERIFY(grid.addIfFree(QPolygonF(QRectF(0, 0, 40, 10)), false));
+        QVERIFY(!grid.addIfFree(QPolygonF(QRectF(30, 5, 40, 10)), false));
+        QVERIFY(grid.addIfFree(QPolygonF(QRectF(50, 0, 40, 10)), false));
+        QVERIFY(grid.addIfFree(QPolygonF(QRectF(0, 20, 40, 10)), false));
+        QVERIFY(!grid.addIfFree(labelArea(QPointF(45, 15), QSize(40, 10), 30), false));
+
+        // an area covering too many cells for the grid is tested against all others...
+        QVERIFY(!grid.addIfFree(QPolygonF(QRectF(-1000, -1000, 2000, 2000)), false));
+        QVERIFY(grid.addIfFree(QPolygonF(QRectF(200, 200, 2000, 1000)), false));
+        // ...and all later ones are tested against it
+        QVERIFY(!grid.addIfFree(QPolygonF(QRectF(500, 500, 40, 10)), false));
+        QVERIFY(!grid.addIfFree(labelArea(QPointF(210, 195), QSize(40, 10), 45), false));
+        QVERIFY(grid.addIfFree(QPolygonF(QRectF(100, 100, 40, 10)), false));
+
+        grid.clear();
+        QVERIFY(grid.addIfFree(QPolygonF(QRectF(500, 500, 40, 10)), false));
+    }
+
+    void testMatchesLinearScan_data()
+    {
+        QTest::addColumn<int>("maxRotation");
+        QTest::addColumn<int>("oversizedEvery");
+        QTest::addColumn<bool>("tinyFirstLabel");
+
+        QTest::newRow("unrotated") << 0 << 0 << false;
+        QTest::newRow("rotated") << 90 << 0 << false;
+        QTest::newRow("oversized") << 45 << 25 << false;
+        // the first label decides the cell size, so all later ones cover many cells
+        QTest::newRow("tiny first label") << 45 << 0 << true;
+        QTest::newRow("oversized, tiny first label") << 0 << 10 << true;
+    }
+
+    void testMatchesLinearScan()
+    {
+        QFETCH(int, maxRotation);
+        QFETCH(int, oversizedEvery);
+        QFETCH(bool, tinyFirstLabel);
+
+        QRandomGenerator random(4711);
+        LabelOverlapGrid grid;
+        LinearScan linearScan;
+        if (tinyFirstLabel) {
+            const QPolygonF area(QRectF(-50, -50, 2, 2));
+            QCOMPARE(grid.addIfFree(area, false), linearScan.addIfFree(area));
+        }
+
+        int kept = 0;
+        const int labelCount = 2000;
+        for (int i = 0; i < labelCount; ++i) {
+            const QPointF center(random.bounded(1600), random.bounded(1200));
+            QSize size(20 + random.bounded(60), 10 + random.bounded(10));
+            if (oversizedEvery > 0 && i % oversizedEvery == oversizedEvery - 1) {
+                size = QSize(400 + random.bounded(800), 100 + random.bounded(300));
+            }
+            const qreal rotation = maxRotation > 0 ? random.bounded(2 * maxRotation) - maxRotation : 0;
+            const QPolygonF area = labelArea(center, size, rotation);
+
+            const bool expected = linearScan.addIfFree(area);
+            QVERIFY2(grid.addIfFree(area, false) == expected, qPrintable(QString::fromLatin1("label %1").arg(i)));
+            kept += expected ? 1 : 0;
+        }
+        // both outcomes need to be covered
+        QVERIFY(kept > 10);
+        QVERIFY(kept < labelCount - 10);
+    }
+
+    void testRectsMatchLinearScan()
+    {
+        // unrotated labels compared by their rects alone give the same result
+        QRandomGenerator random(815);
+        LabelOverlapGrid grid;
+        LinearScan linearScan;
+        for (int i = 0; i < 2000; ++i) {
+            QSize size(20 + random.bounded(60), 10 + random.bounded(10));
+            if (i % 50 == 49) {
+                size = QSize(1000, 400);
+            }
+            const QPolygonF area = labelArea(QPointF(random.bounded(1600), random.bounded(1200)), size, 0);
+            QVERIFY2(grid.addIfFree(area, true) == linearScan.addIfFree(area),
+                     qPrintable(QString::fromLatin1("label %1").arg(i)));
+        }
+    }
+};
+
+QTEST_MAIN(TestLabelOverlapGrid)
+
+#include "main.moc"
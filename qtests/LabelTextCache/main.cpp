@@ -0,0 +1,139 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#include <QAbstractTextDocumentLayout>
+#include <QImage>
+#include <QTextDocument>
+#include <QtTest/QtTest>
+
+#include <KDChartLabelTextCache_p.h>
+
+using KDChart::LabelTextCache;
+
+// the size that data value labels had when they were always laid out by QTextDocument
+static QSizeF documentSize(const QString &text, const QFont &font, QPaintDevice *device)
+{
+    QTextDocument doc;
+    doc.setDocumentMargin(0.0);
+    doc.setPlainText(text);
+    doc.setDefaultFont(font);
+    if (device) {
+        doc.documentLayout()->setPaintDevice(device);
+    }
+    return doc.documentLayout()->frameBoundingRect(doc.rootFrame()).size();
+}
+
+static QImage imageWithDpi(int dpi)
+{
+    QImage image(16, 16, QImage::Format_ARGB32_Premultiplied);
+    const int dotsPerMeter = qRound(dpi / 0.0254);
+    image.setDotsPerMeterX(dotsPerMeter);
+    image.setDotsPerMeterY(dotsPerMeter);
+    return image;
+}
+
+class TestLabelTextCache : public QObject
+{
+    Q_OBJECT
+private slots:
+
+    void testSizesMatchTextDocument_data()
+    {
+        QTest::addColumn<QFont>("font");
+        QTest::addColumn<int>("dpi");
+
+        QFont small;
+        small.setPointSizeF(7.5);
+        QFont bold;
+        bold.setPointSize(14);
+        bold.setBold(true);
+        QFont serif(QStringLiteral("Serif"));
+        serif.setPointSize(10);
+        serif.setItalic(true);
+        QFont pixels;
+        pixels.setPixelSize(20);
+
+        // a dpi of 0 measures for the screen
+        for (int dpi : {0, 72, 96, 300}) {
+            const QByteArray suffix = " @ " + QByteArray::number(dpi);
+            QTest::newRow(("small" + suffix).constData()) << small << dpi;
+            QTest::newRow(("bold" + suffix).constData()) << bold << dpi;
+            QTest::newRow(("serif" + suffix).constData()) << serif << dpi;
+            QTest::newRow(("pixels" + suffix).constData()) << pixels << dpi;
+        }
+    }
+
+    void testSizesMatchTextDocument()
+    {
+        QFETCH(QFont, font);
+        QFETCH(int, dpi);
+
+        QImage image = imageWithDpi(dpi);
+        QPaintDevice *device = dpi > 0 ? &image : nullptr;
+        LabelTextCache cache;
+        const QStringList texts = {QStringLiteral("0"), QStringLiteral("-1234.5678"), QStringLiteral("42 %"),
+                                   QStringLiteral("Label with spaces"), QString::fromUtf8("\xc3\x84rger \xe2\x82\xac 3,5")};
+        for (const QString &text : texts) {
+            const LabelTextCache::Layout layout = cache.layout(text, font, device);
+            QVERIFY(layout.isPlainText());
+            const QSizeF expected = documentSize(text, font, device);
+            // QTextDocument rounds its line metrics, QStaticText does not
+            const QString message = QStringLiteral("%1: %2x%3 instead of %4x%5")
+                                        .arg(text)
+                                        .arg(layout.size.width())
+                                        .arg(layout.size.height())
+                                        .arg(expected.width())
+                                        .arg(expected.height());
+            QVERIFY2(qAbs(layout.size.width() - expected.width()) <= 1.0
+                         && qAbs(layout.size.height() - expected.height()) <= 1.0,
+                     qPrintable(message));
+        }
+
+        // rich text and several lines still go through QTextDocument
+        const LabelTextCache::Layout richText = cache.layout(QStringLiteral("<b>bold</b>"), font, device);
+        QVERIFY(!richText.isPlainText());
+        const LabelTextCache::Layout lines = cache.layout(QStringLiteral("two\nlines"), font, device);
+        QVERIFY(!lines.isPlainText());
+        QCOMPARE(lines.size, documentSize(QStringLiteral("two\nlines"), font, device));
+    }
+
+    void testCacheHits()
+    {
+        LabelTextCache cache;
+        const QFont font;
+        QImage image = imageWithDpi(144);
+
+        const QSizeF screenSize = cache.layout(QStringLiteral("12.5"), font).size;
+        QCOMPARE(cache.count(), 1);
+        QCOMPARE(cache.layout(QStringLiteral("12.5"), font).size, screenSize);
+        QCOMPARE(cache.count(), 1);
+        // another resolution is another layout
+        cache.layout(QStringLiteral("12.5"), font, &image);
+        QCOMPARE(cache.count(), 2);
+
+        for (int i = cache.count(); i < LabelTextCache::MaxLayouts; ++i) {
+            cache.layout(QString::number(i), font);
+        }
+        QCOMPARE(cache.count(), int(LabelTextCache::MaxLayouts));
+
+        // a full cache is dropped before the next layout is added...
+        const QSizeF size = cache.layout(QStringLiteral("overflow"), font).size;
+        QCOMPARE(cache.count(), 1);
+        // ...which is then found again
+        QCOMPARE(cache.layout(QStringLiteral("overflow"), font).size, size);
+        QCOMPARE(cache.count(), 1);
+        cache.layout(QStringLiteral("12.5"), font);
+        QCOMPARE(cache.count(), 2);
+    }
+};
+
+QTEST_MAIN(TestLabelTextCache)
+
+#include "main.moc"
@@ -10,13 +10,21 @@
 
 #include <KDChartCartesianCoordinatePlane>
 #include <KDChartChart>
+#include <KDChartDataValueAttributes>
 #include <KDChartGlobal>
 #include <KDChartLineDiagram>
+#include <KDChartMarkerAttributes>
 #include <KDChartThreeDLineAttributes>
+#include <QImage>
+#include <QPainter>
+#include <QPicture>
+#include <QStandardItemModel>
 #include <QtTest/QtTest>
 
 #include <TableModel.h>
 
+#include <cmath>
+
 using namespace KDChart;
 
 class TestLineDiagrams : public QObject
@@ -155,6 +163,222 @@ private slots:
         QVERIFY(m_lines->threeDLineAttributes().lineYRotation() == 25);
     }
 
+    void testLineSegmentsMapToCells()
+    {
+        QStandardItemModel model(6, 2);
+        for (int row = 0; row < model.rowCount(); ++row) {
+            model.setData(model.index(row, 0), row);
+            model.setData(model.index(row, 1), row * row + 10);
+        }
+        Chart chart;
+        auto *lines = new LineDiagram();
+        lines->setModel(&model);
+        chart.coordinatePlane()->replaceDiagram(lines);
+        // a cell with a pen of its own makes the lines be painted segment by segment
+        lines->setPen(model.index(3, 1), QPen(Qt::red, 3));
+
+        QImage image(400, 300, QImage::Format_ARGB32_Premultiplied);
+        QPainter painter(&image);
+        chart.paint(&painter, image.rect());
+
+        for (int column = 0; column < model.columnCount(); ++column) {
+            // every segment, batched or not, is found at its cell
+            for (int row = 1; row < model.rowCount(); ++row) {
+                const QModelIndex index = lines->model()->index(row, column);
+                const QRect rect = lines->visualRect(index);
+                QVERIFY(!rect.isEmpty());
+                QCOMPARE(lines->indexAt(rect.center()), index);
+            }
+        }
+    }
+
+    void testSourceModelPenForOneCell()
+    {
+        QStandardItemModel model(10, 1);
+        for (int row = 0; row < model.rowCount(); ++row) {
+            model.setData(model.index(row, 0), row % 4);
+        }
+        // only a cell far from the first row has a pen of its own
+        const QColor cellColor(0, 255, 0);
+        model.setData(model.index(5, 0), QVariant::fromValue(QPen(cellColor, 5)), DatasetPenRole);
+        Chart chart;
+        auto *lines = new LineDiagram();
+        lines->setModel(&model);
+        chart.coordinatePlane()->replaceDiagram(lines);
+
+        QImage image(400, 300, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::white);
+        {
+            QPainter painter(&image);
+            chart.paint(&painter, image.rect());
+        }
+        int cellPixels = 0;
+        for (int y = 0; y < image.height(); ++y) {
+            for (int x = 0; x < image.width(); ++x) {
+                cellPixels += image.pixelColor(x, y) == cellColor ? 1 : 0;
+            }
+        }
+        QVERIFY(cellPixels > 0);
+    }
+
+    void testHitTestingDisabled()
+    {
+        QStandardItemModel model(4, 1);
+        for (int row = 0; row < model.rowCount(); ++row) {
+            model.setData(model.index(row, 0), row);
+        }
+        Chart chart;
+        auto *lines = new LineDiagram();
+        lines->setModel(&model);
+        chart.coordinatePlane()->replaceDiagram(lines);
+        QVERIFY(lines->isHitTestingEnabled());
+        lines->setHitTestingEnabled(false);
+
+        QImage image(400, 300, QImage::Format_ARGB32_Premultiplied);
+        QPainter painter(&image);
+        chart.paint(&painter, image.rect());
+        const QModelIndex index = lines->model()->index(2, 0);
+        QVERIFY(lines->visualRect(index).isEmpty());
+
+        lines->setHitTestingEnabled(true);
+        chart.paint(&painter, image.rect());
+        const QRect rect = lines->visualRect(index);
+        QVERIFY(!rect.isEmpty());
+        QCOMPARE(lines->indexAt(rect.center()), index);
+    }
+
+    void testMarkerSpritesMatchVectorMarkers()
+    {
+        QStandardItemModel model(6, 1);
+        for (int row = 0; row < model.rowCount(); ++row) {
+            model.setData(model.index(row, 0), row % 3);
+        }
+        Chart chart;
+        auto *lines = new LineDiagram();
+        lines->setModel(&model);
+        chart.coordinatePlane()->replaceDiagram(lines);
+        DataValueAttributes dva = lines->dataValueAttributes();
+        dva.setVisible(true);
+        TextAttributes ta = dva.textAttributes();
+        ta.setVisible(false);
+        dva.setTextAttributes(ta);
+        MarkerAttributes ma = dva.markerAttributes();
+        ma.setVisible(true);
+        ma.setMarkerStyle(MarkerAttributes::MarkerCircle);
+        ma.setThreeD(true);
+        ma.setMarkerSize(QSizeF(14, 14));
+        dva.setMarkerAttributes(ma);
+        lines->setDataValueAttributes(dva);
+
+        // painted on an image, the markers come from sprites
+        QImage sprites(400, 300, QImage::Format_ARGB32_Premultiplied);
+        sprites.fill(Qt::white);
+        {
+            QPainter painter(&sprites);
+            chart.paint(&painter, sprites.rect());
+        }
+        // a picture records vector graphics
+        QPicture picture;
+        {
+            QPainter painter(&picture);
+            chart.paint(&painter, sprites.rect());
+        }
+        QImage vectors(sprites.size(), sprites.format());
+        vectors.fill(Qt::white);
+        {
+            QPainter painter(&vectors);
+            picture.play(&painter);
+        }
+
+        // only the antialiased edges of the markers may differ slightly
+        int differentPixels = 0;
+        for (int y = 0; y < sprites.height(); ++y) {
+            for (int x = 0; x < sprites.width(); ++x) {
+                const QRgb a = sprites.pixel(x, y);
+                const QRgb b = vectors.pixel(x, y);
+                if (qAbs(qRed(a) - qRed(b)) > 96 || qAbs(qGreen(a) - qGreen(b)) > 96 || qAbs(qBlue(a) - qBlue(b)) > 96) {
+                    ++differentPixels;
+                }
+            }
+        }
+        QVERIFY(differentPixels < model.rowCount() * 20);
+    }
+
+    void testVectorMarkersKeepTheirOrder()
+    {
+        QStandardItemModel model(3, 1);
+        for (int row = 0; row < model.rowCount(); ++row) {
+            model.setData(model.index(row, 0), 1);
+        }
+        Chart chart;
+        auto *lines = new LineDiagram();
+        lines->setModel(&model);
+        lines->setPen(QPen(Qt::black));
+        chart.coordinatePlane()->replaceDiagram(lines);
+
+        const QColor colors[] = {Qt::red, Qt::blue, Qt::green};
+        for (int row = 0; row < model.rowCount(); ++row) {
+            DataValueAttributes dva = lines->dataValueAttributes();
+            dva.setVisible(true);
+            TextAttributes ta = dva.textAttributes();
+            ta.setVisible(false);
+            dva.setTextAttributes(ta);
+            MarkerAttributes ma = dva.markerAttributes();
+            ma.setVisible(true);
+            ma.setMarkerStyle(MarkerAttributes::MarkerSquare);
+            ma.setMarkerColor(colors[row]);
+            ma.setPen(QPen(colors[row]));
+            // too large for a sprite, so the middle marker is drawn as vector graphics
+            ma.setMarkerSize(row == 1 ? QSizeF(1000, 1000) : QSizeF(10, 10));
+            dva.setMarkerAttributes(ma);
+            lines->setDataValueAttributes(model.index(row, 0), dva);
+        }
+
+        QImage image(400, 300, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::white);
+        {
+            QPainter painter(&image);
+            chart.paint(&painter, image.rect());
+        }
+
+        // the vector marker covers the sprite painted before it, but not the one after it
+        int redPixels = 0;
+        int greenPixels = 0;
+        for (int y = 0; y < image.height(); ++y) {
+            for (int x = 0; x < image.width(); ++x) {
+                const QRgb pixel = image.pixel(x, y);
+                redPixels += pixel == QColor(Qt::red).rgb() ? 1 : 0;
+                greenPixels += pixel == QColor(Qt::green).rgb() ? 1 : 0;
+            }
+        }
+        QCOMPARE(redPixels, 0);
+        QVERIFY(greenPixels > 0);
+    }
+
+    void areaPaintBenchmark()
+    {
+        const int rowCount = 5000;
+        QStandardItemModel model(rowCount, 2);
+        for (int row = 0; row < rowCount; ++row) {
+            model.setData(model.index(row, 0), std::sin(row * 0.01) * 100.0);
+            model.setData(model.index(row, 1), std::cos(row * 0.013) * 80.0);
+        }
+        Chart chart;
+        auto *lines = new LineDiagram();
+        lines->setModel(&model);
+        LineAttributes la = lines->lineAttributes();
+        la.setDisplayArea(true);
+        la.setTransparency(120);
+        lines->setLineAttributes(la);
+        chart.coordinatePlane()->replaceDiagram(lines);
+
+        QImage image(1200, 800, QImage::Format_ARGB32_Premultiplied);
+        QPainter painter(&image);
+        QBENCHMARK {
+            chart.paint(&painter, image.rect());
+        }
+    }
+
     void cleanupTestCase()
     {
     }
@@ -0,0 +1,229 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#include <QAbstractTableModel>
+#include <QStandardItemModel>
+#include <QtTest/QtTest>
+
+#include <cmath>
+
+#include <KDChartModelDataCache_p.h>
+
+typedef KDChart::ModelDataCache<qreal, Qt::DisplayRole> Cache;
+
+// computes its values, so that huge tables need no memory
+class SyntheticModel : public QAbstractTableModel
+{
+public:
+    SyntheticModel(int rows, int columns)
+        : m_rows(rows)
+    {
+        for (int column = 0; column < columns; ++column)
+            m_columnIds.append(column);
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : m_rows;
+    }
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : m_columnIds.size();
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override
+    {
+        if (role == FlagRole) {
+            ++flagReads;
+            return flag(index.row());
+        }
+        if (role != Qt::DisplayRole)
+            return QVariant();
+        ++reads;
+        return value(index.row(), index.column());
+    }
+
+    static bool flag(int row)
+    {
+        return row % 3 == 0;
+    }
+
+    qreal value(int row, int column) const
+    {
+        return row * 0.5 + m_columnIds.at(column);
+    }
+
+    void insertColumn(int column)
+    {
+        beginInsertColumns(QModelIndex(), column, column);
+        m_columnIds.insert(column, 1000 + m_columnIds.size());
+        endInsertColumns();
+    }
+
+    void removeColumn(int column)
+    {
+        beginRemoveColumns(QModelIndex(), column, column);
+        m_columnIds.remove(column);
+        endRemoveColumns();
+    }
+
+    static const int FlagRole = Qt::UserRole;
+    mutable int reads = 0;
+    mutable int flagReads = 0;
+
+private:
+    int m_rows;
+    QVector<int> m_columnIds;
+};
+
+class ModelDataCacheTests : public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void valuesTest()
+    {
+        QStandardItemModel model(100, 3);
+        for (int row = 0; row < 100; ++row)
+            for (int column = 0; column < 3; ++column)
+                model.setData(model.index(row, column), row * 10.0 + column);
+        Cache cache;
+        cache.setModel(&model);
+        compare(cache, model);
+
+        model.setData(model.index(5, 1), -1.0);
+        model.insertRows(50, 3);
+        model.insertRows(model.rowCount(), 200);
+        model.setData(model.index(model.rowCount() - 1, 2), 42.0);
+        compare(cache, model);
+
+        model.removeRows(0, 10);
+        model.insertColumns(1, 2);
+        model.setData(model.index(7, 2), 4711.0);
+        compare(cache, model);
+
+        model.removeColumns(0, 2);
+        model.insertColumns(3, 1);
+        compare(cache, model);
+
+        model.clear();
+        compare(cache, model);
+    }
+
+    void columnOperationsKeepValuesTest()
+    {
+        SyntheticModel model(BigRowCount, BigColumnCount);
+        Cache cache;
+        cache.setModel(&model);
+        readAll(cache, model);
+
+        // neither inserting nor removing a column touches the values of the others
+        model.insertColumn(3);
+        model.removeColumn(6);
+        model.reads = 0;
+        for (int column = 0; column < model.columnCount(); ++column) {
+            QCOMPARE(cache.data(BigRowCount - 1, column), model.value(BigRowCount - 1, column));
+            QCOMPARE(cache.data(17, column), model.value(17, column));
+        }
+        // only the inserted column is read
+        QCOMPARE(model.reads, 2);
+    }
+
+    void prefetchTest()
+    {
+        SyntheticModel model(1000, 3);
+        Cache cache;
+        cache.setFlagRole(SyntheticModel::FlagRole);
+        cache.setModel(&model);
+
+        cache.data(150, 1);
+        model.reads = 0;
+        model.flagReads = 0;
+        cache.prefetch(1, 100, 300);
+        // every row of the range but the cached one, value and flag together
+        QCOMPARE(model.reads, 199);
+        QCOMPARE(model.flagReads, 199);
+
+        for (int row = 100; row < 300; ++row) {
+            QCOMPARE(cache.data(row, 1), model.value(row, 1));
+            QCOMPARE(cache.flag(row, 1), SyntheticModel::flag(row));
+        }
+        cache.prefetch(1, 100, 300);
+        QCOMPARE(model.reads, 199);
+
+        // the flags move along with their column
+        model.insertColumn(0);
+        QCOMPARE(cache.flag(model.index(99, 2)), SyntheticModel::flag(99));
+        QCOMPARE(cache.flag(model.index(102, 2)), SyntheticModel::flag(102));
+        QCOMPARE(model.reads, 200);
+    }
+
+    void memoryFootprintTest()
+    {
+        SyntheticModel model(BigRowCount, BigColumnCount);
+        Cache cache;
+        cache.setModel(&model);
+        readAll(cache, model);
+
+        // the values plus one bit each, rows are rounded up to a power of two
+        const qint64 valueBytes = qint64(BigRowCount) * BigColumnCount * qint64(sizeof(qreal));
+        QVERIFY(cache.allocatedBytes() <= valueBytes + valueBytes / 8);
+    }
+
+    void accessBenchmark()
+    {
+        SyntheticModel model(BigRowCount, BigColumnCount);
+        Cache cache;
+        cache.setModel(&model);
+        readAll(cache, model);
+
+        qreal sum = 0.0;
+        QBENCHMARK {
+            for (int column = 0; column < BigColumnCount; ++column)
+                for (int row = 0; row < BigRowCount; ++row)
+                    sum += cache.data(row, column);
+        }
+        QVERIFY(sum > 0.0);
+    }
+
+private:
+    static void compare(const Cache &cache, const QAbstractItemModel &model)
+    {
+        for (int row = 0; row < model.rowCount(); ++row) {
+            for (int column = 0; column < model.columnCount(); ++column) {
+                const QVariant expected = model.data(model.index(row, column));
+                const qreal actual = cache.data(model.index(row, column));
+                if (expected.isNull())
+                    QVERIFY(std::isnan(actual));
+                else
+                    QCOMPARE(actual, expected.toReal());
+            }
+        }
+    }
+
+    static void readAll(const Cache &cache, const SyntheticModel &model)
+    {
+        for (int column = 0; column < model.columnCount(); ++column)
+            for (int row = 0; row < model.rowCount(); ++row)
+                cache.data(row, column);
+    }
+
+    static const int BigRowCount;
+    static const int BigColumnCount;
+};
+
+const int ModelDataCacheTests::BigRowCount = 1000000;
+const int ModelDataCacheTests::BigColumnCount = 8;
+
+QTEST_MAIN(ModelDataCacheTests)
+
+#include "ModelDataCacheTests.moc"
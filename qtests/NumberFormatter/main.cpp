@@ -0,0 +1,122 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <cmath>
+
+#include <KDChartNumberFormatter_p.h>
+
+using namespace KDChart;
+
+// how data value texts were formatted before NumberFormatter
+static QString roundedReference(qreal value, int decimalDigits)
+{
+    const int digits = qMax(decimalDigits, 0);
+    const qreal roundingEpsilon = pow(0.1, digits) * (value >= 0.0 ? 0.5 : -0.5);
+    QString asString = QString::number(value + roundingEpsilon, 'f');
+    const int decimalPos = asString.indexOf(QLatin1Char('.'));
+    if (decimalPos < 0) {
+        return asString;
+    }
+    int last = qMin(decimalPos + digits, asString.length() - 1);
+    while (last > decimalPos && asString[last] == QLatin1Char('0')) {
+        last--;
+    }
+    if (last == decimalPos) {
+        last--;
+    }
+    asString.chop(asString.length() - last - 1);
+    return asString;
+}
+
+static QVector<qreal> sampleValues()
+{
+    QVector<qreal> values;
+    values << 0.0 << 1.0 << -1.0 << 0.5 << -0.5 << 1.005 << 2.675 << 99.995 << 1234567.891
+           << -0.0049 << 1e-7 << 3.14159265358979 << 1e15 << -42.25;
+    for (int i = -500; i <= 500; ++i) {
+        values << i * 0.37 << i * 12.5;
+    }
+    return values;
+}
+
+class TestNumberFormatter : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+
+    void testRoundedMatchesReference()
+    {
+        NumberFormatter formatter;
+        const QVector<qreal> values = sampleValues();
+        for (int digits = 0; digits <= 8; ++digits) {
+            for (const qreal value : values) {
+                QCOMPARE(formatter.rounded(value, digits), roundedReference(value, digits));
+                // and again from the cache
+                QCOMPARE(formatter.rounded(value, digits), roundedReference(value, digits));
+            }
+        }
+    }
+
+    void testFixedMatchesQString()
+    {
+        NumberFormatter formatter;
+        const QVector<qreal> values = sampleValues();
+        for (int digits = 0; digits <= 15; ++digits) {
+            for (const qreal value : values) {
+                QCOMPARE(formatter.fixed(value, digits), QString::number(value, 'f', digits));
+            }
+        }
+        QCOMPARE(formatter.fixed(qInf(), 2), QString::number(qInf(), 'f', 2));
+    }
+
+    void testSignificantDecimalDigits()
+    {
+        QCOMPARE(NumberFormatter::significantDecimalDigits(0.0), 0);
+        QCOMPARE(NumberFormatter::significantDecimalDigits(100.0), 0);
+        QCOMPARE(NumberFormatter::significantDecimalDigits(0.25), 2);
+        QCOMPARE(NumberFormatter::significantDecimalDigits(-0.125), 3);
+        QCOMPARE(NumberFormatter::significantDecimalDigits(0.1, 3), 1);
+    }
+
+    void testLocale()
+    {
+        NumberFormatter formatter(QLocale(QLocale::German, QLocale::Germany));
+        QCOMPARE(formatter.fixed(-1.5, 2), QString::fromLatin1("-1,50"));
+        QCOMPARE(formatter.rounded(2.25, 1), QString::fromLatin1("2,3"));
+        QCOMPARE(formatter.rounded(2.0, 3), QString::fromLatin1("2"));
+    }
+
+    void roundedBenchmark_data()
+    {
+        QTest::addColumn<bool>("useFormatter");
+        QTest::newRow("QString") << false;
+        QTest::newRow("NumberFormatter") << true;
+    }
+
+    void roundedBenchmark()
+    {
+        QFETCH(bool, useFormatter);
+        const QVector<qreal> values = sampleValues();
+        NumberFormatter formatter;
+        int length = 0;
+        QBENCHMARK {
+            for (const qreal value : values) {
+                length += useFormatter ? formatter.rounded(value, 2).length() : roundedReference(value, 2).length();
+            }
+        }
+        QVERIFY(length > 0);
+    }
+};
+
+QTEST_MAIN(TestNumberFormatter)
+
+#include "main.moc"
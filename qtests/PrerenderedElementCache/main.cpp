@@ -0,0 +1,205 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#include <QImage>
+#include <QPainter>
+#include <QPixmap>
+#include <QThread>
+#include <QtTest/QtTest>
+
+#include <KDChartTextLabelCache.h>
+
+using namespace KDChart;
+
+static QPixmap filledPixmap(const QColor &color)
+{
+    QPixmap pixmap(16, 16);
+    pixmap.fill(color);
+    return pixmap;
+}
+
+static int pixmapBytes(const QPixmap &pixmap)
+{
+    return pixmap.width() * pixmap.height() * qMax(pixmap.depth(), 8) / 8;
+}
+
+static QByteArray key(int number)
+{
+    return "element " + QByteArray::number(number);
+}
+
+class TestPrerenderedElementCache : public QObject
+{
+    Q_OBJECT
+private slots:
+
+    void init()
+    {
+        cache()->clear();
+        cache()->resetCounters();
+    }
+
+    void cleanupTestCase()
+    {
+        cache()->clear();
+        cache()->setMaximumBytes(m_defaultMaximumBytes);
+        cache()->resetCounters();
+    }
+
+    void testKeys()
+    {
+        const QVector<QPointF> points = {QPointF(1.5, 2.0), QPointF(-3.0, 0.25)};
+        cache()->insert(key(1), filledPixmap(Qt::red), points);
+
+        // keys are compared by their contents
+        QPixmap pixmap;
+        QVector<QPointF> foundPoints;
+        QVERIFY(cache()->find(QByteArray("element ") + '1', &pixmap, &foundPoints));
+        QCOMPARE(pixmap.toImage(), filledPixmap(Qt::red).toImage());
+        QCOMPARE(foundPoints, points);
+        QVERIFY(!cache()->find(key(2), &pixmap));
+        QVERIFY(!cache()->find(key(1) + '\0', &pixmap));
+
+        // inserting again replaces the element
+        cache()->insert(key(1), filledPixmap(Qt::blue));
+        QVERIFY(cache()->find(key(1), &pixmap, &foundPoints));
+        QCOMPARE(pixmap.toImage(), filledPixmap(Qt::blue).toImage());
+        QVERIFY(foundPoints.isEmpty());
+        QCOMPARE(cache()->count(), 1);
+    }
+
+    void testEviction()
+    {
+        const int elementBytes = pixmapBytes(filledPixmap(Qt::red));
+        const int capacity = 4;
+        cache()->setMaximumBytes(capacity * elementBytes);
+        QCOMPARE(cache()->maximumBytes(), capacity * elementBytes);
+
+        for (int i = 0; i < capacity; ++i) {
+            cache()->insert(key(i), filledPixmap(Qt::red));
+        }
+        QCOMPARE(cache()->count(), capacity);
+        QCOMPARE(cache()->bytes(), capacity * elementBytes);
+
+        // using the oldest element makes the second one the least recently used
+        QPixmap pixmap;
+        QVERIFY(cache()->find(key(0), &pixmap));
+        cache()->insert(key(capacity), filledPixmap(Qt::red));
+        QCOMPARE(cache()->count(), capacity);
+        QVERIFY(cache()->bytes() <= cache()->maximumBytes());
+        QVERIFY(!cache()->find(key(1), &pixmap));
+        for (int i : {0, 2, 3, capacity}) {
+            QVERIFY2(cache()->find(key(i), &pixmap), key(i).constData());
+        }
+
+        // an element larger than the budget is not stored at all
+        QPixmap large(64, 64);
+        large.fill(Qt::green);
+        QVERIFY(pixmapBytes(large) > cache()->maximumBytes());
+        cache()->insert(key(100), large);
+        QVERIFY(!cache()->find(key(100), &pixmap));
+        QCOMPARE(cache()->count(), capacity);
+
+        // a smaller budget drops elements right away
+        cache()->setMaximumBytes(2 * elementBytes);
+        QCOMPARE(cache()->count(), 2);
+        QVERIFY(cache()->bytes() <= cache()->maximumBytes());
+
+        cache()->setMaximumBytes(m_defaultMaximumBytes);
+    }
+
+    void testCounters()
+    {
+        QPixmap pixmap;
+        QVERIFY(!cache()->find(key(1), &pixmap));
+        cache()->insert(key(1), filledPixmap(Qt::red));
+        QVERIFY(cache()->find(key(1), &pixmap));
+        QVERIFY(cache()->find(key(1), &pixmap));
+        QVERIFY(!cache()->find(key(2), &pixmap));
+        QCOMPARE(cache()->hitCount(), 2);
+        QCOMPARE(cache()->missCount(), 2);
+
+        cache()->resetCounters();
+        QCOMPARE(cache()->hitCount(), 0);
+        QCOMPARE(cache()->missCount(), 0);
+        // the elements stay
+        QCOMPARE(cache()->count(), 1);
+        cache()->clear();
+        QCOMPARE(cache()->count(), 0);
+        QCOMPARE(cache()->bytes(), 0);
+    }
+
+    void testLabelsShareRenderings()
+    {
+        PrerenderedLabel label;
+        label.setText(QStringLiteral("Label"));
+        label.setAngle(30.0);
+        QVERIFY(!label.pixmap().isNull());
+        QCOMPARE(cache()->count(), 1);
+        QCOMPARE(cache()->missCount(), 1);
+
+        PrerenderedLabel twin;
+        twin.setText(QStringLiteral("Label"));
+        twin.setAngle(30.0);
+        QCOMPARE(twin.pixmap().toImage(), label.pixmap().toImage());
+        QCOMPARE(twin.referencePointLocation(KDChartEnums::PositionNorthWest),
+                 label.referencePointLocation(KDChartEnums::PositionNorthWest));
+        QCOMPARE(cache()->hitCount(), 1);
+
+        label.setText(QStringLiteral("Other label"));
+        QVERIFY(!label.pixmap().isNull());
+        QCOMPARE(cache()->count(), 2);
+    }
+
+    void testLabelsOutsideOfGuiThread()
+    {
+        PrerenderedLabel reference;
+        reference.setText(QStringLiteral("Threaded"));
+        const QImage expected = reference.pixmap().toImage();
+        cache()->clear();
+        cache()->resetCounters();
+
+        PrerenderedLabel label;
+        label.setText(QStringLiteral("Threaded"));
+        QImage drawn(expected.size(), QImage::Format_ARGB32_Premultiplied);
+        bool pixmapIsNull = false;
+        QThread *thread = QThread::create([&]() {
+            pixmapIsNull = label.pixmap().isNull();
+            drawn.fill(Qt::transparent);
+            QPainter painter(&drawn);
+            label.draw(&painter, QPointF(0.0, 0.0));
+        });
+        thread->start();
+        QVERIFY(thread->wait(30000));
+        delete thread;
+
+        // no pixmaps were created and the cache was left alone...
+        QVERIFY(pixmapIsNull);
+        QCOMPARE(cache()->count(), 0);
+        QCOMPARE(cache()->hitCount() + cache()->missCount(), 0);
+        // ...but the label looks the same
+        QCOMPARE(drawn, expected.convertToFormat(QImage::Format_ARGB32_Premultiplied));
+        // and becomes a pixmap once it is back on the GUI thread
+        QCOMPARE(label.pixmap().toImage().convertToFormat(QImage::Format_ARGB32_Premultiplied),
+                 expected.convertToFormat(QImage::Format_ARGB32_Premultiplied));
+    }
+
+private:
+    static PrerenderedElementCache *cache()
+    {
+        return PrerenderedElementCache::instance();
+    }
+
+    const int m_defaultMaximumBytes = PrerenderedElementCache::instance()->maximumBytes();
+};
+
+QTEST_MAIN(TestPrerenderedElementCache)
+
+#include "main.moc"
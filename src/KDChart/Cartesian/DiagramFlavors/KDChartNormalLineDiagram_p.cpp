@@ -61,12 +61,12 @@ void NormalLineDiagram::paintWithLines(PaintContext *ctx)
     // Reverse order of data sets?
     bool rev = diagram()->reverseDatasetOrder();
     LabelPaintCache lpc;
-    LineAttributesInfoList lineList;
+    PaintingHelpers::LineBatch lines(m_private);
+    PaintingHelpers::AreaBatch areas(m_private, ctx);
 
     const int step = rev ? -1 : 1;
     const int end = rev ? -1 : columnCount;
     for (int column = rev ? columnCount - 1 : 0; column != end; column += step) {
-        LineAttributes laPreviousCell;
         CartesianDiagramDataCompressor::DataPoint lastPoint;
         qreal lastAreaBoundingValue = 0;
 
@@ -84,7 +84,7 @@ void NormalLineDiagram::paintWithLines(PaintContext *ctx)
 
             const QModelIndex sourceIndex = attributesModel()->mapToSource(point.index);
 
-            const LineAttributes laCell = diagram()->lineAttributes(sourceIndex);
+            const LineAttributes &laCell = m_private->styleSnapshot.lineAttributes.value(sourceIndex);
             const LineAttributes::MissingValuesPolicy policy = laCell.missingValuesPolicy();
 
             // lower or upper bounding for the highlighted area
@@ -130,26 +130,24 @@ void NormalLineDiagram::paintWithLines(PaintContext *ctx)
 
                 // add line and area, if switched on and we have a current and previous value
                 if (!ISNAN(a.x()) && !ISNAN(a.y()) && !ISNAN(b.x()) && !ISNAN(b.y())) {
-                    lineList.append(LineAttributesInfo(sourceIndex, a, b));
+                    lines.addLine(sourceIndex, a, b);
 
                     if (laCell.displayArea()) {
-                        QList<QPolygonF> areas;
-                        areas << (QPolygonF() << a << b << d << c);
-                        PaintingHelpers::paintAreas(m_private, ctx, attributesModel()->mapToSource(lastPoint.index),
-                                                    areas, laCell.transparency());
+                        areas.addArea(attributesModel()->mapToSource(lastPoint.index), a, b, c, d,
+                                      laCell.transparency());
                     }
                 }
             }
 
             previousCellPosition = position;
-            laPreviousCell = laCell;
             lastAreaBoundingValue = areaBoundingValue;
             lastPoint = point;
         }
+        areas.flush();
     }
 
     // paint the lines
-    PaintingHelpers::paintElements(m_private, ctx, lpc, lineList);
+    PaintingHelpers::paintElements(m_private, ctx, lpc, lines);
 }
 
 void NormalLineDiagram::paintWithSplines(PaintContext *ctx, qreal tension)
@@ -165,14 +163,13 @@ void NormalLineDiagram::paintWithSplines(PaintContext *ctx, qreal tension)
     // Reverse order of data sets?
     bool rev = diagram()->reverseDatasetOrder();
     LabelPaintCache lpc;
-    LineAttributesInfoList lineList;
+    PaintingHelpers::LineBatch lines(m_private);
 
     const auto mainSplineDirection = plane->isHorizontalRangeReversed() ? ReverseSplineDirection : NormalSplineDirection;
 
     const int step = rev ? -1 : 1;
     const int end = rev ? -1 : columnCount;
     for (int column = rev ? columnCount - 1 : 0; column != end; column += step) {
-        LineAttributes laPreviousCell;
         CartesianDiagramDataCompressor::DataPoint lastPoint;
         qreal lastAreaBoundingValue = 0;
 
@@ -190,7 +187,7 @@ void NormalLineDiagram::paintWithSplines(PaintContext *ctx, qreal tension)
 
             const QModelIndex sourceIndex = attributesModel()->mapToSource(point.index);
 
-            const LineAttributes laCell = diagram()->lineAttributes(sourceIndex);
+            const LineAttributes &laCell = m_private->styleSnapshot.lineAttributes.value(sourceIndex);
             const LineAttributes::MissingValuesPolicy policy = laCell.missingValuesPolicy();
 
             // lower or upper bounding for the highlighted area
@@ -236,7 +233,7 @@ void NormalLineDiagram::paintWithSplines(PaintContext *ctx, qreal tension)
 
                 // add line and area, if switched on and we have a current and previous value
                 if (!ISNAN(lastPoint.value)) {
-                    lineList.append(LineAttributesInfo(sourceIndex, a, b));
+                    lines.addLine(sourceIndex, a, b);
 
                     if (laCell.displayArea()) {
                         QPainterPath path;
@@ -293,12 +290,11 @@ void NormalLineDiagram::paintWithSplines(PaintContext *ctx, qreal tension)
             }
 
             previousCellPosition = position;
-            laPreviousCell = laCell;
             lastAreaBoundingValue = areaBoundingValue;
             lastPoint = point;
         }
     }
 
     // paint the lines
-    PaintingHelpers::paintElements(m_private, ctx, lpc, lineList);
+    PaintingHelpers::paintElements(m_private, ctx, lpc, lines);
 }
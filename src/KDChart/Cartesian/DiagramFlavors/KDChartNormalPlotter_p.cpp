@@ -29,7 +29,7 @@ Plotter::PlotType NormalPlotter::type() const
 
 const QPair<QPointF, QPointF> NormalPlotter::calculateDataBoundaries() const
 {
-    if (diagram()->useDataCompression() != Plotter::NONE)
+    if (plotterPrivate()->usesPlotterCompressor())
         return plotterCompressor().dataBoundaries();
     else
         return compressor().dataBoundaries();
@@ -46,15 +46,16 @@ void NormalPlotter::paint(PaintContext *ctx)
 
     LabelPaintCache lpc;
 
-    if (diagram()->useDataCompression() != Plotter::NONE) {
+    if (plotterPrivate()->usesPlotterCompressor()) {
         for (int dataset = 0; dataset < plotterCompressor().datasetCount(); ++dataset) {
-            LineAttributesInfoList lineList;
+            PaintingHelpers::LineBatch lines(m_private);
+            PaintingHelpers::AreaBatch areas(m_private, ctx);
             PlotterDiagramCompressor::DataPoint lastPoint;
             for (PlotterDiagramCompressor::Iterator it = plotterCompressor().begin(dataset); it != plotterCompressor().end(dataset); ++it) {
                 const PlotterDiagramCompressor::DataPoint point = *it;
 
                 const QModelIndex sourceIndex = attributesModel()->mapToSource(point.index);
-                LineAttributes laCell = diagram()->lineAttributes(sourceIndex);
+                const LineAttributes &laCell = m_private->styleSnapshot.lineAttributes.value(sourceIndex);
                 const LineAttributes::MissingValuesPolicy policy = laCell.missingValuesPolicy();
 
                 if (ISNAN(point.key) || ISNAN(point.value)) {
@@ -85,31 +86,28 @@ void NormalPlotter::paint(PaintContext *ctx)
                     const bool lineValid = a.toPoint() != b.toPoint() && PaintingHelpers::isFinite(a);
                     if (lineValid) {
                         // data line
-                        lineList.append(LineAttributesInfo(sourceIndex, a, b));
+                        lines.addLine(sourceIndex, a, b);
 
                         if (laCell.displayArea()) {
                             // data area
-                            QList<QPolygonF> areas;
-                            QPolygonF polygon;
-                            polygon << a << b << d << c;
-                            areas << polygon;
-                            PaintingHelpers::paintAreas(m_private, ctx,
-                                                        attributesModel()->mapToSource(lastPoint.index),
-                                                        areas, laCell.transparency());
+                            areas.addArea(attributesModel()->mapToSource(lastPoint.index), a, b, c, d,
+                                          laCell.transparency());
                         }
                     }
                 }
 
                 lastPoint = point;
             }
-            PaintingHelpers::paintElements(m_private, ctx, lpc, lineList);
+            areas.flush();
+            PaintingHelpers::paintElements(m_private, ctx, lpc, lines);
         }
 
     } else {
         if (colCount == 0 || rowCount == 0)
             return;
         for (int column = 0; column < colCount; ++column) {
-            LineAttributesInfoList lineList;
+            PaintingHelpers::LineBatch lines(m_private);
+            PaintingHelpers::AreaBatch areas(m_private, ctx);
             CartesianDiagramDataCompressor::DataPoint lastPoint;
 
             for (int row = 0; row < rowCount; ++row) {
@@ -117,7 +115,7 @@ void NormalPlotter::paint(PaintContext *ctx)
                 const CartesianDiagramDataCompressor::DataPoint point = compressor().data(position);
 
                 const QModelIndex sourceIndex = attributesModel()->mapToSource(point.index);
-                LineAttributes laCell = diagram()->lineAttributes(sourceIndex);
+                const LineAttributes &laCell = m_private->styleSnapshot.lineAttributes.value(sourceIndex);
                 const LineAttributes::MissingValuesPolicy policy = laCell.missingValuesPolicy();
 
                 if (ISNAN(point.key) || ISNAN(point.value)) {
@@ -148,24 +146,20 @@ void NormalPlotter::paint(PaintContext *ctx)
                     const bool lineValid = a.toPoint() != b.toPoint() && PaintingHelpers::isFinite(a);
                     if (lineValid) {
                         // data line
-                        lineList.append(LineAttributesInfo(sourceIndex, a, b));
+                        lines.addLine(sourceIndex, a, b);
 
                         if (laCell.displayArea()) {
                             // data area
-                            QList<QPolygonF> areas;
-                            QPolygonF polygon;
-                            polygon << a << b << d << c;
-                            areas << polygon;
-                            PaintingHelpers::paintAreas(m_private, ctx,
-                                                        attributesModel()->mapToSource(lastPoint.index),
-                                                        areas, laCell.transparency());
+                            areas.addArea(attributesModel()->mapToSource(lastPoint.index), a, b, c, d,
+                                          laCell.transparency());
                         }
                     }
                 }
 
                 lastPoint = point;
             }
-            PaintingHelpers::paintElements(m_private, ctx, lpc, lineList);
+            areas.flush();
+            PaintingHelpers::paintElements(m_private, ctx, lpc, lines);
         }
     }
 }
@@ -140,7 +140,7 @@ void PercentBarDiagram::paint(PaintContext *ctx)
             const CartesianDiagramDataCompressor::CachePosition position(row, col);
             const CartesianDiagramDataCompressor::DataPoint p = compressor().data(position);
             QModelIndex sourceIndex = attributesModel()->mapToSource(p.index);
-            ThreeDBarAttributes threeDAttrs = diagram()->threeDBarAttributes(sourceIndex);
+            ThreeDBarAttributes threeDAttrs = m_private->styleSnapshot.threeDBarAttributes.value(sourceIndex);
 
             if (threeDAttrs.isEnabled()) {
                 if (barWidth > 0)
@@ -77,7 +77,7 @@ void PercentLineDiagram::paintWithLines(PaintContext *ctx)
     const int lastVisibleColumn = maxFound - 1;
 
     LabelPaintCache lpc;
-    LineAttributesInfoList lineList;
+    PaintingHelpers::LineBatch lines(m_private);
 
     // FIXME(khz): add LineAttributes::MissingValuesPolicy support for LineDiagram::Stacked and ::Percent
 
@@ -91,7 +91,7 @@ void PercentLineDiagram::paintWithLines(PaintContext *ctx)
             const CartesianDiagramDataCompressor::CachePosition position(row, col);
             CartesianDiagramDataCompressor::DataPoint point = compressor().data(position);
             const QModelIndex sourceIndex = attributesModel()->mapToSource(point.index);
-            const LineAttributes laCell = diagram()->lineAttributes(sourceIndex);
+            const LineAttributes &laCell = m_private->styleSnapshot.lineAttributes.value(sourceIndex);
             const LineAttributes::MissingValuesPolicy policy = laCell.missingValuesPolicy();
             if (ISNAN(point.value) && policy == LineAttributes::MissingValuesAreBridged)
                 point.value = interpolateMissingValue(position);
@@ -118,7 +118,7 @@ void PercentLineDiagram::paintWithLines(PaintContext *ctx)
             const CartesianDiagramDataCompressor::CachePosition position(row, column);
             CartesianDiagramDataCompressor::DataPoint point = compressor().data(position);
             const QModelIndex sourceIndex = attributesModel()->mapToSource(point.index);
-            const LineAttributes laCell = diagram()->lineAttributes(sourceIndex);
+            const LineAttributes &laCell = m_private->styleSnapshot.lineAttributes.value(sourceIndex);
             const bool bDisplayCellArea = laCell.displayArea();
 
             qreal stackedValues = 0, nextValues = 0, nextKey = 0;
@@ -175,7 +175,7 @@ void PercentLineDiagram::paintWithLines(PaintContext *ctx)
                 else
                     nextValues = 0.0;
                 QPointF toPoint = ctx->coordinatePlane()->translate(QPointF(diagram()->centerDataPoints() ? nextKey + 0.5 : nextKey, nextValues));
-                lineList.append(LineAttributesInfo(sourceIndex, nextPoint, toPoint));
+                lines.addLine(sourceIndex, nextPoint, toPoint);
                 ptNorthEast = toPoint;
                 ptSouthEast =
                     bDisplayCellArea
@@ -214,7 +214,7 @@ void PercentLineDiagram::paintWithLines(PaintContext *ctx)
         bottomPoints = points;
         bFirstDataset = false;
     }
-    PaintingHelpers::paintElements(m_private, ctx, lpc, lineList);
+    PaintingHelpers::paintElements(m_private, ctx, lpc, lines);
 }
 
 void PercentLineDiagram::paintWithSplines(PaintContext *ctx, qreal tension)
@@ -243,7 +243,7 @@ void PercentLineDiagram::paintWithSplines(PaintContext *ctx, qreal tension)
     const int lastVisibleColumn = maxFound - 1;
 
     LabelPaintCache lpc;
-    LineAttributesInfoList lineList;
+    PaintingHelpers::LineBatch lines(m_private);
 
     // FIXME(khz): add LineAttributes::MissingValuesPolicy support for LineDiagram::Stacked and ::Percent
 
@@ -257,7 +257,7 @@ void PercentLineDiagram::paintWithSplines(PaintContext *ctx, qreal tension)
             const CartesianDiagramDataCompressor::CachePosition position(row, col);
             CartesianDiagramDataCompressor::DataPoint point = compressor().data(position);
             const QModelIndex sourceIndex = attributesModel()->mapToSource(point.index);
-            const LineAttributes laCell = diagram()->lineAttributes(sourceIndex);
+            const LineAttributes &laCell = m_private->styleSnapshot.lineAttributes.value(sourceIndex);
             const LineAttributes::MissingValuesPolicy policy = laCell.missingValuesPolicy();
             if (ISNAN(point.value) && policy == LineAttributes::MissingValuesAreBridged)
                 point.value = interpolateMissingValue(position);
@@ -283,7 +283,7 @@ void PercentLineDiagram::paintWithSplines(PaintContext *ctx, qreal tension)
             CartesianDiagramDataCompressor::DataPoint point = compressor().data(position);
             const QModelIndex sourceIndex = attributesModel()->mapToSource(point.index);
 
-            const LineAttributes laCell = diagram()->lineAttributes(sourceIndex);
+            const LineAttributes &laCell = m_private->styleSnapshot.lineAttributes.value(sourceIndex);
             const bool bDisplayCellArea = laCell.displayArea();
 
             const LineAttributes::MissingValuesPolicy policy = laCell.missingValuesPolicy();
@@ -381,7 +381,7 @@ void PercentLineDiagram::paintWithSplines(PaintContext *ctx, qreal tension)
             if (row + 1 < rowCount) {
                 const auto nextScale = qFuzzyIsNull(percentSumValues.at(row + 1)) ? 0 : maxValue / percentSumValues.at(row + 1);
                 ptNorthEast = dataAt(stackedValuesTop, nextKey, 2, nextScale);
-                lineList.append(LineAttributesInfo(sourceIndex, ptNorthWest, ptNorthEast));
+                lines.addLine(sourceIndex, ptNorthWest, ptNorthEast);
                 ptSouthEast =
                     bDisplayCellArea ? dataAt(stackedValuesBottom, nextKey, 2, nextScale)
                                      : ptNorthEast;
@@ -435,5 +435,5 @@ void PercentLineDiagram::paintWithSplines(PaintContext *ctx, qreal tension)
             areas.clear();
         }
     }
-    PaintingHelpers::paintElements(m_private, ctx, lpc, lineList);
+    PaintingHelpers::paintElements(m_private, ctx, lpc, lines);
 }
@@ -162,8 +162,8 @@ void PercentPlotter::paint(PaintContext *ctx)
     }
 
     for (int column = 0; column < colCount; ++column) {
-        LineAttributesInfoList lineList;
-        LineAttributes laPreviousCell;
+        PaintingHelpers::LineBatch lines(m_private);
+        PaintingHelpers::AreaBatch areas(m_private, ctx);
         CartesianDiagramDataCompressor::CachePosition previousCellPosition;
 
         CartesianDiagramDataCompressor::DataPoint lastPoint;
@@ -192,8 +192,6 @@ void PercentPlotter::paint(PaintContext *ctx)
                     extraY += y;
             }
 
-            LineAttributes laCell;
-
             const qreal scalingFactor =
                 qFuzzyIsNull(yValueSums[i.key()]) ? 0.0 : 100.0 / yValueSums[i.key()];
 
@@ -206,34 +204,29 @@ void PercentPlotter::paint(PaintContext *ctx)
             const QPointF c(plane->translate(QPointF(lastPoint.key, lastExtraY * scalingFactor)));
             const QPointF d(plane->translate(QPointF(point.key, extraY * scalingFactor)));
             // add the line to the list:
-            laCell = diagram()->lineAttributes(sourceIndex);
+            const LineAttributes &laCell = m_private->styleSnapshot.lineAttributes.value(sourceIndex);
             // add data point labels:
             const PositionPoints pts = PositionPoints(b, a, d, c);
-            // if necessary, add the area to the area list:
-            QList<QPolygonF> areas;
-            if (laCell.displayArea()) {
-                QPolygonF polygon;
-                polygon << a << b << d << c;
-                areas << polygon;
-            }
             // add the pieces to painting if this is not hidden:
             if (!point.hidden /*&& !ISNAN( lastPoint.key ) && !ISNAN( lastPoint.value ) */) {
                 m_private->addLabel(&lpc, sourceIndex, nullptr, pts, Position::NorthWest,
                                     Position::NorthWest, value);
                 if (!ISNAN(lastPoint.key) && !ISNAN(lastPoint.value)) {
-                    PaintingHelpers::paintAreas(m_private, ctx,
-                                                attributesModel()->mapToSource(lastPoint.index),
-                                                areas, laCell.transparency());
-                    lineList.append(LineAttributesInfo(sourceIndex, a, b));
+                    // if necessary, add the area:
+                    if (laCell.displayArea()) {
+                        areas.addArea(attributesModel()->mapToSource(lastPoint.index), a, b, c, d,
+                                      laCell.transparency());
+                    }
+                    lines.addLine(sourceIndex, a, b);
                 }
             }
 
             // wrap it up:
-            laPreviousCell = laCell;
             lastPoint = point;
             lastExtraY = extraY;
             lastValue = value;
         }
-        PaintingHelpers::paintElements(m_private, ctx, lpc, lineList);
+        areas.flush();
+        PaintingHelpers::paintElements(m_private, ctx, lpc, lines);
     }
 }
@@ -147,7 +147,7 @@ void StackedBarDiagram::paint(PaintContext *ctx)
             const CartesianDiagramDataCompressor::DataPoint p = compressor().data(position);
 
             const QModelIndex index = attributesModel()->mapToSource(p.index);
-            ThreeDBarAttributes threeDAttrs = diagram()->threeDBarAttributes(index);
+            ThreeDBarAttributes threeDAttrs = m_private->styleSnapshot.threeDBarAttributes.value(index);
             const qreal value = p.value;
             qreal stackedValues = 0.0;
             qreal key = 0.0;
@@ -180,6 +180,8 @@ void StackedBarDiagram::paint(PaintContext *ctx)
                 if (dy < 0) {
                     threeDAttrs.setDepth(point.y() - 1);
                     diagram()->setThreeDBarAttributes(threeDAttrs);
+                    m_private->styleSnapshot.threeDBarAttributes.resolve(attributesModel(), ThreeDBarAttributesRole,
+                                                                        attributesModelRootIndex());
                 }
 
                 point.rx() += offset / 2;
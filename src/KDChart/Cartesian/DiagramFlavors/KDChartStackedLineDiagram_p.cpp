@@ -107,7 +107,7 @@ void StackedLineDiagram::paintWithLines(PaintContext *ctx)
     // ^^^ temp
 
     LabelPaintCache lpc;
-    LineAttributesInfoList lineList;
+    PaintingHelpers::LineBatch lines(m_private);
 
     QVector<qreal> percentSumValues;
 
@@ -128,7 +128,7 @@ void StackedLineDiagram::paintWithLines(PaintContext *ctx)
             CartesianDiagramDataCompressor::DataPoint point = compressor().data(position);
             const QModelIndex sourceIndex = attributesModel()->mapToSource(point.index);
 
-            const LineAttributes laCell = diagram()->lineAttributes(sourceIndex);
+            const LineAttributes &laCell = m_private->styleSnapshot.lineAttributes.value(sourceIndex);
             const bool bDisplayCellArea = laCell.displayArea();
 
             const LineAttributes::MissingValuesPolicy policy = laCell.missingValuesPolicy();
@@ -178,7 +178,7 @@ void StackedLineDiagram::paintWithLines(PaintContext *ctx)
 
             if (row + 1 < rowCount) {
                 QPointF toPoint = ctx->coordinatePlane()->translate(QPointF(diagram()->centerDataPoints() ? nextKey + 0.5 : nextKey, nextValues));
-                lineList.append(LineAttributesInfo(sourceIndex, nextPoint, toPoint));
+                lines.addLine(sourceIndex, nextPoint, toPoint);
                 ptNorthEast = toPoint;
                 ptSouthEast =
                     bDisplayCellArea
@@ -216,7 +216,7 @@ void StackedLineDiagram::paintWithLines(PaintContext *ctx)
         bottomPoints = points;
         bFirstDataset = false;
     }
-    PaintingHelpers::paintElements(m_private, ctx, lpc, lineList);
+    PaintingHelpers::paintElements(m_private, ctx, lpc, lines);
 }
 
 void StackedLineDiagram::paintWithSplines(PaintContext *ctx, qreal tension)
@@ -244,7 +244,7 @@ void StackedLineDiagram::paintWithSplines(PaintContext *ctx, qreal tension)
     // ^^^ temp
 
     LabelPaintCache lpc;
-    LineAttributesInfoList lineList;
+    PaintingHelpers::LineBatch lines(m_private);
 
     QVector<qreal> percentSumValues;
 
@@ -261,7 +261,7 @@ void StackedLineDiagram::paintWithSplines(PaintContext *ctx, qreal tension)
             CartesianDiagramDataCompressor::DataPoint point = compressor().data(position);
             const QModelIndex sourceIndex = attributesModel()->mapToSource(point.index);
 
-            const LineAttributes laCell = diagram()->lineAttributes(sourceIndex);
+            const LineAttributes &laCell = m_private->styleSnapshot.lineAttributes.value(sourceIndex);
             const bool bDisplayCellArea = laCell.displayArea();
 
             const LineAttributes::MissingValuesPolicy policy = laCell.missingValuesPolicy();
@@ -374,7 +374,7 @@ void StackedLineDiagram::paintWithSplines(PaintContext *ctx, qreal tension)
 
             if (row + 1 < rowCount) {
                 ptNorthEast = dataAt(stackedValuesTop, nextKey, 2);
-                lineList.append(LineAttributesInfo(sourceIndex, ptNorthWest, ptNorthEast));
+                lines.addLine(sourceIndex, ptNorthWest, ptNorthEast);
                 ptSouthEast =
                     bDisplayCellArea ? dataAt(stackedValuesBottom, nextKey, 2)
                                      : ptNorthEast;
@@ -428,5 +428,5 @@ void StackedLineDiagram::paintWithSplines(PaintContext *ctx, qreal tension)
             areas.clear();
         }
     }
-    PaintingHelpers::paintElements(m_private, ctx, lpc, lineList);
+    PaintingHelpers::paintElements(m_private, ctx, lpc, lines);
 }
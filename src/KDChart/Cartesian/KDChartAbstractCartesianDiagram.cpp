@@ -11,6 +11,8 @@
 #include "KDChartAbstractCartesianDiagram.h"
 #include "KDChartAbstractCartesianDiagram_p.h"
 
+#include "KDChartCartesianCoordinatePlane.h"
+
 #include <KDABLibFakes>
 
 using namespace KDChart;
@@ -23,6 +25,39 @@ AbstractCartesianDiagram::Private::~Private()
 {
 }
 
+QRectF AbstractCartesianDiagram::Private::keyStripRect(qreal firstKey, qreal lastKey, int firstColumn, int lastColumn) const
+{
+    auto *cartesianPlane = qobject_cast<CartesianCoordinatePlane *>(plane);
+    if (!cartesianPlane || referenceDiagram || isTransposed()) {
+        return QRectF();
+    }
+    // compressed data and logarithmic keys do not map a row range to a key range
+    if (compressor.usePyramid()
+        || compressor.approximationMode() == CartesianDiagramDataCompressor::LargestTriangleThreeBuckets
+        || cartesianPlane->axesCalcModeX() == CartesianCoordinatePlane::Logarithmic) {
+        return QRectF();
+    }
+    // data value labels may be painted far away from their data point
+    if (hasCellAttributes(styleSnapshot.dataValueAttributes, firstColumn, lastColumn)
+        || hasCellAttributes(styleSnapshot.pen, firstColumn, lastColumn)) {
+        return QRectF();
+    }
+    qreal penWidth = 1.0;
+    for (int dataset = 0; dataset < datasetCount(); ++dataset) {
+        if (diagram->dataValueAttributes(dataset).isVisible()) {
+            return QRectF();
+        }
+        penWidth = qMax(penWidth, diagram->pen(dataset).widthF());
+    }
+
+    const qreal x1 = cartesianPlane->translate(QPointF(firstKey, 0)).x();
+    const qreal x2 = cartesianPlane->translate(QPointF(lastKey, 0)).x();
+    const qreal margin = 3 + 2 * penWidth;
+    const QRectF area = cartesianPlane->geometry();
+    return QRectF(qMin(x1, x2) - margin, area.top(), qAbs(x2 - x1) + 2 * margin, area.height())
+        .intersected(area);
+}
+
 bool AbstractCartesianDiagram::compare(const AbstractCartesianDiagram *other) const
 {
     if (other == this)
@@ -33,7 +68,7 @@ bool AbstractCartesianDiagram::compare(const AbstractCartesianDiagram *other) co
     return // compare the base class
         (static_cast<const AbstractDiagram *>(this)->compare(other)) &&
         // compare own properties
-        (referenceDiagram() == other->referenceDiagram()) && ((!referenceDiagram()) || (referenceDiagramOffset() == other->referenceDiagramOffset()));
+        (approximationMode() == other->approximationMode()) && (useDataPyramid() == other->useDataPyramid()) && (referenceDiagram() == other->referenceDiagram()) && ((!referenceDiagram()) || (referenceDiagramOffset() == other->referenceDiagramOffset()));
 }
 
 #define d d_func()
@@ -146,6 +181,67 @@ QPointF AbstractCartesianDiagram::referenceDiagramOffset() const
     return d->referenceDiagramOffset;
 }
 
+CartesianDiagramDataCompressor::ApproximationMode AbstractCartesianDiagram::Private::compressorMode() const
+{
+    switch (approximationMode) {
+    case MinMaxApproximation:
+        return CartesianDiagramDataCompressor::MinMax;
+    case SamplingApproximation:
+        return CartesianDiagramDataCompressor::SamplingSeven;
+    case AverageApproximation:
+        break;
+    }
+    return CartesianDiagramDataCompressor::Precise;
+}
+
+void AbstractCartesianDiagram::setApproximationMode(ApproximationMode mode)
+{
+    if (mode == d->approximationMode) {
+        return;
+    }
+    d->approximationMode = mode;
+    // Plotter's LTTB compression takes precedence, the mode applies once it is turned off
+    if (d->compressor.approximationMode() != CartesianDiagramDataCompressor::LargestTriangleThreeBuckets) {
+        d->compressor.setApproximationMode(d->compressorMode());
+        setDataBoundariesDirty();
+    }
+}
+
+AbstractCartesianDiagram::ApproximationMode AbstractCartesianDiagram::approximationMode() const
+{
+    return d->approximationMode;
+}
+
+void AbstractCartesianDiagram::setUseDataPyramid(bool usePyramid)
+{
+    d->compressor.setUsePyramid(usePyramid);
+}
+
+bool AbstractCartesianDiagram::useDataPyramid() const
+{
+    return d->compressor.usePyramid();
+}
+
+void AbstractCartesianDiagram::setDataSource(ColumnarDataSource *source)
+{
+    if (source == dataSource()) {
+        return;
+    }
+    if (!source) {
+        setModel(nullptr);
+        return;
+    }
+    auto *sourceModel = new ColumnarDataModel(source, datasetDimension(), this);
+    setModel(sourceModel);
+    d->dataSourceModel = sourceModel;
+    d->compressor.setColumnarModel(sourceModel);
+}
+
+ColumnarDataSource *AbstractCartesianDiagram::dataSource() const
+{
+    return d->dataSourceModel ? d->dataSourceModel->source() : nullptr;
+}
+
 void AbstractCartesianDiagram::setRootIndex(const QModelIndex &index)
 {
     d->compressor.setRootIndex(attributesModel()->mapFromSource(index));
@@ -157,7 +253,14 @@ void AbstractCartesianDiagram::setModel(QAbstractItemModel *m)
     if (m == model()) {
         return;
     }
+    // a model set by setDataSource() is replaced, either by a model or another source
+    ColumnarDataModel *oldSourceModel = d->dataSourceModel;
+    if (oldSourceModel) {
+        d->dataSourceModel = nullptr;
+        d->compressor.setColumnarModel(nullptr);
+    }
     AbstractDiagram::setModel(m);
+    delete oldSourceModel;
 }
 
 void AbstractCartesianDiagram::setAttributesModel(AttributesModel *model)
@@ -17,6 +17,7 @@
 
 namespace KDChart {
 
+class ColumnarDataSource;
 class GridAttributes;
 
 /**
@@ -33,6 +34,26 @@ class KDCHART_EXPORT AbstractCartesianDiagram : public AbstractDiagram
     KDCHART_DECLARE_DERIVED_DIAGRAM(AbstractCartesianDiagram, CartesianCoordinatePlane)
 
 public:
+    /**
+     * Describes how the data of a dataset is reduced when it has more rows
+     * than the diagram is wide in pixels.
+     *
+     * \li \c AverageApproximation averages all values that fall into one pixel column.
+     * \li \c MinMaxApproximation keeps the first, the minimum, the maximum and the last
+     *     value of every pixel column, so spikes and dropouts stay visible. Line
+     *     diagrams drawn this way look the same as without any data reduction.
+     * \li \c SamplingApproximation averages only a small, evenly spaced sample of
+     *     the values of every pixel column. This is the fastest mode for very large
+     *     models, at the expense of accuracy.
+     */
+    enum ApproximationMode
+    {
+        AverageApproximation,
+        MinMaxApproximation,
+        SamplingApproximation
+    };
+    Q_ENUM(ApproximationMode)
+
     explicit AbstractCartesianDiagram(QWidget *parent = nullptr, CartesianCoordinatePlane *plane = nullptr);
     ~AbstractCartesianDiagram() override;
 
@@ -99,6 +120,60 @@ public:
      */
     virtual QPointF referenceDiagramOffset() const;
 
+    /**
+     * Sets how the data is reduced when there are more rows than pixels.
+     * The default is AverageApproximation.
+     *
+     * Diagrams with a dataset dimension of 2, like Plotter, are never reduced
+     * this way, so the mode has no effect on them. A Plotter that uses
+     * Plotter::LTTB compression reduces its data with that instead, and the
+     * mode set here applies again once the compression is changed.
+     * \sa ApproximationMode, Plotter::setUseDataCompression
+     */
+    void setApproximationMode(ApproximationMode mode);
+    /**
+     * @return the data reduction mode of this diagram
+     * \sa setApproximationMode
+     */
+    ApproximationMode approximationMode() const;
+
+    /**
+     * Keeps a precomputed multi-resolution summary of the model data, so that
+     * changes of the resolution, e.g. by zooming, do not read the model again.
+     * This trades memory (about 16 bytes per value) for interactive zooming on
+     * very large models. It is used with AverageApproximation and MinMaxApproximation.
+     * The default is false.
+     */
+    void setUseDataPyramid(bool usePyramid);
+    /**
+     * @return whether a multi-resolution summary of the data is kept
+     * \sa setUseDataPyramid
+     */
+    bool useDataPyramid() const;
+
+    /**
+     * Displays the data of \a source instead of a model. The values are read
+     * directly from the arrays of the source, without going through
+     * QAbstractItemModel::data() and QVariant, which makes this the fastest
+     * way to chart very large sample buffers.
+     *
+     * Internally, the diagram creates a table model for the source, which
+     * becomes model(), so attributes can be set per index as usual. The
+     * layout of that model depends on the dataset dimension of the diagram
+     * at the time this is called: for a Plotter, each dataset has a key
+     * column followed by a value column.
+     *
+     * The diagram does not take ownership of \a source. Calling setModel()
+     * or passing null detaches the source.
+     * \sa ColumnarDataSource
+     */
+    void setDataSource(ColumnarDataSource *source);
+    /**
+     * @return the data source set with setDataSource(), or null if the
+     * diagram displays a model
+     */
+    ColumnarDataSource *dataSource() const;
+
     /* reimp */
     void setModel(QAbstractItemModel *model) override;
     /* reimp */
@@ -26,6 +26,7 @@
 
 #include <KDChartAbstractDiagram_p.h>
 #include <KDChartAbstractThreeDAttributes.h>
+#include <KDChartColumnarDataSource_p.h>
 #include <KDChartGridAttributes.h>
 
 #include <KDABLibFakes>
@@ -50,7 +51,10 @@ public:
         : AbstractDiagram::Private(rhs)
         , axesList() // Do not copy axes and reference diagrams.
         , referenceDiagramOffset()
+        , approximationMode(rhs.approximationMode)
     {
+        compressor.setApproximationMode(rhs.compressor.approximationMode());
+        compressor.setUsePyramid(rhs.compressor.usePyramid());
     }
 
     /** \reimp */
@@ -65,12 +69,41 @@ public:
         return allAttrs;
     }
 
+    // the compressor mode that implements approximationMode
+    CartesianDiagramDataCompressor::ApproximationMode compressorMode() const;
+
+    // True if any cell of the diagram may have its own attribute, as resolved for the
+    // last paint, or if the source model supplies it for the changed columns first to last.
+    template<typename T>
+    bool hasCellAttributes(const ResolvedAttribute<T> &attribute, int first, int last) const
+    {
+        if (!attribute.isUniform()) {
+            return true;
+        }
+        for (int column = first; column <= last; ++column) {
+            if (attributesModel->sourceSuppliesRole(column, attribute.role(), attributesModelRootIndex)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // The strip of the plane between the data keys firstKey and lastKey, over the whole
+    // height of the plane, or a null rect if the data of the columns firstColumn to
+    // lastColumn there may be painted elsewhere too.
+    QRectF keyStripRect(qreal firstKey, qreal lastKey, int firstColumn, int lastColumn) const;
+
     CartesianAxisList axesList;
 
     AbstractCartesianDiagram *referenceDiagram = nullptr;
     QPointF referenceDiagramOffset;
 
     mutable CartesianDiagramDataCompressor compressor;
+    // kept apart from the compressor, whose mode Plotter may override with LTTB
+    AbstractCartesianDiagram::ApproximationMode approximationMode = AbstractCartesianDiagram::AverageApproximation;
+
+    // the model created by setDataSource()
+    QPointer<ColumnarDataModel> dataSourceModel;
 };
 
 KDCHART_IMPL_DERIVED_DIAGRAM(AbstractCartesianDiagram, AbstractDiagram, CartesianCoordinatePlane)
@@ -228,10 +228,7 @@ BarAttributes BarDiagram::barAttributes(int column) const
  */
 BarAttributes BarDiagram::barAttributes(const QModelIndex &index) const
 {
-    return d->attributesModel->data(
-                                 d->attributesModel->mapFromSource(index),
-                                 KDChart::BarAttributesRole)
-        .value<BarAttributes>();
+    return d->attributesModel->attribute<BarAttributes>(d->attributesModel->mapFromSource(index), KDChart::BarAttributesRole);
 }
 
 /**
@@ -294,10 +291,7 @@ ThreeDBarAttributes BarDiagram::threeDBarAttributes(int column) const
  */
 ThreeDBarAttributes BarDiagram::threeDBarAttributes(const QModelIndex &index) const
 {
-    return d->attributesModel->data(
-                                 d->attributesModel->mapFromSource(index),
-                                 KDChart::ThreeDBarAttributesRole)
-        .value<ThreeDBarAttributes>();
+    return d->attributesModel->attribute<ThreeDBarAttributes>(d->attributesModel->mapFromSource(index), KDChart::ThreeDBarAttributesRole);
 }
 
 qreal BarDiagram::threeDItemDepth(const QModelIndex &index) const
@@ -363,6 +357,8 @@ void BarDiagram::paint(PaintContext *ctx)
     // ctx->painter()->setClipping( true );
     // ctx->painter()->setClipRect( ctx->rectangle() );
 
+    d->styleSnapshot.resolveBars(d->attributesModel, attributesModelRootIndex());
+
     // paint different bar types Normal - Stacked - Percent - Default Normal
     d->implementor->paint(ctx);
 
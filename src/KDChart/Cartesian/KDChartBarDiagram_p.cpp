@@ -21,16 +21,33 @@ BarDiagram::Private::Private(const Private &rhs)
 {
 }
 
+QRectF BarDiagram::Private::dataChangedRect(const QModelIndex &topLeft, const QModelIndex &bottomRight) const
+{
+    if (orientation != Qt::Vertical
+        || hasCellAttributes(styleSnapshot.threeDBarAttributes, topLeft.column(), bottomRight.column())) {
+        return QRectF();
+    }
+    const auto *barDiagram = static_cast<const BarDiagram *>(diagram);
+    for (int column = 0; column < datasetCount(); ++column) {
+        if (barDiagram->threeDBarAttributes(column).isEnabled()) {
+            return QRectF();
+        }
+    }
+    // the bars of a row fill the slot between its key and the next one
+    return keyStripRect(topLeft.row(), bottomRight.row() + 1, topLeft.column(), bottomRight.column());
+}
+
 void BarDiagram::BarDiagramType::paintBars(PaintContext *ctx, const QModelIndex &index, const QRectF &bar, qreal maxDepth)
 {
     PainterSaver painterSaver(ctx->painter());
 
     // Pending Michel: configure threeDBrush settings - shadowColor etc...
-    QBrush indexBrush(diagram()->brush(index));
-    QPen indexPen(diagram()->pen(index));
+    const StyleSnapshot &style = m_private->styleSnapshot;
+    QBrush indexBrush(style.brush.value(index));
+    const QPen indexPen(style.pen.value(index));
 
     ctx->painter()->setRenderHint(QPainter::Antialiasing, diagram()->antiAliasing());
-    ThreeDBarAttributes threeDAttrs = diagram()->threeDBarAttributes(index);
+    ThreeDBarAttributes threeDAttrs = style.threeDBarAttributes.value(index);
     if (threeDAttrs.isEnabled()) {
         indexBrush = threeDAttrs.threeDBrush(indexBrush, bar);
     }
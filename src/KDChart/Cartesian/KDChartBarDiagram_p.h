@@ -50,6 +50,8 @@ public:
 
     void setOrientationAndType(Qt::Orientation, BarDiagram::BarType);
 
+    QRectF dataChangedRect(const QModelIndex &topLeft, const QModelIndex &bottomRight) const override;
+
     Qt::Orientation orientation = Qt::Vertical;
 
     BarDiagramType *implementor = nullptr; // the current type
@@ -23,6 +23,7 @@
 #include "KDChartAbstractDiagram_p.h"
 #include "KDChartAbstractGrid.h"
 #include "KDChartBarDiagram.h"
+#include "KDChartCartesianCoordinatePlane_p.h"
 #include "KDChartChart.h"
 #include "KDChartLayoutItems.h"
 #include "KDChartLineDiagram.h"
@@ -48,19 +49,6 @@ static qreal slightlyLessThan(qreal r)
     return r - diff;
 }
 
-static int numSignificantDecimalPlaces(qreal floatNumber)
-{
-    static const int maxPlaces = 15;
-    QString sample = QString::number(floatNumber, 'f', maxPlaces).section(QLatin1Char('.'), 1, 2);
-    int ret = maxPlaces;
-    for (; ret > 0; ret--) {
-        if (sample[ret - 1] != QLatin1Char('0')) {
-            break;
-        }
-    }
-    return ret;
-}
-
 // Feature idea: In case of numeric labels, consider limiting the possible values of majorThinningFactor
 // to something like {1, 2, 5} * 10^n. Or even better, something that achieves round values in the
 // remaining labels.
@@ -192,7 +180,7 @@ void TickIterator::init(bool isY, bool hasMajorTicks, bool hasMinorTicks,
         const bool adjustUpper = gridAttributes.adjustUpperBoundToGrid() && !fixedRange;
         m_dimension = AbstractGrid::adjustedLowerUpperRange(m_dimension, adjustLower, adjustUpper);
 
-        m_decimalPlaces = numSignificantDecimalPlaces(m_dimension.stepWidth);
+        m_decimalPlaces = NumberFormatter::significantDecimalDigits(m_dimension.stepWidth);
     } else {
         // the number of significant decimal places for each label naturally varies with logarithmic scaling
         m_decimalPlaces = -1;
@@ -271,9 +259,9 @@ void TickIterator::computeMajorTickLabel(int decimalPlaces)
             } else {
                 // 'f' to avoid exponential notation for large numbers, consistent with data value text
                 if (decimalPlaces < 0) {
-                    decimalPlaces = numSignificantDecimalPlaces(m_position);
+                    decimalPlaces = NumberFormatter::significantDecimalDigits(m_position);
                 }
-                m_text = QString::number(m_position, 'f', decimalPlaces);
+                m_text = CartesianAxis::Private::get(m_axis)->numberFormatter.fixed(m_position, decimalPlaces);
                 m_type = MajorTick;
             }
         } else {
@@ -408,6 +396,11 @@ bool CartesianAxis::compare(const CartesianAxis *other) const
 
 void CartesianAxis::coordinateSystemChanged()
 {
+    // a pending data update of the plane lays out the planes itself if the data ranges changed
+    auto *plane = d->diagram() ? qobject_cast<CartesianCoordinatePlane *>(d->diagram()->coordinatePlane()) : nullptr;
+    if (plane && CartesianCoordinatePlane::Private::get(plane)->deferLayoutPlanes()) {
+        return;
+    }
     layoutPlanes();
 }
 
@@ -25,6 +25,7 @@
 #include "KDChartAbstractAxis_p.h"
 #include "KDChartAbstractCartesianDiagram.h"
 #include "KDChartCartesianAxis.h"
+#include "KDChartNumberFormatter_p.h"
 
 #include <KDABLibFakes>
 
@@ -85,6 +86,8 @@ private:
     mutable int cachedFontHeight;
     mutable int cachedFontWidth;
     mutable QSize cachedMaximumSize;
+    // formats the numeric tick labels, and remembers them across paints
+    mutable NumberFormatter numberFormatter;
     qreal axisTitleSpace;
 };
 
@@ -16,6 +16,7 @@
 #include "KDChartAbstractDiagram.h"
 #include "KDChartAbstractDiagram_p.h"
 #include "KDChartBarDiagram.h"
+#include "KDChartChart.h"
 #include "KDChartGridAttributes.h"
 #include "KDChartPaintContext.h"
 #include "KDChartPainterSaver_p.h"
@@ -39,6 +40,75 @@ CartesianCoordinatePlane::Private::Private()
 {
 }
 
+void CartesianCoordinatePlane::Private::diagramDataChanged(AbstractCoordinatePlane *plane)
+{
+    // The attributes model announces every change, while the diagram only maps changes of
+    // its source data to a rect through updateData(). Whatever is left needs a full update.
+    ++unmappedDataChanges;
+    updateData(plane, QRectF());
+}
+
+void CartesianCoordinatePlane::Private::updateData(AbstractCoordinatePlane *plane, const QRectF &rect)
+{
+    if (!rect.isNull()) {
+        --unmappedDataChanges;
+        dirtyDataRect |= rect;
+    }
+    if (!dataUpdateScheduled) {
+        dataUpdateScheduled = true;
+        auto *cartesianPlane = static_cast<CartesianCoordinatePlane *>(plane);
+        QMetaObject::invokeMethod(
+            cartesianPlane, [cartesianPlane]() {
+                get(cartesianPlane)->flushDataUpdate(cartesianPlane);
+            },
+            Qt::QueuedConnection);
+    }
+}
+
+bool CartesianCoordinatePlane::Private::deferLayoutPlanes()
+{
+    if (dataUpdateScheduled) {
+        layoutPlanesDeferred = true;
+    }
+    return dataUpdateScheduled;
+}
+
+void CartesianCoordinatePlane::Private::flushDataUpdate(AbstractCoordinatePlane *plane)
+{
+    if (!dataUpdateScheduled) {
+        // already flushed, e.g. before an off-thread rendering
+        return;
+    }
+    const QRect rect = dirtyDataRect.toAlignedRect();
+    const bool mapped = unmappedDataChanges <= 0 && !rect.isEmpty();
+    const bool layoutPlanes = layoutPlanesDeferred;
+    dirtyDataRect = QRectF();
+    unmappedDataChanges = 0;
+    dataUpdateScheduled = false;
+    layoutPlanesDeferred = false;
+
+    if (mapped) {
+        const DataDimensionsList oldDimensions = dimensions;
+        const QTransform oldTransform = coordinateTransformation.transform;
+        updateOnLayout = false;
+        plane->layoutDiagrams();
+        updateOnLayout = true;
+        if (dimensions == oldDimensions && coordinateTransformation.transform == oldTransform) {
+            if (parent) {
+                parent->update(rect);
+            } else {
+                plane->update();
+            }
+            return;
+        }
+    }
+    plane->update();
+    plane->relayout();
+    if (layoutPlanes) {
+        plane->layoutPlanes();
+    }
+}
+
 CartesianCoordinatePlane::CartesianCoordinatePlane(Chart *parent)
     : AbstractCoordinatePlane(new Private(), parent)
 {
@@ -90,10 +160,13 @@ void CartesianCoordinatePlane::paint(QPainter *painter)
         painter->setClipRegion(clipRegion);
 
         // paint the coordinate system rulers:
-        d->grid->drawGrid(&ctx);
+        if (d->paintLayers & Private::BackdropLayer) {
+            d->grid->drawGrid(&ctx);
+        }
 
         // paint the diagrams:
-        for (int i = 0; i < diags.size(); i++) {
+        const bool paintDiagrams = d->paintLayers & Private::ContentLayer;
+        for (int i = 0; paintDiagrams && i < diags.size(); i++) {
             if (diags[i]->isHidden()) {
                 continue;
             }
@@ -348,7 +421,9 @@ void CartesianCoordinatePlane::layoutDiagrams()
 
     d->coordinateTransformation.updateTransform(logArea, physicalArea);
 
-    update();
+    if (d->updateOnLayout) {
+        update();
+    }
 }
 
 void CartesianCoordinatePlane::setFixedDataCoordinateSpaceRelation(bool fixed)
@@ -697,6 +772,7 @@ void CartesianCoordinatePlane::resetGridAttributes(Qt::Orientation orientation)
 {
     setHasOwnGridAttributes(orientation, false);
     update();
+    Q_EMIT propertiesChanged();
 }
 
 const GridAttributes CartesianCoordinatePlane::gridAttributes(Qt::Orientation orientation) const
@@ -74,6 +74,11 @@ public:
         return geo.contains(p);
     }
 
+    void diagramDataChanged(AbstractCoordinatePlane *plane) override;
+    void updateData(AbstractCoordinatePlane *plane, const QRectF &rect) override;
+    // true if the axes can leave laying out the planes to the scheduled data update
+    bool deferLayoutPlanes();
+
     // the coordinate plane will calculate the coordinate transformation:
     CoordinateTransformation coordinateTransformation;
 
@@ -123,6 +128,19 @@ public:
 
     bool reverseVerticalPlane = false;
     bool reverseHorizontalPlane = false;
+
+    // Data changes are handled together on the next pass through the event loop. Changes
+    // that diagrams can map to dirtyDataRect only repaint that part, while the ranges last.
+    void flushDataUpdate(AbstractCoordinatePlane *plane) override;
+    bool hasPendingDataUpdate() const override
+    {
+        return dataUpdateScheduled;
+    }
+    QRectF dirtyDataRect;
+    int unmappedDataChanges = 0;
+    bool dataUpdateScheduled = false;
+    bool layoutPlanesDeferred = false;
+    bool updateOnLayout = true;
 };
 
 KDCHART_IMPL_DERIVED_PLANE(CartesianCoordinatePlane, AbstractCoordinatePlane)
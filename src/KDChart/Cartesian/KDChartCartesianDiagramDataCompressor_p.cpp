@@ -11,9 +11,15 @@
 #include "KDChartCartesianDiagramDataCompressor_p.h"
 
 #include <QAbstractItemModel>
+#include <QAbstractProxyModel>
 #include <QtDebug>
 
+#include <algorithm>
+
 #include "KDChartAbstractCartesianDiagram.h"
+#include "KDChartAttributesModel.h"
+#include "KDChartColumnarDataSource_p.h"
+#include "KDChartRingBufferModel.h"
 
 #include <KDABLibFakes>
 
@@ -23,6 +29,8 @@ using namespace std;
 CartesianDiagramDataCompressor::CartesianDiagramDataCompressor(QObject *parent)
     : QObject(parent)
 {
+    // the hidden flags are read together with the values
+    m_modelCache.setFlagRole(DataHiddenRole);
     calculateSampleStepWidth();
     m_data.resize(0);
 }
@@ -103,6 +111,10 @@ bool CartesianDiagramDataCompressor::prepareDataChange(const QModelIndex &parent
 
 void CartesianDiagramDataCompressor::slotRowsAboutToBeInserted(const QModelIndex &parent, int start, int end)
 {
+    if (cacheDependsOnRowCount()) {
+        // the cached points depend on the total row count, see slotRowsInserted()
+        return;
+    }
     if (!prepareDataChange(parent, true, &start, &end)) {
         return;
     }
@@ -110,16 +122,32 @@ void CartesianDiagramDataCompressor::slotRowsAboutToBeInserted(const QModelIndex
         Q_ASSERT(start >= 0 && start <= m_data[i].size());
         m_data[i].insert(start, end - start + 1, DataPoint());
     }
+    moveBoundaryRows(start, end - start + 1);
+    for (ColumnBoundaries &boundaries : m_boundaries) {
+        for (int j = start; j <= end && !boundaries.dirty; ++j) {
+            boundaries.pendingRows.append(j);
+        }
+    }
 }
 
 void CartesianDiagramDataCompressor::slotRowsInserted(const QModelIndex &parent, int start, int end)
 {
+    if (parent == m_rootIndex) {
+        m_pyramid.clear();
+    }
+    if (cacheDependsOnRowCount()) {
+        if (parent == m_rootIndex) {
+            rebuildCache();
+        }
+        return;
+    }
     if (!prepareDataChange(parent, true, &start, &end)) {
         return;
     }
+    // the following positions now map to other rows, they are retrieved again when needed
     for (int i = 0; i < m_data.size(); ++i) {
         for (int j = start; j < m_data[i].size(); ++j) {
-            retrieveModelData(CachePosition(j, i));
+            invalidate(CachePosition(j, i));
         }
     }
 }
@@ -129,13 +157,16 @@ void CartesianDiagramDataCompressor::slotColumnsAboutToBeInserted(const QModelIn
     if (!prepareDataChange(parent, false, &start, &end)) {
         return;
     }
-    const int rowCount = qMin(m_model ? m_model->rowCount(m_rootIndex) : 0, m_xResolution);
     Q_ASSERT(start >= 0 && start <= m_data.size());
-    m_data.insert(start, end - start + 1, QVector<DataPoint>(rowCount));
+    m_data.insert(start, end - start + 1, QVector<DataPoint>(cacheRowCount()));
+    resetBoundaries();
 }
 
 void CartesianDiagramDataCompressor::slotColumnsInserted(const QModelIndex &parent, int start, int end)
 {
+    if (parent == m_rootIndex) {
+        m_pyramid.clear();
+    }
     if (!prepareDataChange(parent, false, &start, &end)) {
         return;
     }
@@ -148,12 +179,19 @@ void CartesianDiagramDataCompressor::slotColumnsInserted(const QModelIndex &pare
 
 void CartesianDiagramDataCompressor::slotRowsAboutToBeRemoved(const QModelIndex &parent, int start, int end)
 {
+    if (cacheDependsOnRowCount()) {
+        return;
+    }
     if (!prepareDataChange(parent, true, &start, &end)) {
         return;
     }
     for (int i = 0; i < m_data.size(); ++i) {
+        for (int j = start; j <= end; ++j) {
+            forgetPoint(i, j);
+        }
         m_data[i].remove(start, end - start + 1);
     }
+    moveBoundaryRows(end + 1, start - end - 1);
 }
 
 void CartesianDiagramDataCompressor::slotRowsRemoved(const QModelIndex &parent, int start, int end)
@@ -163,6 +201,13 @@ void CartesianDiagramDataCompressor::slotRowsRemoved(const QModelIndex &parent,
     Q_ASSERT(start <= end);
     Q_UNUSED(end)
 
+    m_pyramid.clear();
+
+    if (cacheDependsOnRowCount()) {
+        rebuildCache();
+        return;
+    }
+
     CachePosition startPos = mapToCache(start, 0);
     static const CachePosition nullPosition;
     if (startPos == nullPosition) {
@@ -171,9 +216,10 @@ void CartesianDiagramDataCompressor::slotRowsRemoved(const QModelIndex &parent,
         return;
     }
 
+    // the following positions now map to other rows, they are retrieved again when needed
     for (int i = 0; i < m_data.size(); ++i) {
         for (int j = startPos.row; j < m_data[i].size(); ++j) {
-            retrieveModelData(CachePosition(j, i));
+            invalidate(CachePosition(j, i));
         }
     }
 }
@@ -184,6 +230,7 @@ void CartesianDiagramDataCompressor::slotColumnsAboutToBeRemoved(const QModelInd
         return;
     }
     m_data.remove(start, end - start + 1);
+    resetBoundaries();
 }
 
 void CartesianDiagramDataCompressor::slotColumnsRemoved(const QModelIndex &parent, int start, int end)
@@ -193,6 +240,8 @@ void CartesianDiagramDataCompressor::slotColumnsRemoved(const QModelIndex &paren
     Q_ASSERT(start <= end);
     Q_UNUSED(end);
 
+    m_pyramid.clear();
+
     const CachePosition startPos = mapToCache(0, start);
 
     static const CachePosition nullPosition;
@@ -229,6 +278,16 @@ void CartesianDiagramDataCompressor::slotModelDataChanged(
 {
     if (topLeftIndex.parent() != m_rootIndex)
         return;
+    if (m_rowsShiftPending) {
+        m_rowsShiftPending = false;
+        // this only announces the rows that slotRowsShifted() has already dealt with
+        if (topLeftIndex.row() == 0 && topLeftIndex.column() == 0
+            && bottomRightIndex.row() == m_model->rowCount(m_rootIndex) - 1
+            && bottomRightIndex.column() == m_model->columnCount(m_rootIndex) - 1)
+            return;
+    }
+    // header data changes of the AttributesModel are announced this way, too
+    m_columnHidden.clear();
     Q_ASSERT(topLeftIndex.isValid());
     Q_ASSERT(bottomRightIndex.isValid());
     Q_ASSERT(topLeftIndex.parent() == bottomRightIndex.parent());
@@ -239,14 +298,95 @@ void CartesianDiagramDataCompressor::slotModelDataChanged(
     for (int row = topleft.row; row <= bottomright.row; ++row)
         for (int column = topleft.column; column <= bottomright.column; ++column)
             invalidate(CachePosition(row, column));
+
+    if (!m_pyramid.isEmpty()) {
+        // the pyramid is only built for one-dimensional datasets, so its columns are model columns
+        const int lastColumn = qMin(bottomRightIndex.column(), m_pyramid.columnCount() - 1);
+        for (int column = topLeftIndex.column(); column <= lastColumn; ++column) {
+            prefetch(column, topLeftIndex.row(), bottomRightIndex.row() + 1);
+            for (int row = topLeftIndex.row(); row <= bottomRightIndex.row(); ++row) {
+                const QModelIndex index = m_model->index(row, column, m_rootIndex); // checked
+                m_pyramid.setValue(column, row, modelValue(index), modelHidden(index));
+            }
+            m_pyramid.update(column, topLeftIndex.row(), bottomRightIndex.row());
+        }
+    }
 }
 
 void CartesianDiagramDataCompressor::slotModelLayoutChanged()
 {
+    m_pyramid.clear();
     rebuildCache();
     calculateSampleStepWidth();
 }
 
+void CartesianDiagramDataCompressor::slotModelReset()
+{
+    m_pyramid.clear();
+    rebuildCache();
+}
+
+void CartesianDiagramDataCompressor::slotAttributesChanged(const QModelIndex &topLeftIndex,
+                                                           const QModelIndex &bottomRightIndex)
+{
+    // cached points of the range may include or skip rows that are now hidden or shown
+    if (topLeftIndex.isValid() && bottomRightIndex.isValid()) {
+        slotModelDataChanged(topLeftIndex, bottomRightIndex);
+    } else {
+        m_columnHidden.clear();
+    }
+}
+
+void CartesianDiagramDataCompressor::slotRowsShifted(int count)
+{
+    if (!m_model || m_rootIndex.isValid() || count <= 0) {
+        return;
+    }
+    m_modelCache.rowsShifted(count);
+    m_pyramid.clear();
+    m_dataValueAttributesCache.clear();
+    m_rowsShiftPending = true;
+    if (m_data.isEmpty() || m_data.first().isEmpty()) {
+        return;
+    }
+
+    // Cache rows can only slide if the model rows they cover slide by a whole number
+    // of cache rows. LargestTriangleThreeBuckets selections depend on all rows.
+    const int modelRows = m_model->rowCount(m_rootIndex);
+    const int pointsPerBucket = isMinMaxBucketed() ? MinMaxPointsPerPixel : 1;
+    const qint64 buckets = m_data.first().size() / pointsPerBucket;
+    if (isLttbReduced() || count >= modelRows || (count * buckets) % modelRows != 0) {
+        clearCache();
+        return;
+    }
+    const int shiftedPoints = int(count * buckets / modelRows) * pointsPerBucket;
+    for (int column = 0; column < m_data.size(); ++column) {
+        for (int row = 0; row < shiftedPoints; ++row) {
+            forgetPoint(column, row);
+        }
+    }
+    moveBoundaryRows(shiftedPoints, -shiftedPoints);
+    for (int column = 0; column < m_data.size(); ++column) {
+        DataPointVector &data = m_data[column];
+        ColumnBoundaries &boundaries = m_boundaries[column];
+        for (int row = data.size() - shiftedPoints; row < data.size() && !boundaries.dirty; ++row) {
+            boundaries.pendingRows.append(row);
+        }
+        data.remove(0, shiftedPoints);
+        for (DataPoint &point : data) {
+            if (!point.index.isValid()) {
+                continue;
+            }
+            point.index = point.index.sibling(point.index.row() - count, point.index.column());
+            // with two dimensions, the key is a model value
+            if (m_datasetDimension != 2) {
+                point.key -= count;
+            }
+        }
+        data.insert(data.size(), shiftedPoints, DataPoint());
+    }
+}
+
 void CartesianDiagramDataCompressor::slotDiagramLayoutChanged(AbstractDiagram *diagramBase)
 {
     auto *diagram = qobject_cast<AbstractCartesianDiagram *>(diagramBase);
@@ -310,11 +450,24 @@ void CartesianDiagramDataCompressor::setModel(QAbstractItemModel *model)
         disconnect(m_model, &QAbstractItemModel::columnsAboutToBeRemoved,
                    this, &CartesianDiagramDataCompressor::slotColumnsAboutToBeRemoved);
         disconnect(m_model, &QAbstractItemModel::modelReset,
-                   this, &CartesianDiagramDataCompressor::rebuildCache);
+                   this, &CartesianDiagramDataCompressor::slotModelReset);
+        if (m_ringBufferModel) {
+            disconnect(m_ringBufferModel, &RingBufferModel::rowsShifted,
+                       this, &CartesianDiagramDataCompressor::slotRowsShifted);
+            m_ringBufferModel = nullptr;
+        }
+        if (m_attributesModel) {
+            disconnect(m_attributesModel, &AttributesModel::attributesChanged,
+                       this, &CartesianDiagramDataCompressor::slotAttributesChanged);
+            m_attributesModel = nullptr;
+        }
         m_model = nullptr;
     }
+    m_rowsShiftPending = false;
 
-    m_modelCache.setModel(model);
+    // values of a columnar model are read from its spans, caching them is pointless
+    m_modelCache.setModel(m_columnarModel ? nullptr : model);
+    m_pyramid.clear();
 
     if (model != nullptr) {
         m_model = model;
@@ -341,7 +494,22 @@ void CartesianDiagramDataCompressor::setModel(QAbstractItemModel *model)
         connect(m_model, &QAbstractItemModel::columnsAboutToBeRemoved,
                 this, &CartesianDiagramDataCompressor::slotColumnsAboutToBeRemoved);
         connect(m_model, &QAbstractItemModel::modelReset,
-                this, &CartesianDiagramDataCompressor::rebuildCache);
+                this, &CartesianDiagramDataCompressor::slotModelReset);
+
+        // diagrams see their model through the AttributesModel
+        m_ringBufferModel = qobject_cast<RingBufferModel *>(m_model);
+        if (auto *proxy = qobject_cast<QAbstractProxyModel *>(m_model)) {
+            m_ringBufferModel = qobject_cast<RingBufferModel *>(proxy->sourceModel());
+        }
+        if (m_ringBufferModel) {
+            connect(m_ringBufferModel, &RingBufferModel::rowsShifted,
+                    this, &CartesianDiagramDataCompressor::slotRowsShifted);
+        }
+        m_attributesModel = qobject_cast<AttributesModel *>(m_model);
+        if (m_attributesModel) {
+            connect(m_attributesModel, &AttributesModel::attributesChanged,
+                    this, &CartesianDiagramDataCompressor::slotAttributesChanged);
+        }
     }
     rebuildCache();
     calculateSampleStepWidth();
@@ -352,12 +520,42 @@ void CartesianDiagramDataCompressor::setRootIndex(const QModelIndex &root)
     if (m_rootIndex != root) {
         Q_ASSERT(root.model() == m_model || !root.isValid());
         m_rootIndex = root;
-        m_modelCache.setRootIndex(root);
+        if (!m_columnarModel)
+            m_modelCache.setRootIndex(root);
+        m_pyramid.clear();
         rebuildCache();
         calculateSampleStepWidth();
     }
 }
 
+void CartesianDiagramDataCompressor::setColumnarModel(ColumnarDataModel *model)
+{
+    if (model == m_columnarModel) {
+        return;
+    }
+    m_columnarModel = model;
+    m_modelCache.setModel(m_columnarModel ? nullptr : m_model.data());
+    if (!m_columnarModel)
+        m_modelCache.setRootIndex(m_rootIndex);
+    m_pyramid.clear();
+    rebuildCache();
+    calculateSampleStepWidth();
+}
+
+void CartesianDiagramDataCompressor::setApproximationMode(ApproximationMode mode)
+{
+    if (mode != m_mode) {
+        m_mode = mode;
+        rebuildCache();
+        calculateSampleStepWidth();
+    }
+}
+
+CartesianDiagramDataCompressor::ApproximationMode CartesianDiagramDataCompressor::approximationMode() const
+{
+    return m_mode;
+}
+
 void CartesianDiagramDataCompressor::recalcResolution()
 {
     setResolution(m_xResolution, m_yResolution);
@@ -376,7 +574,7 @@ bool CartesianDiagramDataCompressor::setResolutionInternal(int x, int y)
     const int oldXRes = m_xResolution;
     const int oldYRes = m_yResolution;
 
-    if (m_datasetDimension != 1) {
+    if (m_datasetDimension != 1 && m_mode != LargestTriangleThreeBuckets) {
         // just ignore the X resolution in that case
         m_xResolution = m_model ? m_model->rowCount(m_rootIndex) : 0;
     } else {
@@ -391,6 +589,19 @@ void CartesianDiagramDataCompressor::clearCache()
 {
     for (int column = 0; column < m_data.size(); ++column)
         m_data[column].fill(DataPoint());
+    resetBoundaries();
+}
+
+int CartesianDiagramDataCompressor::cacheRowCount() const
+{
+    // MinMax and LargestTriangleThreeBuckets keep several datapoints per pixel column
+    int pointsPerPixel = 1;
+    if (m_mode == MinMax) {
+        pointsPerPixel = MinMaxPointsPerPixel;
+    } else if (m_mode == LargestTriangleThreeBuckets) {
+        pointsPerPixel = LttbPointsPerPixel;
+    }
+    return qMin(m_model ? m_model->rowCount(m_rootIndex) : 0, m_xResolution * pointsPerPixel);
 }
 
 void CartesianDiagramDataCompressor::rebuildCache()
@@ -398,16 +609,20 @@ void CartesianDiagramDataCompressor::rebuildCache()
     Q_ASSERT(m_datasetDimension != 0);
 
     m_data.clear();
+    m_columnHidden.clear();
     setResolutionInternal(m_xResolution, m_yResolution);
     const int columnDivisor = m_datasetDimension == 2 ? 2 : 1;
     const int columnCount = m_model ? m_model->columnCount(m_rootIndex) / columnDivisor : 0;
-    const int rowCount = qMin(m_model ? m_model->rowCount(m_rootIndex) : 0, m_xResolution);
+    const int rowCount = cacheRowCount();
     m_data.resize(columnCount);
     for (int i = 0; i < columnCount; ++i) {
         m_data[i].resize(rowCount);
     }
+    resetBoundaries();
     // also empty the attrs cache
     m_dataValueAttributesCache.clear();
+    // the sample step depends on the number of indexes per pixel
+    calculateSampleStepWidth();
 }
 
 const CartesianDiagramDataCompressor::DataPoint &CartesianDiagramDataCompressor::data(const CachePosition &position) const
@@ -430,11 +645,24 @@ QPair<QPointF, QPointF> CartesianDiagramDataCompressor::dataBoundaries() const
     qreal yMin = std::numeric_limits<qreal>::quiet_NaN();
     qreal yMax = std::numeric_limits<qreal>::quiet_NaN();
 
+    Q_ASSERT(m_boundaries.size() == colCount);
     for (int column = 0; column < colCount; ++column) {
+        ColumnBoundaries &boundaries = m_boundaries[column];
         const DataPointVector &data = m_data[column];
-        int row = 0;
-        for (DataPointVector::const_iterator it = data.begin(); it != data.end(); ++it, ++row) {
-            const DataPoint &p = *it;
+        if (boundaries.dirty) {
+            boundaries = ColumnBoundaries();
+            boundaries.dirty = false;
+            for (int row = 0; row < data.size(); ++row) {
+                boundaries.pendingRows.append(row);
+            }
+        }
+
+        // changed points can only extend the boundaries, everything else has made them dirty
+        for (int row : std::as_const(boundaries.pendingRows)) {
+            if (row >= data.size()) {
+                continue;
+            }
+            const DataPoint &p = data[row];
             if (!p.index.isValid())
                 retrieveModelData(CachePosition(row, column));
 
@@ -442,18 +670,52 @@ QPair<QPointF, QPointF> CartesianDiagramDataCompressor::dataBoundaries() const
                 continue;
             }
 
-            if (ISNAN(xMin)) {
-                xMin = p.key;
-                xMax = p.key;
-                yMin = p.value;
-                yMax = p.value;
+            if (ISNAN(boundaries.xMin)) {
+                boundaries.xMin = p.key;
+                boundaries.xMax = p.key;
+                boundaries.yMin = p.value;
+                boundaries.yMax = p.value;
             } else {
-                xMin = qMin(xMin, p.key);
-                xMax = qMax(xMax, p.key);
-                yMin = qMin(yMin, p.value);
-                yMax = qMax(yMax, p.value);
+                boundaries.xMin = qMin(boundaries.xMin, p.key);
+                boundaries.xMax = qMax(boundaries.xMax, p.key);
+                boundaries.yMin = qMin(boundaries.yMin, p.value);
+                boundaries.yMax = qMax(boundaries.yMax, p.value);
             }
         }
+        boundaries.pendingRows.clear();
+
+        if (m_datasetDimension != 2) {
+            // keys are ascending row numbers, so the outermost valid points define the key range
+            boundaries.xMin = std::numeric_limits<qreal>::quiet_NaN();
+            boundaries.xMax = std::numeric_limits<qreal>::quiet_NaN();
+            for (int row = 0; row < data.size() && ISNAN(boundaries.xMin); ++row) {
+                if (!data[row].index.isValid())
+                    retrieveModelData(CachePosition(row, column));
+                if (!ISNAN(data[row].value))
+                    boundaries.xMin = data[row].key;
+            }
+            for (int row = data.size() - 1; row >= 0 && ISNAN(boundaries.xMax); --row) {
+                if (!data[row].index.isValid())
+                    retrieveModelData(CachePosition(row, column));
+                if (!ISNAN(data[row].value))
+                    boundaries.xMax = data[row].key;
+            }
+        }
+
+        if (ISNAN(boundaries.xMin)) {
+            continue;
+        }
+        if (ISNAN(xMin)) {
+            xMin = boundaries.xMin;
+            xMax = boundaries.xMax;
+            yMin = boundaries.yMin;
+            yMax = boundaries.yMax;
+        } else {
+            xMin = qMin(xMin, boundaries.xMin);
+            xMax = qMax(xMax, boundaries.xMax);
+            yMin = qMin(yMin, boundaries.yMin);
+            yMax = qMax(yMax, boundaries.yMax);
+        }
     }
 
     const QPointF bottomLeft(xMin, yMin);
@@ -461,30 +723,144 @@ QPair<QPointF, QPointF> CartesianDiagramDataCompressor::dataBoundaries() const
     return qMakePair(bottomLeft, topRight);
 }
 
+void CartesianDiagramDataCompressor::forgetPoint(int column, int row) const
+{
+    if (column >= m_boundaries.size()) {
+        return;
+    }
+    ColumnBoundaries &boundaries = m_boundaries[column];
+    if (boundaries.dirty) {
+        return;
+    }
+    const DataPoint &p = m_data[column][row];
+    // with one dimension, dataBoundaries() derives the key range from the outermost points
+    const bool isKeyExtreme = m_datasetDimension == 2 && (p.key == boundaries.xMin || p.key == boundaries.xMax);
+    if (p.index.isValid() && !ISNAN(p.key) && !ISNAN(p.value)
+        && (isKeyExtreme || p.value == boundaries.yMin || p.value == boundaries.yMax)) {
+        // the boundaries may shrink, which can only be found out by a rescan
+        boundaries.dirty = true;
+        boundaries.pendingRows.clear();
+    } else if (boundaries.pendingRows.size() >= m_data[column].size()) {
+        // cheaper to rescan than to keep track of that many rows
+        boundaries.dirty = true;
+        boundaries.pendingRows.clear();
+    } else {
+        boundaries.pendingRows.append(row);
+    }
+}
+
+void CartesianDiagramDataCompressor::moveBoundaryRows(int start, int delta)
+{
+    for (ColumnBoundaries &boundaries : m_boundaries) {
+        QVector<int> &rows = boundaries.pendingRows;
+        for (int i = rows.size() - 1; i >= 0; --i) {
+            if (rows[i] >= start) {
+                rows[i] += delta;
+            } else if (delta < 0 && rows[i] >= start + delta) {
+                // the row was removed
+                rows.remove(i);
+            }
+        }
+    }
+}
+
+void CartesianDiagramDataCompressor::resetBoundaries() const
+{
+    m_boundaries.fill(ColumnBoundaries(), m_data.size());
+}
+
+qreal CartesianDiagramDataCompressor::modelValue(const QModelIndex &index) const
+{
+    if (m_columnarModel) {
+        if (!index.isValid() || index.row() >= m_columnarModel->sampleCount() || index.column() >= m_columnarModel->spanCount())
+            return std::numeric_limits<qreal>::quiet_NaN();
+        return m_columnarModel->value(index.row(), index.column());
+    }
+    return m_modelCache.data(index);
+}
+
+bool CartesianDiagramDataCompressor::modelHidden(const QModelIndex &index) const
+{
+    if (m_columnarModel) {
+        if (!m_attributesModel || m_attributesModel->hasCellAttributes(DataHiddenRole)) {
+            return m_model->data(index, DataHiddenRole).value<bool>();
+        }
+        // the columnar model supplies no attributes, so without hidden cells
+        // all cells of a dataset are hidden or shown alike
+        const int column = index.column();
+        if (column >= m_columnHidden.size()) {
+            m_columnHidden.insert(m_columnHidden.size(), column + 1 - m_columnHidden.size(), qint8(-1));
+        }
+        if (m_columnHidden[column] < 0) {
+            m_columnHidden[column] = m_model->data(index, DataHiddenRole).value<bool>() ? 1 : 0;
+        }
+        return m_columnHidden[column] == 1;
+    }
+    return m_modelCache.flag(index);
+}
+
+void CartesianDiagramDataCompressor::prefetch(int column, int firstRow, int endRow) const
+{
+    // the columnar model needs no caching
+    if (!m_columnarModel) {
+        m_modelCache.prefetch(column, firstRow, endRow);
+    }
+}
+
 void CartesianDiagramDataCompressor::retrieveModelData(const CachePosition &position) const
 {
     Q_ASSERT(mapsToModelIndex(position));
+    const bool usePyramid = isPyramidUsable();
+    if (usePyramid && m_pyramid.isEmpty()) {
+        buildPyramid();
+    }
+    if (isMinMaxBucketed()) {
+        retrieveMinMaxBucket(position);
+        return;
+    }
+    if (usePyramid) {
+        retrievePyramidData(position);
+        return;
+    }
+    if (isLttbReduced()) {
+        retrieveLttbColumn(position.column);
+        return;
+    }
+
     DataPoint result;
     result.hidden = true;
 
     switch (m_mode) {
-    case Precise: {
+    case SamplingSeven:
+        if (m_sampleStep > 1 && m_datasetDimension != 2) {
+            result = sampleModelData(position);
+            break;
+        }
+        // too few rows per pixel to make sampling worthwhile
+        Q_FALLTHROUGH();
+    // without reduction, MinMax and LargestTriangleThreeBuckets have exactly one
+    // row per cache row
+    case Precise:
+    case MinMax:
+    case LargestTriangleThreeBuckets: {
         const QModelIndexList indexes = mapToModel(position);
 
         if (m_datasetDimension == 2) {
             Q_ASSERT(indexes.count() == 2);
             const QModelIndex &xIndex = indexes.at(0);
             result.index = xIndex;
-            result.key = m_modelCache.data(xIndex);
-            result.value = m_modelCache.data(indexes.at(1));
+            result.key = modelValue(xIndex);
+            result.value = modelValue(indexes.at(1));
         } else {
             if (indexes.isEmpty()) {
                 break;
             }
             result.value = std::numeric_limits<qreal>::quiet_NaN();
             result.key = 0.0;
+            // the indexes are consecutive rows of one column
+            prefetch(indexes.first().column(), indexes.first().row(), indexes.last().row() + 1);
             for (const QModelIndex &index : indexes) {
-                const qreal value = m_modelCache.data(index);
+                const qreal value = modelValue(index);
                 if (!ISNAN(value)) {
                     result.value = ISNAN(result.value) ? value : result.value + value;
                 }
@@ -497,20 +873,268 @@ void CartesianDiagramDataCompressor::retrieveModelData(const CachePosition &posi
 
         for (const QModelIndex &index : indexes) {
             // the DataPoint point is visible if any of the underlying, aggregated points is visible
-            if (m_model->data(index, DataHiddenRole).value<bool>() == false) {
+            if (!modelHidden(index)) {
                 result.hidden = false;
             }
         }
         break;
     }
-    case SamplingSeven:
-        break;
     }
 
     m_data[position.column][position.row] = result;
     Q_ASSERT(isCached(position));
 }
 
+CartesianDiagramDataCompressor::DataPoint CartesianDiagramDataCompressor::sampleModelData(const CachePosition &position) const
+{
+    Q_ASSERT(m_mode == SamplingSeven && m_sampleStep > 1);
+    DataPoint result;
+    result.hidden = true;
+
+    // same row range as mapToModel(), but only every m_sampleStep'th row is read
+    const qreal ipp = indexesPerPixel();
+    const int baseRow = floor(position.row * ipp);
+    const int endRow = qMin(int(floor((position.row + 1) * ipp)), m_model->rowCount(m_rootIndex));
+    if (endRow <= baseRow) {
+        return result;
+    }
+    const int step = int(m_sampleStep);
+    // center the samples inside the row range
+    const int firstRow = baseRow + ((endRow - baseRow - 1) % step) / 2;
+
+    qreal keySum = 0.0;
+    qreal valueSum = 0.0;
+    int sampleCount = 0;
+    int valueCount = 0;
+    for (int row = firstRow; row < endRow; row += step) {
+        const QModelIndex index = m_model->index(row, position.column, m_rootIndex); // checked
+        if (!result.index.isValid()) {
+            result.index = index;
+        }
+        const qreal value = modelValue(index);
+        if (!ISNAN(value)) {
+            valueSum += value;
+            ++valueCount;
+        }
+        keySum += row;
+        ++sampleCount;
+        // the DataPoint is visible if any of the sampled points is visible
+        if (!modelHidden(index)) {
+            result.hidden = false;
+        }
+    }
+    result.key = keySum / sampleCount;
+    result.value = valueCount > 0 ? valueSum / valueCount : std::numeric_limits<qreal>::quiet_NaN();
+    return result;
+}
+
+bool CartesianDiagramDataCompressor::cacheDependsOnRowCount() const
+{
+    return m_mode == MinMax || m_mode == LargestTriangleThreeBuckets;
+}
+
+bool CartesianDiagramDataCompressor::isLttbReduced() const
+{
+    return m_mode == LargestTriangleThreeBuckets && m_model && !m_data.isEmpty() && !m_data[0].isEmpty()
+        && m_data[0].size() < m_model->rowCount(m_rootIndex);
+}
+
+void CartesianDiagramDataCompressor::retrieveLttbColumn(int column) const
+{
+    Q_ASSERT(isLttbReduced());
+    DataPointVector &data = m_data[column];
+    const int modelRowCount = m_model->rowCount(m_rootIndex);
+    const int keyColumn = m_datasetDimension == 2 ? column * 2 : column;
+    const int valueColumn = m_datasetDimension == 2 ? column * 2 + 1 : column;
+
+    // collect the visible points, missing values are bridged
+    QVector<int> rows;
+    QVector<qreal> keys;
+    QVector<qreal> values;
+    rows.reserve(modelRowCount);
+    keys.reserve(modelRowCount);
+    values.reserve(modelRowCount);
+    prefetch(valueColumn, 0, modelRowCount);
+    if (m_datasetDimension == 2) {
+        prefetch(keyColumn, 0, modelRowCount);
+    }
+    for (int row = 0; row < modelRowCount; ++row) {
+        const QModelIndex valueIndex = m_model->index(row, valueColumn, m_rootIndex); // checked
+        if (modelHidden(valueIndex)) {
+            continue;
+        }
+        const qreal key = m_datasetDimension == 2 ? modelValue(m_model->index(row, keyColumn, m_rootIndex)) // checked
+                                                  : row;
+        const qreal value = modelValue(valueIndex);
+        if (ISNAN(key) || ISNAN(value)) {
+            continue;
+        }
+        rows.append(row);
+        keys.append(key);
+        values.append(value);
+    }
+
+    // select the points: always keep the first and the last point, and from every bucket in
+    // between the one forming the largest triangle with the previously selected point and
+    // the average of the next bucket
+    const int pointCount = rows.size();
+    const int threshold = data.size();
+    QVector<int> selected;
+    selected.reserve(threshold);
+    if (pointCount <= threshold || threshold < 3) {
+        for (int i = 0; i < qMin(pointCount, threshold); ++i) {
+            selected.append(i);
+        }
+    } else {
+        const qreal bucketSize = qreal(pointCount - 2) / (threshold - 2);
+        int previous = 0;
+        selected.append(previous);
+        for (int bucket = 0; bucket < threshold - 2; ++bucket) {
+            const int bucketStart = int(bucket * bucketSize) + 1;
+            const int bucketEnd = int((bucket + 1) * bucketSize) + 1;
+            const int nextStart = bucketEnd;
+            const int nextEnd = qMin(int((bucket + 2) * bucketSize) + 1, pointCount);
+
+            qreal averageKey = 0.0;
+            qreal averageValue = 0.0;
+            for (int i = nextStart; i < nextEnd; ++i) {
+                averageKey += keys[i];
+                averageValue += values[i];
+            }
+            const int nextCount = nextEnd - nextStart;
+            averageKey /= nextCount;
+            averageValue /= nextCount;
+
+            qreal maxArea = -1.0;
+            int maxIndex = bucketStart;
+            for (int i = bucketStart; i < bucketEnd; ++i) {
+                // twice the triangle area, which is good enough for comparisons
+                const qreal area = qAbs((keys[previous] - averageKey) * (values[i] - values[previous])
+                                        - (keys[previous] - keys[i]) * (averageValue - values[previous]));
+                if (area > maxArea) {
+                    maxArea = area;
+                    maxIndex = i;
+                }
+            }
+            selected.append(maxIndex);
+            previous = maxIndex;
+        }
+        selected.append(pointCount - 1);
+    }
+
+    for (int i = 0; i < threshold; ++i) {
+        DataPoint point;
+        if (i < selected.size()) {
+            const int row = rows[selected[i]];
+            // like in Precise mode, the index of a two-dimensional dataset is the key index
+            point.index = m_model->index(row, keyColumn, m_rootIndex); // checked
+            point.key = keys[selected[i]];
+            point.value = values[selected[i]];
+        } else {
+            // fewer visible points than cache rows, hide the rest
+            point.index = m_model->index(modelRowCount - 1, keyColumn, m_rootIndex); // checked
+            point.hidden = true;
+        }
+        data[i] = point;
+    }
+}
+
+bool CartesianDiagramDataCompressor::isMinMaxBucketed() const
+{
+    return m_mode == MinMax && m_model && !m_data.isEmpty() && !m_data[0].isEmpty()
+        && m_data[0].size() < m_model->rowCount(m_rootIndex);
+}
+
+QPair<int, int> CartesianDiagramDataCompressor::minMaxBucketRows(int bucket) const
+{
+    // bucket b holds all rows r with floor(r * buckets / rowCount) == b, which makes
+    // the mapping consistent with mapToCache()
+    const qint64 buckets = m_data[0].size() / MinMaxPointsPerPixel;
+    const qint64 rowCount = m_model->rowCount(m_rootIndex);
+    const int first = int((bucket * rowCount + buckets - 1) / buckets);
+    const int last = int(((bucket + 1) * rowCount + buckets - 1) / buckets);
+    return qMakePair(first, last);
+}
+
+void CartesianDiagramDataCompressor::retrieveMinMaxBucket(const CachePosition &position) const
+{
+    Q_ASSERT(isMinMaxBucketed());
+    const int firstSlot = position.row - position.row % MinMaxPointsPerPixel;
+    const QPair<int, int> rows = minMaxBucketRows(firstSlot / MinMaxPointsPerPixel);
+    Q_ASSERT(rows.second - rows.first >= MinMaxPointsPerPixel);
+
+    // find the first, last, minimum and maximum visible rows of the bucket
+    int firstRow = -1;
+    int lastRow = -1;
+    int minRow = -1;
+    int maxRow = -1;
+    qreal minValue = 0.0;
+    qreal maxValue = 0.0;
+    const bool usePyramid = isPyramidUsable();
+    if (usePyramid) {
+        const DataPyramid::Aggregate aggregate = m_pyramid.aggregate(position.column, rows.first, rows.second);
+        minRow = aggregate.minRow;
+        maxRow = aggregate.maxRow;
+        if (aggregate.visibleCount > 0) {
+            firstRow = rows.first;
+            while (m_pyramid.isHidden(position.column, firstRow)) {
+                ++firstRow;
+            }
+            lastRow = rows.second - 1;
+            while (m_pyramid.isHidden(position.column, lastRow)) {
+                --lastRow;
+            }
+        }
+    } else {
+        prefetch(position.column, rows.first, rows.second);
+        for (int row = rows.first; row < rows.second; ++row) {
+            const QModelIndex index = m_model->index(row, position.column, m_rootIndex); // checked
+            if (modelHidden(index)) {
+                continue;
+            }
+            if (firstRow == -1) {
+                firstRow = row;
+            }
+            lastRow = row;
+            const qreal value = modelValue(index);
+            if (ISNAN(value)) {
+                continue;
+            }
+            if (minRow == -1 || value < minValue) {
+                minRow = row;
+                minValue = value;
+            }
+            if (maxRow == -1 || value > maxValue) {
+                maxRow = row;
+                maxValue = value;
+            }
+        }
+    }
+
+    int pickedRows[MinMaxPointsPerPixel] = {firstRow, minRow, maxRow, lastRow};
+    if (firstRow == -1) {
+        // everything is hidden, use any index so the cache entries are valid
+        std::fill(pickedRows, pickedRows + MinMaxPointsPerPixel, rows.first);
+    } else if (minRow == -1) {
+        // only missing values, keep first and last to preserve the gap
+        pickedRows[1] = firstRow;
+        pickedRows[2] = lastRow;
+    } else if (minRow > maxRow) {
+        // keep the points in row order, so lines are drawn left to right
+        std::swap(pickedRows[1], pickedRows[2]);
+    }
+
+    for (int i = 0; i < MinMaxPointsPerPixel; ++i) {
+        DataPoint point;
+        point.index = m_model->index(pickedRows[i], position.column, m_rootIndex); // checked
+        point.key = pickedRows[i];
+        point.value = usePyramid ? m_pyramid.value(position.column, pickedRows[i]) : modelValue(point.index);
+        point.hidden = firstRow == -1;
+        m_data[position.column][firstSlot + i] = point;
+    }
+    Q_ASSERT(isCached(position));
+}
+
 CartesianDiagramDataCompressor::CachePosition CartesianDiagramDataCompressor::mapToCache(
     const QModelIndex &index) const
 {
@@ -535,6 +1159,17 @@ CartesianDiagramDataCompressor::CachePosition CartesianDiagramDataCompressor::ma
     if (indexesPerPixel() == 0) {
         return mapToCache(QModelIndex());
     }
+    if (isMinMaxBucketed()) {
+        // map to the first cache row of the pixel bucket
+        const qint64 buckets = m_data[0].size() / MinMaxPointsPerPixel;
+        const int bucket = int(row * buckets / m_model->rowCount(m_rootIndex));
+        return CachePosition(bucket * MinMaxPointsPerPixel, column / m_datasetDimension);
+    }
+    if (isLttbReduced()) {
+        // the selected points are not known in advance, invalidate() handles the whole dataset anyway
+        const qint64 cacheRows = m_data[0].size();
+        return CachePosition(int(row * cacheRows / m_model->rowCount(m_rootIndex)), column / m_datasetDimension);
+    }
     return CachePosition(int(row / indexesPerPixel()), column / m_datasetDimension);
 }
 
@@ -546,7 +1181,23 @@ QModelIndexList CartesianDiagramDataCompressor::mapToModel(const CachePosition &
     }
 
     Q_ASSERT(position.column < modelDataColumns());
-    if (m_datasetDimension == 2) {
+    if (isMinMaxBucketed()) {
+        // every cache row represents exactly one of the bucket's rows
+        if (!isCached(position)) {
+            retrieveModelData(position);
+        }
+        indexes << m_data[position.column][position.row].index;
+    } else if (isLttbReduced()) {
+        // every cache row represents exactly one selected row
+        if (!isCached(position)) {
+            retrieveModelData(position);
+        }
+        const QModelIndex keyIndex = m_data[position.column][position.row].index;
+        indexes << keyIndex;
+        if (m_datasetDimension == 2) {
+            indexes << keyIndex.sibling(keyIndex.row(), keyIndex.column() + 1);
+        }
+    } else if (m_datasetDimension == 2) {
         indexes << m_model->index(position.row, position.column * 2, m_rootIndex); // checked
         indexes << m_model->index(position.row, position.column * 2 + 1, m_rootIndex); // checked
     } else {
@@ -583,11 +1234,28 @@ bool CartesianDiagramDataCompressor::mapsToModelIndex(const CachePosition &posit
 void CartesianDiagramDataCompressor::invalidate(const CachePosition &position)
 {
     if (mapsToModelIndex(position)) {
-        m_data[position.column][position.row] = DataPoint();
-        // Also invalidate the data value attributes at "position".
-        // Otherwise the user overwrites the attributes without us noticing
-        // it because we keep reading what's in the cache.
-        m_dataValueAttributesCache.remove(position);
+        int firstRow = position.row;
+        int lastRow = position.row;
+        if (isMinMaxBucketed()) {
+            // in MinMax mode, a change to any row may change all points of the bucket
+            firstRow = position.row - position.row % MinMaxPointsPerPixel;
+            lastRow = firstRow + MinMaxPointsPerPixel - 1;
+        } else if (isLttbReduced()) {
+            // the selection of every point depends on its neighbors
+            if (!m_data[position.column][0].index.isValid()) {
+                return; // already invalidated
+            }
+            firstRow = 0;
+            lastRow = m_data[position.column].size() - 1;
+        }
+        for (int row = firstRow; row <= lastRow; ++row) {
+            forgetPoint(position.column, row);
+            m_data[position.column][row] = DataPoint();
+            // Also invalidate the data value attributes at "position".
+            // Otherwise the user overwrites the attributes without us noticing
+            // it because we keep reading what's in the cache.
+            m_dataValueAttributesCache.remove(CachePosition(row, position.column));
+        }
     }
 }
 
@@ -600,7 +1268,7 @@ bool CartesianDiagramDataCompressor::isCached(const CachePosition &position) con
 
 void CartesianDiagramDataCompressor::calculateSampleStepWidth()
 {
-    if (m_mode == Precise) {
+    if (m_mode != SamplingSeven) {
         m_sampleStep = 1;
         return;
     }
@@ -636,7 +1304,62 @@ void CartesianDiagramDataCompressor::setDatasetDimension(int dimension)
 {
     if (dimension != m_datasetDimension) {
         m_datasetDimension = dimension;
+        m_pyramid.clear();
         rebuildCache();
         calculateSampleStepWidth();
     }
 }
+
+void CartesianDiagramDataCompressor::setUsePyramid(bool usePyramid)
+{
+    m_usePyramid = usePyramid;
+    if (!usePyramid) {
+        m_pyramid.clear();
+    }
+}
+
+bool CartesianDiagramDataCompressor::usePyramid() const
+{
+    return m_usePyramid;
+}
+
+bool CartesianDiagramDataCompressor::isPyramidUsable() const
+{
+    return m_usePyramid && m_model && m_datasetDimension == 1 && (m_mode == Precise || m_mode == MinMax);
+}
+
+void CartesianDiagramDataCompressor::buildPyramid() const
+{
+    const int rowCount = m_model->rowCount(m_rootIndex);
+    const int columnCount = m_model->columnCount(m_rootIndex);
+    m_pyramid.resize(columnCount, rowCount);
+    for (int column = 0; column < columnCount; ++column) {
+        prefetch(column, 0, rowCount);
+        for (int row = 0; row < rowCount; ++row) {
+            const QModelIndex index = m_model->index(row, column, m_rootIndex); // checked
+            m_pyramid.setValue(column, row, modelValue(index), modelHidden(index));
+        }
+    }
+    m_pyramid.build();
+}
+
+void CartesianDiagramDataCompressor::retrievePyramidData(const CachePosition &position) const
+{
+    Q_ASSERT(!m_pyramid.isEmpty());
+    // same row range and results as the Precise mode, but without reading the model
+    const qreal ipp = indexesPerPixel();
+    const int baseRow = floor(position.row * ipp);
+    const int endRow = qMin(int(floor((position.row + 1) * ipp)), m_pyramid.rowCount());
+    Q_ASSERT(baseRow < endRow);
+    const DataPyramid::Aggregate aggregate = m_pyramid.aggregate(position.column, baseRow, endRow);
+
+    DataPoint result;
+    result.index = m_model->index(baseRow, position.column, m_rootIndex); // checked
+    result.key = (baseRow + endRow - 1) / 2.0;
+    // like in Precise mode, missing values count as zero unless all values are missing
+    result.value = aggregate.valueCount > 0 ? aggregate.sum / (endRow - baseRow)
+                                            : std::numeric_limits<qreal>::quiet_NaN();
+    result.hidden = aggregate.visibleCount == 0;
+    m_data[position.column][position.row] = result;
+    Q_ASSERT(isCached(position));
+}
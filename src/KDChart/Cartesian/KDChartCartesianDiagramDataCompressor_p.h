@@ -30,6 +30,7 @@
 #include <QPointer>
 #include <QVector>
 
+#include "KDChartDataPyramid_p.h"
 #include "KDChartDataValueAttributes.h"
 #include "KDChartModelDataCache_p.h"
 
@@ -43,6 +44,9 @@ QT_END_NAMESPACE
 namespace KDChart {
 
 class AbstractDiagram;
+class AttributesModel;
+class ColumnarDataModel;
+class RingBufferModel;
 
 // - transparently compress table model data if the diagram widget
 // size does not allow to display all data points in an acceptable way
@@ -78,6 +82,26 @@ public:
         QModelIndex index;
     };
     typedef QVector<DataPoint> DataPointVector;
+    // the extent of the cached points of a dataset, kept up to date incrementally
+    class ColumnBoundaries
+    {
+    public:
+        ColumnBoundaries()
+            : xMin(std::numeric_limits<qreal>::quiet_NaN())
+            , xMax(std::numeric_limits<qreal>::quiet_NaN())
+            , yMin(std::numeric_limits<qreal>::quiet_NaN())
+            , yMax(std::numeric_limits<qreal>::quiet_NaN())
+        {
+        }
+        qreal xMin;
+        qreal xMax;
+        qreal yMin;
+        qreal yMax;
+        // the whole dataset must be scanned again
+        bool dirty = true;
+        // cache rows whose new points can only extend the boundaries
+        QVector<int> pendingRows;
+    };
     class CachePosition
     {
     public:
@@ -115,10 +139,22 @@ public:
         // do not approximate, interpolate by averaging all
         // datapoints for a pixel
         Precise,
-        // approximate by averaging out over prime number distances
-        SamplingSeven
+        // approximate by averaging out over prime number distances,
+        // reading only a few rows per pixel column
+        SamplingSeven,
+        // keep the first, minimum, maximum and last datapoint of every
+        // pixel column (M4), so that spikes and dropouts survive
+        MinMax,
+        // select the visually most significant datapoints using the
+        // Largest-Triangle-Three-Buckets algorithm, also for non-uniform keys
+        LargestTriangleThreeBuckets
     };
 
+    // number of cache rows per pixel column in MinMax mode
+    static constexpr int MinMaxPointsPerPixel = 4;
+    // number of cache rows per pixel column in LargestTriangleThreeBuckets mode
+    static constexpr int LttbPointsPerPixel = 2;
+
     explicit CartesianDiagramDataCompressor(QObject *parent = nullptr);
 
     // input: model, chart resolution, approximation mode
@@ -127,7 +163,15 @@ public:
     void setResolution(int x, int y);
     void recalcResolution();
     void setApproximationMode(ApproximationMode mode);
+    ApproximationMode approximationMode() const;
     void setDatasetDimension(int dimension);
+    // keep a multi-resolution summary of the model data, so resolution
+    // changes (e.g. zooming) do not need to read the model again
+    void setUsePyramid(bool usePyramid);
+    bool usePyramid() const;
+    // read values directly from the spans of a ColumnarDataSource; the model
+    // set with setModel() must be a proxy (the AttributesModel) of \a model
+    void setColumnarModel(ColumnarDataModel *model);
 
     // output: resulting model resolution, data points
     // FIXME (Mirko) rather stupid naming, Mirko!
@@ -156,6 +200,11 @@ private Q_SLOTS:
     void slotModelHeaderDataChanged(Qt::Orientation, int, int);
     void slotModelDataChanged(const QModelIndex &, const QModelIndex &);
     void slotModelLayoutChanged();
+    void slotModelReset();
+    // the DataHiddenRole of some cells may have changed
+    void slotAttributesChanged(const QModelIndex &, const QModelIndex &);
+    // the model dropped count rows at the top and appended as many at the bottom
+    void slotRowsShifted(int count);
     // FIXME resolution changes and root index changes should all
     // be catchable with this method:
     void slotDiagramLayoutChanged(KDChart::AbstractDiagram *);
@@ -168,6 +217,8 @@ private Q_SLOTS:
 private:
     // private version of setResolution() that does *not* call rebuildCache()
     bool setResolutionInternal(int x, int y);
+    // number of cached datapoints per column for the current resolution and mode
+    int cacheRowCount() const;
     // forget cached data at the position
     void invalidate(const CachePosition &);
     // check if position is inside the dataset's index range
@@ -184,15 +235,57 @@ private:
                            bool isRows, /* columns otherwise */
                            int *start, int *end);
 
+    // the value at index, from the columnar model if set, otherwise from the model cache
+    qreal modelValue(const QModelIndex &index) const;
+    // the DataHiddenRole of index, cached along with its value
+    bool modelHidden(const QModelIndex &index) const;
+    // reads the values and hidden flags of rows [firstRow, endRow) of a model column in one pass
+    void prefetch(int column, int firstRow, int endRow) const;
     // retrieve data from the model, put it into the cache
     void retrieveModelData(const CachePosition &) const;
+    // SamplingSeven mode: average every m_sampleStep'th row of the position's row range
+    DataPoint sampleModelData(const CachePosition &) const;
+    // true if row insertions and removals require a rebuild of the whole cache
+    bool cacheDependsOnRowCount() const;
+    // LargestTriangleThreeBuckets mode: true if the cache holds fewer rows than the model
+    bool isLttbReduced() const;
+    // LargestTriangleThreeBuckets mode: retrieve all cache rows of a dataset
+    void retrieveLttbColumn(int column) const;
+    // MinMax mode: true if the cache holds pixel buckets rather than single model rows
+    bool isMinMaxBucketed() const;
+    // MinMax mode: the half-open model row range [first, second) of a pixel bucket
+    QPair<int, int> minMaxBucketRows(int bucket) const;
+    // MinMax mode: retrieve the four cache rows of the bucket containing the position
+    void retrieveMinMaxBucket(const CachePosition &) const;
+    // a cached point is going to be dropped or replaced, update the boundaries accordingly
+    void forgetPoint(int column, int row) const;
+    // cache rows from start on moved by delta (positive: inserted, negative: removed)
+    void moveBoundaryRows(int start, int delta);
+    // all datasets must be scanned again by dataBoundaries()
+    void resetBoundaries() const;
     // check if a data point is in the cache:
     bool isCached(const CachePosition &) const;
     // set sample step width according to settings:
     void calculateSampleStepWidth();
+    // true if retrieveModelData() reads from the pyramid instead of the model
+    bool isPyramidUsable() const;
+    // read the whole model into the pyramid
+    void buildPyramid() const;
+    // retrieve data from the pyramid, put it into the cache
+    void retrievePyramidData(const CachePosition &) const;
 
     QPointer<QAbstractItemModel> m_model;
     QModelIndex m_rootIndex;
+    QPointer<ColumnarDataModel> m_columnarModel;
+    // the model, if it is an AttributesModel
+    QPointer<AttributesModel> m_attributesModel;
+    // with a columnar model and no hidden cells: the DataHiddenRole of each model
+    // column, -1 if not looked up yet
+    mutable QVector<qint8> m_columnHidden;
+    // the model, or the source of the proxy model, if it can announce shifted rows
+    QPointer<RingBufferModel> m_ringBufferModel;
+    // set by slotRowsShifted() until the following dataChanged() for the whole model
+    bool m_rowsShiftPending = false;
 
     ApproximationMode m_mode = Precise;
     int m_xResolution = 0;
@@ -200,9 +293,12 @@ private:
     unsigned int m_sampleStep = 0;
 
     mutable QVector<DataPointVector> m_data; // one per dataset
+    mutable QVector<ColumnBoundaries> m_boundaries; // one per dataset
     ModelDataCache<qreal, Qt::DisplayRole> m_modelCache;
     mutable DataValueAttributesCache m_dataValueAttributesCache;
     int m_datasetDimension = 1;
+    bool m_usePyramid = false;
+    mutable DataPyramid m_pyramid;
 };
 }
 
@@ -0,0 +1,179 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#include "KDChartDataPyramid_p.h"
+
+#include <KDABLibFakes>
+
+using namespace KDChart;
+
+bool DataPyramid::isEmpty() const
+{
+    return m_columns.isEmpty();
+}
+
+void DataPyramid::clear()
+{
+    m_columns.clear();
+    m_rowCount = 0;
+}
+
+void DataPyramid::resize(int columnCount, int rowCount)
+{
+    m_columns.clear();
+    m_columns.resize(columnCount);
+    m_rowCount = rowCount;
+    for (Column &column : m_columns) {
+        column.values.resize(rowCount);
+        column.hidden.resize(rowCount);
+    }
+}
+
+int DataPyramid::columnCount() const
+{
+    return m_columns.size();
+}
+
+int DataPyramid::rowCount() const
+{
+    return m_rowCount;
+}
+
+void DataPyramid::setValue(int column, int row, qreal value, bool hidden)
+{
+    Column &c = m_columns[column];
+    c.values[row] = value;
+    c.hidden.setBit(row, hidden);
+}
+
+qreal DataPyramid::value(int column, int row) const
+{
+    return m_columns[column].values[row];
+}
+
+bool DataPyramid::isHidden(int column, int row) const
+{
+    return m_columns[column].hidden.testBit(row);
+}
+
+void DataPyramid::addRow(Aggregate *aggregate, int row, qreal value, bool hidden)
+{
+    const bool valid = !ISNAN(value);
+    if (valid) {
+        aggregate->sum += value;
+        ++aggregate->valueCount;
+    }
+    if (hidden) {
+        return;
+    }
+    ++aggregate->visibleCount;
+    if (!valid) {
+        return;
+    }
+    // on ties, the earlier row wins
+    if (aggregate->minRow == -1 || value < aggregate->min) {
+        aggregate->min = value;
+        aggregate->minRow = row;
+    }
+    if (aggregate->maxRow == -1 || value > aggregate->max) {
+        aggregate->max = value;
+        aggregate->maxRow = row;
+    }
+}
+
+void DataPyramid::merge(Aggregate *aggregate, const Aggregate &other)
+{
+    // other always covers rows after the ones of aggregate
+    aggregate->sum += other.sum;
+    aggregate->valueCount += other.valueCount;
+    aggregate->visibleCount += other.visibleCount;
+    if (other.minRow != -1 && (aggregate->minRow == -1 || other.min < aggregate->min)) {
+        aggregate->min = other.min;
+        aggregate->minRow = other.minRow;
+    }
+    if (other.maxRow != -1 && (aggregate->maxRow == -1 || other.max > aggregate->max)) {
+        aggregate->max = other.max;
+        aggregate->maxRow = other.maxRow;
+    }
+}
+
+DataPyramid::Aggregate DataPyramid::computeBlock(const Column &column, int level, int block) const
+{
+    Aggregate result;
+    if (level == 0) {
+        const int firstRow = block << BlockShift;
+        const int endRow = firstRow + (1 << BlockShift);
+        for (int row = firstRow; row < endRow; ++row) {
+            addRow(&result, row, column.values[row], column.hidden.testBit(row));
+        }
+    } else {
+        const QVector<Aggregate> &children = column.levels[level - 1];
+        result = children[2 * block];
+        merge(&result, children[2 * block + 1]);
+    }
+    return result;
+}
+
+void DataPyramid::build()
+{
+    for (Column &column : m_columns) {
+        column.levels.clear();
+        // only complete blocks are stored, the rest is read from the raw values
+        for (int level = 0; (m_rowCount >> (BlockShift + level)) > 0; ++level) {
+            const int blockCount = m_rowCount >> (BlockShift + level);
+            column.levels.append(QVector<Aggregate>(blockCount));
+            QVector<Aggregate> &blocks = column.levels.last();
+            for (int block = 0; block < blockCount; ++block) {
+                blocks[block] = computeBlock(column, level, block);
+            }
+        }
+    }
+}
+
+void DataPyramid::update(int column, int firstRow, int lastRow)
+{
+    Column &c = m_columns[column];
+    for (int level = 0; level < c.levels.size(); ++level) {
+        QVector<Aggregate> &blocks = c.levels[level];
+        const int firstBlock = firstRow >> (BlockShift + level);
+        const int lastBlock = qMin(lastRow >> (BlockShift + level), blocks.size() - 1);
+        for (int block = firstBlock; block <= lastBlock; ++block) {
+            blocks[block] = computeBlock(c, level, block);
+        }
+    }
+}
+
+DataPyramid::Aggregate DataPyramid::aggregate(int column, int firstRow, int endRow) const
+{
+    const Column &c = m_columns[column];
+    Aggregate result;
+    int row = firstRow;
+    while (row < endRow) {
+        // use the largest aligned block that fits into the remaining range
+        int level = -1;
+        if ((row & ((1 << BlockShift) - 1)) == 0) {
+            for (int candidate = c.levels.size() - 1; candidate >= 0; --candidate) {
+                const int blockSize = 1 << (BlockShift + candidate);
+                if ((row & (blockSize - 1)) == 0 && row + blockSize <= endRow) {
+                    level = candidate;
+                    break;
+                }
+            }
+        }
+        if (level == -1) {
+            addRow(&result, row, c.values[row], c.hidden.testBit(row));
+            ++row;
+        } else {
+            merge(&result, c.levels[level][row >> (BlockShift + level)]);
+            row += 1 << (BlockShift + level);
+        }
+    }
+    return result;
+}
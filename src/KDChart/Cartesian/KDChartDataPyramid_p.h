@@ -0,0 +1,102 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#ifndef KDCHARTDATAPYRAMID_H
+#define KDCHARTDATAPYRAMID_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the KD Chart API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <limits>
+
+#include <QBitArray>
+#include <QVector>
+
+namespace KDChart {
+
+// - a multi-resolution summary of the values of all datasets
+// - level k holds one Aggregate per 2^(BlockShift + k) rows, so the
+// aggregate of any row range is combined from O(log n) precomputed
+// blocks plus at most two partial blocks of raw values
+// - lets the CartesianDiagramDataCompressor answer any resolution
+// (e.g. after zooming) without reading the model again
+class DataPyramid
+{
+public:
+    class Aggregate
+    {
+    public:
+        Aggregate()
+            : min(std::numeric_limits<qreal>::quiet_NaN())
+            , max(std::numeric_limits<qreal>::quiet_NaN())
+        {
+        }
+        // sum and count of all valid (non-NaN) values, hidden or not
+        qreal sum = 0.0;
+        int valueCount = 0;
+        // number of rows that are not hidden
+        int visibleCount = 0;
+        // extremes of the valid values of all visible rows, -1 if there are none
+        qreal min;
+        qreal max;
+        int minRow = -1;
+        int maxRow = -1;
+    };
+
+    // the first level aggregates 2^BlockShift rows, smaller ranges are read from the raw values
+    static constexpr int BlockShift = 4;
+
+    bool isEmpty() const;
+    void clear();
+
+    // allocates storage for all raw values, which are then set with setValue()
+    void resize(int columnCount, int rowCount);
+    int columnCount() const;
+    int rowCount() const;
+
+    void setValue(int column, int row, qreal value, bool hidden);
+    qreal value(int column, int row) const;
+    bool isHidden(int column, int row) const;
+
+    // computes all levels from the raw values
+    void build();
+    // recomputes the levels above the raw values of rows firstRow to lastRow (inclusive)
+    void update(int column, int firstRow, int lastRow);
+
+    // the aggregate of rows [firstRow, endRow)
+    Aggregate aggregate(int column, int firstRow, int endRow) const;
+
+private:
+    class Column
+    {
+    public:
+        QVector<qreal> values;
+        QBitArray hidden;
+        QVector<QVector<Aggregate>> levels;
+    };
+
+    static void addRow(Aggregate *aggregate, int row, qreal value, bool hidden);
+    static void merge(Aggregate *aggregate, const Aggregate &other);
+    Aggregate computeBlock(const Column &column, int level, int block) const;
+
+    QVector<Column> m_columns;
+    int m_rowCount = 0;
+};
+}
+
+#endif
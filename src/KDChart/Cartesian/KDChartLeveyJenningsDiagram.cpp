@@ -15,18 +15,64 @@
 #include "KDChartChart.h"
 #include "KDChartPainterSaver_p.h"
 #include "KDChartTextAttributes.h"
+#include "KDChartTextLabelCache.h"
 
+#include <QCoreApplication>
+#include <QDataStream>
 #include <QDateTime>
 #include <QFontMetrics>
 #include <QPainter>
 #include <QSvgRenderer>
+#include <QThread>
 #include <QVector>
+#include <QtCore/qmath.h>
 
 #include <KDABLibFakes>
 
 using namespace KDChart;
 using namespace std;
 
+// the cached pixmaps may only be used in the GUI thread
+static bool isGuiThread()
+{
+    const QCoreApplication *app = QCoreApplication::instance();
+    return app && QThread::currentThread() == app->thread();
+}
+
+// Paints the symbol that renderer reads from filename into rect. On screen, the
+// rendered symbol is shared through the PrerenderedElementCache; printers and
+// other vector devices, as well as scaled or rotated painters, get the SVG itself.
+static void renderSymbol(QPainter *painter, QSvgRenderer *renderer, const QString &filename, const QRectF &rect)
+{
+    const int deviceType = painter->device()->devType();
+    const bool isRaster = deviceType == QInternal::Widget || deviceType == QInternal::Pixmap
+        || deviceType == QInternal::Image;
+    if (!isRaster || !isGuiThread() || painter->worldTransform().type() > QTransform::TxTranslate || filename.isEmpty()) {
+        renderer->render(painter, rect);
+        return;
+    }
+
+    const qreal ratio = painter->device()->devicePixelRatioF();
+    QByteArray key;
+    {
+        QDataStream stream(&key, QIODevice::WriteOnly);
+        stream << QByteArray("LeveyJenningsSymbol") << filename << rect << ratio;
+    }
+    PrerenderedElementCache *const cache = PrerenderedElementCache::instance();
+    QPixmap pixmap;
+    if (!cache->find(key, &pixmap)) {
+        pixmap = QPixmap(qCeil(rect.width() * ratio), qCeil(rect.height() * ratio));
+        pixmap.setDevicePixelRatio(ratio);
+        pixmap.fill(Qt::transparent);
+        QPainter pixmapPainter(&pixmap);
+        pixmapPainter.setRenderHints(painter->renderHints());
+        renderer->render(&pixmapPainter, QRectF(QPointF(0.0, 0.0), rect.size()));
+        pixmapPainter.end();
+        cache->insert(key, pixmap);
+    }
+    painter->drawPixmap(rect.topLeft(), pixmap);
+}
+
 LeveyJenningsDiagram::Private::Private()
 {
 }
@@ -617,7 +663,7 @@ void LeveyJenningsDiagram::drawDataPointSymbol(PaintContext *ctx, const QPointF
     painter->translate(transPos);
 
     painter->setClipping(false);
-    iconRenderer(type)->render(painter, iconRect());
+    renderSymbol(painter, iconRenderer(type), d->icons[type], iconRect());
 }
 
 /**
@@ -634,7 +680,7 @@ void LeveyJenningsDiagram::drawLotChangeSymbol(PaintContext *ctx, const QPointF
     const PainterSaver ps(painter);
     painter->setClipping(false);
     painter->translate(transPos);
-    iconRenderer(LotChanged)->render(painter, iconRect());
+    renderSymbol(painter, iconRenderer(LotChanged), d->icons[LotChanged], iconRect());
 }
 
 /**
@@ -651,7 +697,7 @@ void LeveyJenningsDiagram::drawSensorChangedSymbol(PaintContext *ctx, const QPoi
     const PainterSaver ps(painter);
     painter->setClipping(false);
     painter->translate(transPos);
-    iconRenderer(SensorChanged)->render(painter, iconRect());
+    renderSymbol(painter, iconRenderer(SensorChanged), d->icons[SensorChanged], iconRect());
 }
 
 /**
@@ -668,7 +714,7 @@ void LeveyJenningsDiagram::drawFluidicsPackChangedSymbol(PaintContext *ctx, cons
     const PainterSaver ps(painter);
     painter->setClipping(false);
     painter->translate(transPos);
-    iconRenderer(FluidicsPackChanged)->render(painter, iconRect());
+    renderSymbol(painter, iconRenderer(FluidicsPackChanged), d->icons[FluidicsPackChanged], iconRect());
 }
 
 /**
@@ -243,10 +243,7 @@ LineAttributes LineDiagram::lineAttributes(int column) const
 LineAttributes LineDiagram::lineAttributes(
     const QModelIndex &index) const
 {
-    return d->attributesModel->data(
-                                 d->attributesModel->mapFromSource(index),
-                                 KDChart::LineAttributesRole)
-        .value<LineAttributes>();
+    return d->attributesModel->attribute<LineAttributes>(d->attributesModel->mapFromSource(index), KDChart::LineAttributesRole);
 }
 
 /**
@@ -313,10 +310,7 @@ ThreeDLineAttributes LineDiagram::threeDLineAttributes(int column) const
  */
 ThreeDLineAttributes LineDiagram::threeDLineAttributes(const QModelIndex &index) const
 {
-    return d->attributesModel->data(
-                                 d->attributesModel->mapFromSource(index),
-                                 KDChart::ThreeDLineAttributesRole)
-        .value<ThreeDLineAttributes>();
+    return d->attributesModel->attribute<ThreeDLineAttributes>(d->attributesModel->mapFromSource(index), KDChart::ThreeDLineAttributesRole);
 }
 
 qreal LineDiagram::threeDItemDepth(const QModelIndex &index) const
@@ -347,10 +341,7 @@ void LineDiagram::setValueTrackerAttributes(const QModelIndex &index,
 ValueTrackerAttributes LineDiagram::valueTrackerAttributes(
     const QModelIndex &index) const
 {
-    return d->attributesModel->data(
-                                 d->attributesModel->mapFromSource(index),
-                                 KDChart::ValueTrackerAttributesRole)
-        .value<ValueTrackerAttributes>();
+    return d->attributesModel->attribute<ValueTrackerAttributes>(d->attributesModel->mapFromSource(index), KDChart::ValueTrackerAttributesRole);
 }
 
 /**
@@ -411,6 +402,8 @@ void LineDiagram::paint(PaintContext *ctx)
     AbstractCoordinatePlane *const plane = ctx->coordinatePlane();
     ctx->setCoordinatePlane(plane->sharedAxisMasterPlane(ctx->painter()));
 
+    d->styleSnapshot.resolveLines(d->attributesModel, attributesModelRootIndex());
+
     // paint different line types Normal - Stacked - Percent - Default Normal
     d->implementor->paint(ctx);
 
@@ -18,12 +18,75 @@
 using namespace KDChart;
 using namespace std;
 
+namespace {
+// gaps of missing values up to this many rows are searched for the neighbours of a changed point
+const int MaxBridgedRows = 64;
+}
+
 LineDiagram::Private::Private(const Private &rhs)
     : AbstractCartesianDiagram::Private(rhs)
     , tension(rhs.tension)
 {
 }
 
+QRectF LineDiagram::Private::dataChangedRect(const QModelIndex &topLeft, const QModelIndex &bottomRight) const
+{
+    if (datasetDimension != 1
+        || hasCellAttributes(styleSnapshot.threeDLineAttributes, topLeft.column(), bottomRight.column())
+        || hasCellAttributes(styleSnapshot.valueTrackerAttributes, topLeft.column(), bottomRight.column())
+        || attributesModel->data(ValueTrackerAttributesRole).value<ValueTrackerAttributes>().isEnabled()) {
+        return QRectF();
+    }
+    const auto *lineDiagram = static_cast<const LineDiagram *>(diagram);
+    const int columns = datasetCount();
+    for (int column = 0; column < columns; ++column) {
+        if (lineDiagram->threeDLineAttributes(column).isEnabled()) {
+            return QRectF();
+        }
+    }
+
+    // A changed point moves the segments to its neighbours, and splines reach one point
+    // further. Missing values are bridged, so the neighbours are the next complete rows.
+    // Longer gaps than MaxBridgedRows are not searched; the plane is repainted as a whole.
+    const int rowCount = attributesModel->rowCount(attributesModelRootIndex);
+    auto rowIsComplete = [&](int row) {
+        for (int column = 0; column < columns; ++column) {
+            const QVariant value = attributesModel->data(attributesModel->index(row, column, attributesModelRootIndex));
+            if (!value.isValid() || ISNAN(value.toReal())) {
+                return false;
+            }
+        }
+        return true;
+    };
+    // the next complete row from row in direction step, or -1 if there is none close enough
+    auto completeNeighbour = [&](int row, int step) {
+        for (int searched = 0; searched < MaxBridgedRows; ++searched) {
+            row += step;
+            if (row <= 0 || row >= rowCount - 1 || rowIsComplete(row)) {
+                return row;
+            }
+        }
+        return -1;
+    };
+    int first = topLeft.row();
+    for (int neighbours = 0; neighbours < 2 && first > 0; ++neighbours) {
+        first = completeNeighbour(first, -1);
+        if (first < 0) {
+            return QRectF();
+        }
+    }
+    int last = bottomRight.row();
+    for (int neighbours = 0; neighbours < 2 && last < rowCount - 1; ++neighbours) {
+        last = completeNeighbour(last, 1);
+        if (last < 0) {
+            return QRectF();
+        }
+    }
+
+    const qreal offset = centerDataPoints ? 0.5 : 0.0;
+    return keyStripRect(first + offset, last + offset, topLeft.column(), bottomRight.column());
+}
+
 AttributesModel *LineDiagram::LineDiagramType::attributesModel() const
 {
     return m_private->attributesModel;
@@ -49,6 +49,8 @@ public:
     Private(const Private &rhs);
     ~Private() override;
 
+    QRectF dataChangedRect(const QModelIndex &topLeft, const QModelIndex &bottomRight) const override;
+
     LineDiagramType *implementor; // the current type
     LineDiagramType *normalDiagram;
     LineDiagramType *stackedDiagram;
@@ -88,7 +88,7 @@ void Plotter::connectAttributesModel(AttributesModel *newModel)
     // invocation order. Refer to the longer comment in
     // AbstractCartesianDiagram::connectAttributesModel() for details.
 
-    if (useDataCompression() == Plotter::NONE) {
+    if (!d->usesPlotterCompressor()) {
         d->plotterCompressor.setModel(nullptr);
         AbstractCartesianDiagram::connectAttributesModel(newModel);
     } else {
@@ -115,12 +115,19 @@ Plotter::CompressionMode Plotter::useDataCompression() const
 void Plotter::setUseDataCompression(Plotter::CompressionMode value)
 {
     if (useDataCompression() != value) {
+        const bool usedPlotterCompressor = d->usesPlotterCompressor();
         d->implementor->setUseCompression(value);
-        if (useDataCompression() != Plotter::NONE) {
+        if (d->usesPlotterCompressor()) {
             d->compressor.setModel(nullptr);
             if (attributesModel() != d->plotterCompressor.model())
                 d->plotterCompressor.setModel(attributesModel());
+        } else if (usedPlotterCompressor) {
+            d->plotterCompressor.setModel(nullptr);
+            d->compressor.setModel(attributesModel());
         }
+        d->compressor.setApproximationMode(value == Plotter::LTTB ? CartesianDiagramDataCompressor::LargestTriangleThreeBuckets
+                                                                  : d->compressorMode());
+        setDataBoundariesDirty();
     }
 }
 
@@ -263,9 +270,7 @@ LineAttributes Plotter::lineAttributes(int column) const
  */
 LineAttributes Plotter::lineAttributes(const QModelIndex &index) const
 {
-    return d->attributesModel->data(
-                                 d->attributesModel->mapFromSource(index), KDChart::LineAttributesRole)
-        .value<LineAttributes>();
+    return d->attributesModel->attribute<LineAttributes>(d->attributesModel->mapFromSource(index), KDChart::LineAttributesRole);
 }
 
 /**
@@ -324,9 +329,7 @@ ThreeDLineAttributes Plotter::threeDLineAttributes(int column) const
  */
 ThreeDLineAttributes Plotter::threeDLineAttributes(const QModelIndex &index) const
 {
-    return d->attributesModel->data(
-                                 d->attributesModel->mapFromSource(index), KDChart::ThreeDLineAttributesRole)
-        .value<ThreeDLineAttributes>();
+    return d->attributesModel->attribute<ThreeDLineAttributes>(d->attributesModel->mapFromSource(index), KDChart::ThreeDLineAttributesRole);
 }
 
 qreal Plotter::threeDItemDepth(const QModelIndex &index) const
@@ -354,9 +357,7 @@ void Plotter::setValueTrackerAttributes(const QModelIndex &index, const ValueTra
  */
 ValueTrackerAttributes Plotter::valueTrackerAttributes(const QModelIndex &index) const
 {
-    return d->attributesModel->data(
-                                 d->attributesModel->mapFromSource(index), KDChart::ValueTrackerAttributesRole)
-        .value<ValueTrackerAttributes>();
+    return d->attributesModel->attribute<ValueTrackerAttributes>(d->attributesModel->mapFromSource(index), KDChart::ValueTrackerAttributesRole);
 }
 
 void Plotter::resizeEvent(QResizeEvent *)
@@ -406,6 +407,8 @@ void Plotter::paint(PaintContext *ctx)
 
     ctx->setCoordinatePlane(plane->sharedAxisMasterPlane(ctx->painter()));
 
+    d->styleSnapshot.resolveLines(d->attributesModel, attributesModelRootIndex());
+
     // paint different line types Normal - Stacked - Percent - Default Normal
     d->implementor->paint(ctx);
 
@@ -36,12 +36,15 @@ class KDCHART_EXPORT Plotter : public AbstractCartesianDiagram
 public:
     // SLOPE enables a compression based on minimal slope changes
     // DISTANCE is still buggy and can fail, same for BOTH, NONE is the default mode
+    // LTTB reduces every dataset to about two points per pixel of the plane width using
+    // the Largest-Triangle-Three-Buckets algorithm, keeping the visual shape of the data
     enum CompressionMode
     {
         SLOPE,
         DISTANCE,
         BOTH,
-        NONE
+        NONE,
+        LTTB
     };
     Q_ENUM(CompressionMode)
 
@@ -38,6 +38,11 @@ void Plotter::Private::setCompressorResolution(
                              static_cast<int>(size.height() * plane->zoomFactorY()));
 }
 
+bool Plotter::Private::usesPlotterCompressor() const
+{
+    return useCompression != Plotter::NONE && useCompression != Plotter::LTTB;
+}
+
 void Plotter::Private::changedProperties()
 {
     if (auto *plane = dynamic_cast<CartesianCoordinatePlane *>(diagram->coordinatePlane())) {
@@ -54,6 +54,8 @@ public:
     void setCompressorResolution(
         const QSizeF &size,
         const AbstractCoordinatePlane *plane);
+    // true if the data is read through plotterCompressor rather than compressor
+    bool usesPlotterCompressor() const;
 
     PlotterType *implementor = nullptr; // the current type
     PlotterType *normalPlotter = nullptr;
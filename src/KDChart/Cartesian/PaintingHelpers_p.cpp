@@ -19,7 +19,6 @@
 #include "KDChartLineDiagram_p.h"
 #include "KDChartPaintContext.h"
 #include "KDChartPainterSaver_p.h"
-#include "KDChartPlotter.h"
 #include "KDChartPrintingParameters.h"
 #include "KDChartThreeDLineAttributes.h"
 #include "KDChartValueTrackerAttributes.h"
@@ -101,24 +100,24 @@ void paintSpline(PaintContext *ctx, const QBrush &brush, const QPen &pen, const
     ctx->painter()->drawPath(fitPoints(points, tension, splineDirection));
 }
 
-void paintThreeDLines(PaintContext *ctx, AbstractDiagram *diagram, const QModelIndex &index,
-                      const QPointF &from, const QPointF &to, const ThreeDLineAttributes &tdAttributes,
-                      ReverseMapper *reverseMapper)
+void paintThreeDLines(AbstractDiagram::Private *diagramPrivate, PaintContext *ctx, const QModelIndex &index,
+                      const QPointF &from, const QPointF &to, const ThreeDLineAttributes &tdAttributes)
 {
     const QPointF topLeft = project(from, tdAttributes);
     const QPointF topRight = project(to, tdAttributes);
     const QPolygonF segment = QPolygonF() << from << topLeft << topRight << to;
 
-    QBrush indexBrush(diagram->brush(index));
+    const StyleSnapshot &style = diagramPrivate->styleSnapshot;
+    QBrush indexBrush(style.brush.value(index));
     indexBrush = tdAttributes.threeDBrush(indexBrush, QRectF(topLeft, topRight));
 
     const PainterSaver painterSaver(ctx->painter());
 
-    ctx->painter()->setRenderHint(QPainter::Antialiasing, diagram->antiAliasing());
+    ctx->painter()->setRenderHint(QPainter::Antialiasing, diagramPrivate->diagram->antiAliasing());
     ctx->painter()->setBrush(indexBrush);
-    ctx->painter()->setPen(PrintingParameters::scalePen(diagram->pen(index)));
+    ctx->painter()->setPen(PrintingParameters::scalePen(style.pen.value(index)));
 
-    reverseMapper->addPolygon(index.row(), index.column(), segment);
+    diagramPrivate->reverseMapper.addPolygon(index.row(), index.column(), segment);
     ctx->painter()->drawPolygon(segment);
 }
 
@@ -202,30 +201,6 @@ void paintValueTracker(PaintContext *ctx, const ValueTrackerAttributes &vt, cons
     ctx->painter()->drawPolygon(endMarker, 3);
 }
 
-// ### for BC reasons we cannot insert a common interface for LineDiagram and Plotter into the class
-//     hierarchy, so we have to use hacks to use their common methods
-static ThreeDLineAttributes threeDLineAttributes(AbstractDiagram *diagram, const QModelIndex &index)
-{
-    if (auto *plotter = qobject_cast<Plotter *>(diagram)) {
-        return plotter->threeDLineAttributes(index);
-    } else if (auto *lineDiagram = qobject_cast<LineDiagram *>(diagram)) {
-        return lineDiagram->threeDLineAttributes(index);
-    }
-    Q_ASSERT(false);
-    return ThreeDLineAttributes();
-}
-
-static ValueTrackerAttributes valueTrackerAttributes(AbstractDiagram *diagram, const QModelIndex &index)
-{
-    if (auto *plotter = qobject_cast<Plotter *>(diagram)) {
-        return plotter->valueTrackerAttributes(index);
-    } else if (auto *lineDiagram = qobject_cast<LineDiagram *>(diagram)) {
-        return lineDiagram->valueTrackerAttributes(index);
-    }
-    Q_ASSERT(false);
-    return ValueTrackerAttributes();
-}
-
 void paintObject(AbstractDiagram::Private *diagramPrivate, PaintContext *ctx, const QBrush &brush, const QPen &pen, const QPolygonF &points)
 {
     qreal tension = 0;
@@ -245,10 +220,35 @@ void paintObject(AbstractDiagram::Private *diagramPrivate, PaintContext *ctx, co
     }
 }
 
+LineBatch::LineBatch(AbstractDiagram::Private *diagramPrivate)
+    : m_style(&diagramPrivate->styleSnapshot)
+{
+}
+
+void LineBatch::addLine(const QModelIndex &index, const QPointF &from, const QPointF &to)
+{
+    const bool uniform = m_style->hasUniformLines(index.column());
+    if (uniform && !m_runs.isEmpty()) {
+        Run &run = m_runs.last();
+        if (run.uniform && run.index.column() == index.column() && run.points.last() == from) {
+            run.points << to;
+            run.rows << index.row();
+            return;
+        }
+    }
+    Run run;
+    run.index = index;
+    run.points << from << to;
+    run.rows << index.row();
+    run.uniform = uniform;
+    m_runs << run;
+}
+
 void paintElements(AbstractDiagram::Private *diagramPrivate, PaintContext *ctx,
-                   const LabelPaintCache &lpc, const LineAttributesInfoList &lineList)
+                   const LabelPaintCache &lpc, const LineBatch &lines)
 {
     AbstractDiagram *diagram = diagramPrivate->diagram;
+    const StyleSnapshot &style = diagramPrivate->styleSnapshot;
     // paint all lines and their attributes
     const PainterSaver painterSaver(ctx->painter());
     ctx->painter()->setRenderHint(QPainter::Antialiasing, diagram->antiAliasing());
@@ -256,27 +256,36 @@ void paintElements(AbstractDiagram::Private *diagramPrivate, PaintContext *ctx,
     QBrush curBrush;
     QPen curPen;
     QPolygonF points;
-    for (const LineAttributesInfo &lineInfo : lineList) {
-        const QModelIndex &index = lineInfo.index;
-        const ThreeDLineAttributes td = threeDLineAttributes(diagram, index);
+    for (const LineBatch::Run &run : lines.runs()) {
+        const QModelIndex &index = run.index;
+        const ThreeDLineAttributes &td = style.threeDLineAttributes.value(index);
 
         if (td.isEnabled()) {
-            PaintingHelpers::paintThreeDLines(ctx, diagram, index, lineInfo.value,
-                                              lineInfo.nextValue, td, &diagramPrivate->reverseMapper);
+            for (int i = 0; i < run.rows.count(); ++i) {
+                PaintingHelpers::paintThreeDLines(diagramPrivate, ctx, index.sibling(run.rows.at(i), index.column()),
+                                                  run.points.at(i), run.points.at(i + 1), td);
+            }
         } else {
-            const QBrush brush(diagram->brush(index));
-            const QPen pen(diagram->pen(index));
+            const QBrush &brush = style.brush.value(index);
+            const QPen &pen = style.pen.value(index);
 
-            // line goes from lineInfo.value to lineInfo.nextValue
+            // each segment goes from run.points[i] to run.points[i + 1]
             // We don't want it added if we're not drawing it, since the reverse mapper is used
             // for lookup when trying to find e.g. tooltips. Having the line added when invisible gives
             // us tooltips in empty areas.
-            if (pen.style() != Qt::NoPen)
-                diagramPrivate->reverseMapper.addLine(lineInfo.index.row(), lineInfo.index.column(),
-                                                      lineInfo.value, lineInfo.nextValue);
+            if (pen.style() != Qt::NoPen && diagramPrivate->reverseMapper.isEnabled()) {
+                for (int i = 0; i < run.rows.count(); ++i) {
+                    diagramPrivate->reverseMapper.addLine(run.rows.at(i), index.column(),
+                                                          run.points.at(i), run.points.at(i + 1));
+                }
+            }
 
-            if (points.count() && points.last() == lineInfo.value && curBrush == brush && curPen == pen) {
+            if (points.count() && points.last() == run.points.first() && curBrush == brush && curPen == pen) {
                 // continue the current run of lines
+                points.reserve(points.count() + run.points.count() - 1);
+                for (int i = 1; i < run.points.count(); ++i) {
+                    points << run.points.at(i);
+                }
             } else {
                 // different painter settings or discontinuous line: start a new run of lines
                 if (points.count()) {
@@ -284,10 +293,8 @@ void paintElements(AbstractDiagram::Private *diagramPrivate, PaintContext *ctx,
                 }
                 curBrush = brush;
                 curPen = pen;
-                points.clear();
-                points << lineInfo.value;
+                points = run.points;
             }
-            points << lineInfo.nextValue;
         }
     }
     if (points.count()) {
@@ -295,10 +302,12 @@ void paintElements(AbstractDiagram::Private *diagramPrivate, PaintContext *ctx,
         paintObject(diagramPrivate, ctx, curBrush, curPen, points);
     }
 
-    for (const LineAttributesInfo &lineInfo : lineList) {
-        const ValueTrackerAttributes vt = valueTrackerAttributes(diagram, lineInfo.index);
+    for (const LineBatch::Run &run : lines.runs()) {
+        const ValueTrackerAttributes &vt = style.valueTrackerAttributes.value(run.index);
         if (vt.isEnabled()) {
-            PaintingHelpers::paintValueTracker(ctx, vt, lineInfo.nextValue);
+            for (int i = 1; i < run.points.count(); ++i) {
+                PaintingHelpers::paintValueTracker(ctx, vt, run.points.at(i));
+            }
         }
     }
 
@@ -306,27 +315,20 @@ void paintElements(AbstractDiagram::Private *diagramPrivate, PaintContext *ctx,
     diagramPrivate->paintDataValueTextsAndMarkers(ctx, lpc, true);
 }
 
-void paintAreas(AbstractDiagram::Private *diagramPrivate, PaintContext *ctx, const QModelIndex &index,
-                const QList<QPolygonF> &areas, uint opacity)
+static void fillArea(AbstractDiagram::Private *diagramPrivate, PaintContext *ctx, const QModelIndex &index,
+                     const QPainterPath &path, uint opacity)
 {
     AbstractDiagram *diagram = diagramPrivate->diagram;
-    QPainterPath path;
-    for (int i = 0; i < areas.count(); ++i) {
-        const QPolygonF &p = areas[i];
-        path.addPolygon(p);
-        diagramPrivate->reverseMapper.addPolygon(index.row(), index.column(), p);
-        path.closeSubpath();
-    }
-
-    ThreeDLineAttributes threeDAttrs = threeDLineAttributes(diagram, index);
-    QBrush trans = diagram->brush(index);
+    const StyleSnapshot &style = diagramPrivate->styleSnapshot;
+    const ThreeDLineAttributes &threeDAttrs = style.threeDLineAttributes.value(index);
+    QBrush trans = style.brush.value(index);
     if (threeDAttrs.isEnabled()) {
         trans = threeDAttrs.threeDBrush(trans, path.boundingRect());
     }
     QColor transColor = trans.color();
     transColor.setAlpha(opacity);
     trans.setColor(transColor);
-    QPen indexPen = diagram->pen(index);
+    QPen indexPen = style.pen.value(index);
     indexPen.setBrush(trans);
     const PainterSaver painterSaver(ctx->painter());
 
@@ -337,6 +339,71 @@ void paintAreas(AbstractDiagram::Private *diagramPrivate, PaintContext *ctx, con
     ctx->painter()->drawPath(path);
 }
 
+void paintAreas(AbstractDiagram::Private *diagramPrivate, PaintContext *ctx, const QModelIndex &index,
+                const QList<QPolygonF> &areas, uint opacity)
+{
+    QPainterPath path;
+    for (int i = 0; i < areas.count(); ++i) {
+        const QPolygonF &p = areas[i];
+        path.addPolygon(p);
+        diagramPrivate->reverseMapper.addPolygon(index.row(), index.column(), p);
+        path.closeSubpath();
+    }
+    fillArea(diagramPrivate, ctx, index, path, opacity);
+}
+
+AreaBatch::AreaBatch(AbstractDiagram::Private *diagramPrivate, PaintContext *ctx)
+    : m_diagramPrivate(diagramPrivate)
+    , m_ctx(ctx)
+{
+}
+
+void AreaBatch::addArea(const QModelIndex &index, const QPointF &a, const QPointF &b,
+                        const QPointF &c, const QPointF &d, uint opacity)
+{
+    if (m_diagramPrivate->reverseMapper.isEnabled()) {
+        m_diagramPrivate->reverseMapper.addPolygon(index.row(), index.column(), QPolygonF() << a << b << d << c);
+    }
+
+    // 3D areas get a gradient across their bounding rect, so they are not joined
+    const StyleSnapshot &style = m_diagramPrivate->styleSnapshot;
+    const bool uniform = style.hasUniformLines(index.column()) && !style.threeDLineAttributes.value(index).isEnabled();
+    const bool continues = uniform && m_uniform && index.column() == m_index.column() && opacity == m_opacity
+        && m_upper.last() == a && m_lower.last() == c;
+    if (!continues) {
+        flush();
+        m_index = index;
+        m_opacity = opacity;
+        m_uniform = uniform;
+        m_upper << a;
+        m_lower << c;
+    }
+    m_upper << b;
+    m_lower << d;
+}
+
+void AreaBatch::flush()
+{
+    if (m_upper.isEmpty()) {
+        return;
+    }
+    // along the line and back along the baseline
+    QPolygonF polygon;
+    polygon.reserve(m_upper.count() + m_lower.count());
+    polygon << m_upper;
+    for (int i = m_lower.count() - 1; i >= 0; --i) {
+        polygon << m_lower.at(i);
+    }
+    QPainterPath path;
+    path.addPolygon(polygon);
+    path.closeSubpath();
+    fillArea(m_diagramPrivate, m_ctx, m_index, path, m_opacity);
+
+    m_upper.clear();
+    m_lower.clear();
+    m_uniform = false;
+}
+
 void paintAreas(AbstractDiagram::Private *diagramPrivate, PaintContext *ctx, const QModelIndex &index,
                 const QList<QPainterPath> &areas, uint opacity)
 {
@@ -347,11 +414,12 @@ void paintAreas(AbstractDiagram::Private *diagramPrivate, PaintContext *ctx, con
         // diagramPrivate->reverseMapper.addPolygon( index.row(), index.column(), p );
     }
 
-    QBrush trans = diagram->brush(index);
+    const StyleSnapshot &style = diagramPrivate->styleSnapshot;
+    QBrush trans = style.brush.value(index);
     QColor transColor = trans.color();
     transColor.setAlpha(opacity);
     trans.setColor(transColor);
-    QPen indexPen = diagram->pen(index);
+    QPen indexPen = style.pen.value(index);
     indexPen.setBrush(trans);
     const PainterSaver painterSaver(ctx->painter());
 
@@ -14,25 +14,87 @@
 #include "KDChartAbstractDiagram_p.h"
 #include <KDABLibFakes>
 
+#include <QModelIndex>
 #include <QPointF>
+#include <QPolygonF>
 #include <QVector>
 
 QT_BEGIN_NAMESPACE
 class QBrush;
-class QModelIndex;
 class QPen;
-class QPolygonF;
 QT_END_NAMESPACE
 
 namespace KDChart {
 
-class LineAttributesInfo;
-typedef QVector<LineAttributesInfo> LineAttributesInfoList;
 class ThreeDLineAttributes;
 class ValueTrackerAttributes;
 
 namespace PaintingHelpers {
 
+/**
+ * The lines of a diagram, collected for paintElements().
+ *
+ * Segments that continue a line of a dataset whose cells all share the same
+ * style are appended to one polyline for the whole run. Segments of datasets
+ * with per-cell attributes stay single segments.
+ */
+class LineBatch
+{
+public:
+    struct Run
+    {
+        // the cell of the first segment, which holds the style of the whole run
+        QModelIndex index;
+        QPolygonF points;
+        // the row of the cell of each segment
+        QVector<int> rows;
+        bool uniform = false;
+    };
+
+    explicit LineBatch(AbstractDiagram::Private *diagramPrivate);
+
+    void addLine(const QModelIndex &index, const QPointF &from, const QPointF &to);
+
+    const QVector<Run> &runs() const
+    {
+        return m_runs;
+    }
+
+private:
+    const StyleSnapshot *m_style;
+    QVector<Run> m_runs;
+};
+
+/**
+ * The area fills below the lines of a diagram, painted in runs.
+ *
+ * The bands below consecutive segments of a dataset whose cells all share the
+ * same style are joined into one polygon that is filled with a single draw
+ * call. Call flush() to paint the current run, at the latest before the areas
+ * of the next dataset are added.
+ */
+class AreaBatch
+{
+public:
+    AreaBatch(AbstractDiagram::Private *diagramPrivate, PaintContext *ctx);
+
+    // adds the band between the line from a to b and the baseline from c to d,
+    // painted in the style of the cell at index
+    void addArea(const QModelIndex &index, const QPointF &a, const QPointF &b,
+                 const QPointF &c, const QPointF &d, uint opacity);
+    void flush();
+
+private:
+    AbstractDiagram::Private *m_diagramPrivate;
+    PaintContext *m_ctx;
+    QModelIndex m_index;
+    uint m_opacity = 0;
+    bool m_uniform = false;
+    // the points of the line and of the baseline of the current run, both from left to right
+    QPolygonF m_upper;
+    QPolygonF m_lower;
+};
+
 inline bool isFinite(const QPointF &point)
 {
     return !ISINF(point.x()) && !ISNAN(point.x()) && !ISINF(point.y()) && !ISNAN(point.y());
@@ -40,12 +102,11 @@ inline bool isFinite(const QPointF &point)
 
 const QPointF project(const QPointF &point, const ThreeDLineAttributes &tdAttributes);
 void paintPolyline(PaintContext *ctx, const QBrush &brush, const QPen &pen, const QPolygonF &points);
-void paintThreeDLines(PaintContext *ctx, AbstractDiagram *diagram, const QModelIndex &index,
-                      const QPointF &from, const QPointF &to, const ThreeDLineAttributes &tdAttributes,
-                      ReverseMapper *reverseMapper);
+void paintThreeDLines(AbstractDiagram::Private *diagramPrivate, PaintContext *ctx, const QModelIndex &index,
+                      const QPointF &from, const QPointF &to, const ThreeDLineAttributes &tdAttributes);
 void paintValueTracker(PaintContext *ctx, const ValueTrackerAttributes &vt, const QPointF &at);
 void paintElements(AbstractDiagram::Private *diagramPrivate, PaintContext *ctx,
-                   const LabelPaintCache &lpc, const LineAttributesInfoList &lineList);
+                   const LabelPaintCache &lpc, const LineBatch &lines);
 void paintAreas(AbstractDiagram::Private *diagramPrivate, PaintContext *ctx, const QModelIndex &index,
                 const QList<QPolygonF> &areas, uint opacity);
 
@@ -104,8 +104,10 @@ void AbstractArea::paintAll(QPainter &painter)
     // Paint the background and frame
     const QRect overlappingArea(geometry().adjusted(-d->amountOfLeftOverlap, -d->amountOfTopOverlap,
                                                     d->amountOfRightOverlap, d->amountOfBottomOverlap));
-    paintBackground(painter, overlappingArea);
-    paintFrame(painter, overlappingArea);
+    if (d->paintLayers & Private::BackdropLayer) {
+        paintBackground(painter, overlappingArea);
+        paintFrame(painter, overlappingArea);
+    }
 
     // temporarily adjust the widget size, to be sure all content gets calculated
     // to fit into the inner rectangle
@@ -43,6 +43,22 @@ class AbstractArea::Private : public AbstractAreaBase::Private
 public:
     explicit Private();
     ~Private() override;
+
+    static Private *get(AbstractArea *area)
+    {
+        return area->d_func();
+    }
+
+    enum PaintLayer
+    {
+        BackdropLayer = 0x1,
+        ContentLayer = 0x2,
+        AllLayers = BackdropLayer | ContentLayer
+    };
+
+    // The layers paintAll() draws. The background and frame belong to the backdrop,
+    // the rest is up to paint(); see Chart::setLayeredRenderingEnabled().
+    int paintLayers = AllLayers;
 };
 
 inline AbstractArea::AbstractArea(Private *p)
@@ -62,8 +62,9 @@ void AbstractCoordinatePlane::addDiagram(AbstractDiagram *diagram)
     layoutDiagrams();
     layoutPlanes(); // there might be new axes, etc
     connect(diagram, &AbstractDiagram::modelsChanged, this, &AbstractCoordinatePlane::layoutPlanes);
-    connect(diagram, &AbstractDiagram::modelDataChanged, this, &AbstractCoordinatePlane::update);
-    connect(diagram, &AbstractDiagram::modelDataChanged, this, &AbstractCoordinatePlane::relayout);
+    connect(diagram, &AbstractDiagram::modelDataChanged, this, [this]() {
+        d->diagramDataChanged(this);
+    });
     connect(this, &AbstractCoordinatePlane::boundariesChanged, diagram, &AbstractDiagram::boundariesChanged);
 
     update();
@@ -100,8 +101,7 @@ void AbstractCoordinatePlane::takeDiagram(AbstractDiagram *diagram)
         diagram->setParent(nullptr);
         diagram->setCoordinatePlane(nullptr);
         disconnect(diagram, &AbstractDiagram::modelsChanged, this, &AbstractCoordinatePlane::layoutPlanes);
-        disconnect(diagram, &AbstractDiagram::modelDataChanged, this, &AbstractCoordinatePlane::update);
-        disconnect(diagram, &AbstractDiagram::modelDataChanged, this, &AbstractCoordinatePlane::relayout);
+        disconnect(diagram, &AbstractDiagram::modelDataChanged, this, nullptr);
         layoutDiagrams();
         update();
     }
@@ -137,6 +137,7 @@ void KDChart::AbstractCoordinatePlane::setGlobalGridAttributes(const GridAttribu
 {
     d->gridAttributes = a;
     update();
+    Q_EMIT propertiesChanged();
 }
 
 GridAttributes KDChart::AbstractCoordinatePlane::globalGridAttributes() const
@@ -146,6 +147,8 @@ GridAttributes KDChart::AbstractCoordinatePlane::globalGridAttributes() const
 
 KDChart::DataDimensionsList KDChart::AbstractCoordinatePlane::gridDimensionsList()
 {
+    // pending data changes may change the ranges
+    d->flushDataUpdate(this);
     return d->grid->updateData(this);
 }
 
@@ -67,6 +67,40 @@ protected:
         return true;
     }
 
+public:
+    static Private *get(AbstractCoordinatePlane *plane)
+    {
+        return plane->d_func();
+    }
+
+    // The model data of a diagram in the plane changed
+    virtual void diagramDataChanged(AbstractCoordinatePlane *plane)
+    {
+        plane->update();
+        plane->relayout();
+    }
+
+    // A diagram tells that the last data change only affects rect, as long as the
+    // data ranges stay the same. Planes that can not make use of this ignore it.
+    virtual void updateData(AbstractCoordinatePlane *plane, const QRectF &rect)
+    {
+        Q_UNUSED(plane);
+        Q_UNUSED(rect);
+    }
+
+    // Carries out data updates that were postponed to the event loop right away
+    virtual void flushDataUpdate(AbstractCoordinatePlane *plane)
+    {
+        Q_UNUSED(plane);
+    }
+
+    // Whether there are data updates that flushDataUpdate() would carry out
+    virtual bool hasPendingDataUpdate() const
+    {
+        return false;
+    }
+
+protected:
     KDChart::Chart *parent = nullptr;
     AbstractGrid *grid = nullptr;
     QRect geometry;
@@ -18,6 +18,7 @@
 #include <QSizeF>
 
 #include "KDChartAbstractCoordinatePlane.h"
+#include "KDChartAbstractCoordinatePlane_p.h"
 #include "KDChartAbstractThreeDAttributes.h"
 #include "KDChartChart.h"
 #include "KDChartDataValueAttributes.h"
@@ -73,7 +74,7 @@ bool AbstractDiagram::compare(const AbstractDiagram *other) const
         // compare all of the properties stored in the attributes model
         attributesModel()->compare(other->attributesModel()) &&
         // compare own properties
-        (rootIndex().column() == other->rootIndex().column()) && (rootIndex().row() == other->rootIndex().row()) && (allowOverlappingDataValueTexts() == other->allowOverlappingDataValueTexts()) && (antiAliasing() == other->antiAliasing()) && (percentMode() == other->percentMode()) && (datasetDimension() == other->datasetDimension());
+        (rootIndex().column() == other->rootIndex().column()) && (rootIndex().row() == other->rootIndex().row()) && (allowOverlappingDataValueTexts() == other->allowOverlappingDataValueTexts()) && (fastDataValueTextOverlapTest() == other->fastDataValueTextOverlapTest()) && (antiAliasing() == other->antiAliasing()) && (percentMode() == other->percentMode()) && (datasetDimension() == other->datasetDimension());
 }
 
 AbstractCoordinatePlane *AbstractDiagram::coordinatePlane() const
@@ -218,9 +219,15 @@ void AbstractDiagram::dataChanged(const QModelIndex &topLeft,
                                   const QModelIndex &bottomRight,
                                   const QVector<int> &)
 {
-    Q_UNUSED(topLeft);
-    Q_UNUSED(bottomRight);
-    // We are still too dumb to do intelligent updates...
+    // Where the changed data is painted depends on the plane's layout, which may change
+    // with the data ranges. The plane finds out before repainting just that part.
+    const bool inDiagram = d->plane && topLeft.parent() == rootIndex();
+    const QRectF rect = inDiagram ? d->dataChangedRect(topLeft, bottomRight) : QRectF();
+    if (!rect.isNull()) {
+        d->databoundariesDirty = true;
+        AbstractCoordinatePlane::Private::get(d->plane)->updateData(d->plane, rect);
+        return;
+    }
     setDataBoundariesDirty();
     scheduleDelayedItemsLayout();
 }
@@ -311,10 +318,7 @@ DataValueAttributes AbstractDiagram::dataValueAttributes(int dataset) const
 
 DataValueAttributes AbstractDiagram::dataValueAttributes(const QModelIndex &index) const
 {
-    return attributesModel()->data(
-                                conditionallyMapFromSource(index),
-                                KDChart::DataValueLabelAttributesRole)
-        .value<DataValueAttributes>();
+    return attributesModel()->attribute<DataValueAttributes>(conditionallyMapFromSource(index), KDChart::DataValueLabelAttributesRole);
 }
 
 void AbstractDiagram::setDataValueAttributes(const DataValueAttributes &a)
@@ -337,6 +341,17 @@ bool AbstractDiagram::allowOverlappingDataValueTexts() const
     return d->allowOverlappingDataValueTexts;
 }
 
+void AbstractDiagram::setFastDataValueTextOverlapTest(bool fast)
+{
+    d->fastDataValueTextOverlapTest = fast;
+    Q_EMIT propertiesChanged();
+}
+
+bool AbstractDiagram::fastDataValueTextOverlapTest() const
+{
+    return d->fastDataValueTextOverlapTest;
+}
+
 void AbstractDiagram::setAntiAliasing(bool enabled)
 {
     d->antiAliasing = enabled;
@@ -348,6 +363,23 @@ bool AbstractDiagram::antiAliasing() const
     return d->antiAliasing;
 }
 
+void AbstractDiagram::setHitTestingEnabled(bool enabled)
+{
+    if (enabled == d->reverseMapper.isEnabled()) {
+        return;
+    }
+    d->reverseMapper.setEnabled(enabled);
+    // the positions of the data points are recorded by the next paint
+    if (enabled) {
+        Q_EMIT propertiesChanged();
+    }
+}
+
+bool AbstractDiagram::isHitTestingEnabled() const
+{
+    return d->reverseMapper.isEnabled();
+}
+
 void AbstractDiagram::setPercentMode(bool percent)
 {
     d->percent = percent;
@@ -445,6 +477,8 @@ void AbstractDiagram::paintMarker(QPainter *painter,
     const bool isFourPixels = (markerAttributes.markerStyle() == MarkerAttributes::Marker4Pixels);
     if (isFourPixels || (markerAttributes.markerStyle() == MarkerAttributes::Marker1Pixel)) {
         // for high-performance point charts with tiny point markers:
+        // keep the order of the markers painted before this one from sprites
+        d->markerSprites.paintPending(painter);
         painter->setPen(PrintingParameters::scalePen(QPen(brush.color().lighter())));
         if (isFourPixels) {
             const qreal x = pos.x();
@@ -457,118 +491,11 @@ void AbstractDiagram::paintMarker(QPainter *painter,
                               QPointF(x + 1.0, y + 1.0));
         }
         painter->drawPoint(pos);
-    } else {
+    } else if (!d->markerSprites.paint(painter, markerAttributes, brush, pen, pos, maSize)) {
+        // printers and other vector devices get the exact shape
         const PainterSaver painterSaver(painter);
-        QPen painterPen(pen);
-        painter->setPen(PrintingParameters::scalePen(painterPen));
-        painter->setBrush(brush);
-        painter->setRenderHint(QPainter::Antialiasing);
         painter->translate(pos);
-        switch (markerAttributes.markerStyle()) {
-        case MarkerAttributes::MarkerCircle: {
-            if (markerAttributes.threeD()) {
-                QRadialGradient grad;
-                grad.setCoordinateMode(QGradient::ObjectBoundingMode);
-                QColor drawColor = brush.color();
-                grad.setCenter(0.5, 0.5);
-                grad.setRadius(1.0);
-                grad.setFocalPoint(0.35, 0.35);
-                grad.setColorAt(0.00, drawColor.lighter(150));
-                grad.setColorAt(0.20, drawColor);
-                grad.setColorAt(0.50, drawColor.darker(150));
-                grad.setColorAt(0.75, drawColor.darker(200));
-                grad.setColorAt(0.95, drawColor.darker(250));
-                grad.setColorAt(1.00, drawColor.darker(200));
-                QBrush newBrush(grad);
-                newBrush.setTransform(brush.transform());
-                painter->setBrush(newBrush);
-            }
-            painter->drawEllipse(QRectF(0 - maSize.height() / 2, 0 - maSize.width() / 2,
-                                        maSize.height(), maSize.width()));
-        } break;
-        case MarkerAttributes::MarkerSquare: {
-            QRectF rect(0 - maSize.width() / 2, 0 - maSize.height() / 2,
-                        maSize.width(), maSize.height());
-            painter->drawRect(rect);
-            break;
-        }
-        case MarkerAttributes::MarkerDiamond: {
-            QVector<QPointF> diamondPoints;
-            QPointF top, left, bottom, right;
-            top = QPointF(0, 0 - maSize.height() / 2);
-            left = QPointF(0 - maSize.width() / 2, 0);
-            bottom = QPointF(0, maSize.height() / 2);
-            right = QPointF(maSize.width() / 2, 0);
-            diamondPoints << top << left << bottom << right;
-            painter->drawPolygon(diamondPoints);
-            break;
-        }
-        // both handled on top of the method:
-        case MarkerAttributes::Marker1Pixel:
-        case MarkerAttributes::Marker4Pixels:
-            break;
-        case MarkerAttributes::MarkerRing: {
-            painter->setBrush(Qt::NoBrush);
-            painter->setPen(PrintingParameters::scalePen(QPen(brush.color())));
-            painter->drawEllipse(QRectF(0 - maSize.height() / 2, 0 - maSize.width() / 2,
-                                        maSize.height(), maSize.width()));
-            break;
-        }
-        case MarkerAttributes::MarkerCross: {
-            // Note: Markers can have outline,
-            //       so just drawing two rects is NOT the solution here!
-            const qreal w02 = maSize.width() * 0.2;
-            const qreal w05 = maSize.width() * 0.5;
-            const qreal h02 = maSize.height() * 0.2;
-            const qreal h05 = maSize.height() * 0.5;
-            QVector<QPointF> crossPoints;
-            QPointF p[12];
-            p[0] = QPointF(-w02, -h05);
-            p[1] = QPointF(w02, -h05);
-            p[2] = QPointF(w02, -h02);
-            p[3] = QPointF(w05, -h02);
-            p[4] = QPointF(w05, h02);
-            p[5] = QPointF(w02, h02);
-            p[6] = QPointF(w02, h05);
-            p[7] = QPointF(-w02, h05);
-            p[8] = QPointF(-w02, h02);
-            p[9] = QPointF(-w05, h02);
-            p[10] = QPointF(-w05, -h02);
-            p[11] = QPointF(-w02, -h02);
-            for (int i = 0; i < 12; ++i)
-                crossPoints << p[i];
-            crossPoints << p[0];
-            painter->drawPolygon(crossPoints);
-            break;
-        }
-        case MarkerAttributes::MarkerFastCross: {
-            QPointF left, right, top, bottom;
-            left = QPointF(-maSize.width() / 2, 0);
-            right = QPointF(maSize.width() / 2, 0);
-            top = QPointF(0, -maSize.height() / 2);
-            bottom = QPointF(0, maSize.height() / 2);
-            painter->setPen(PrintingParameters::scalePen(QPen(brush.color())));
-            painter->drawLine(left, right);
-            painter->drawLine(top, bottom);
-            break;
-        }
-        case MarkerAttributes::NoMarker:
-            break;
-        case MarkerAttributes::PainterPathMarker: {
-            QPainterPath path = markerAttributes.customMarkerPath();
-            const QRectF pathBoundingRect = path.boundingRect();
-            const qreal xScaling = maSize.height() / pathBoundingRect.height();
-            const qreal yScaling = maSize.width() / pathBoundingRect.width();
-            const qreal scaling = qMin(xScaling, yScaling);
-            painter->scale(scaling, scaling);
-            painter->setPen(PrintingParameters::scalePen(QPen(brush.color())));
-            painter->drawPath(path);
-            break;
-        }
-        default:
-            Q_ASSERT_X(false, "paintMarkers()",
-                       "Type item does not match a defined Marker Type.");
-        }
+        MarkerSprites::paintShape(painter, markerAttributes, brush, pen, maSize);
     }
     painter->setPen(oldPen);
 }
@@ -634,10 +561,7 @@ QPen AbstractDiagram::pen(int dataset) const
 
 QPen AbstractDiagram::pen(const QModelIndex &index) const
 {
-    return attributesModel()->data(
-                                conditionallyMapFromSource(index),
-                                DatasetPenRole)
-        .value<QPen>();
+    return attributesModel()->attribute<QPen>(conditionallyMapFromSource(index), DatasetPenRole);
 }
 
 void AbstractDiagram::setBrush(const QModelIndex &index, const QBrush &brush)
@@ -676,7 +600,7 @@ QBrush AbstractDiagram::brush(int dataset) const
 
 QBrush AbstractDiagram::brush(const QModelIndex &index) const
 {
-    return attributesModel()->data(conditionallyMapFromSource(index), DatasetBrushRole).value<QBrush>();
+    return attributesModel()->attribute<QBrush>(conditionallyMapFromSource(index), DatasetBrushRole);
 }
 
 /**
@@ -469,6 +469,23 @@ public:
      */
     bool allowOverlappingDataValueTexts() const;
 
+    /**
+     * Set whether unrotated data value labels are tested for overlapping
+     * each other by their bounding rectangles only.
+     *
+     * By default each label is tested as a path, which is exact for rotated
+     * labels too but slower. Rotated labels are always tested that way.
+     * @param fast True means that unrotated labels are compared by their rectangles.
+     * \sa setAllowOverlappingDataValueTexts
+     */
+    void setFastDataValueTextOverlapTest(bool fast);
+
+    /**
+     * @return Whether unrotated data value labels are tested for overlapping
+     * by their bounding rectangles only.
+     */
+    bool fastDataValueTextOverlapTest() const;
+
     /**
      * Set whether anti-aliasing is to be used while rendering
      * this diagram.
@@ -482,6 +499,27 @@ public:
      */
     bool antiAliasing() const;
 
+    /**
+     * Set whether painting this diagram records where its data points
+     * are drawn, which indexAt(), indexesAt(), visualRect() and
+     * visualRegion() need to find them.
+     *
+     * The lookup structure itself is only built on the first such call
+     * after the diagram was painted. Disabling hit testing also skips the
+     * recording, which saves time and memory for diagrams that are never
+     * clicked or hovered, such as in batch rendering or non-interactive
+     * dashboards. While it is disabled, no data points are found.
+     *
+     * Hit testing is enabled by default.
+     * @param enabled True means that data points can be found by position.
+     */
+    void setHitTestingEnabled(bool enabled);
+
+    /**
+     * @return Whether data points of this diagram can be found by position.
+     */
+    bool isHitTestingEnabled() const;
+
     /**
      * Set the palette to be used, for painting datasets to the default
      * palette.
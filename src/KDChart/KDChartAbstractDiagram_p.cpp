@@ -25,9 +25,7 @@
 #include "KDChartFrameAttributes.h"
 #include "KDChartPainterSaver_p.h"
 
-#include <QAbstractTextDocumentLayout>
 #include <QApplication>
-#include <QTextBlock>
 
 #include <KDABLibFakes>
 
@@ -139,6 +137,7 @@ AbstractDiagram::Private::Private(const AbstractDiagram::Private &rhs)
     , attributesModelRootIndex(QModelIndex())
     , attributesModel(rhs.attributesModel)
     , allowOverlappingDataValueTexts(rhs.allowOverlappingDataValueTexts)
+    , fastDataValueTextOverlapTest(rhs.fastDataValueTextOverlapTest)
     , antiAliasing(rhs.antiAliasing)
     , percent(rhs.percent)
     , datasetDimension(rhs.datasetDimension)
@@ -146,6 +145,7 @@ AbstractDiagram::Private::Private(const AbstractDiagram::Private &rhs)
 {
     attributesModel = new PrivateAttributesModel(nullptr, nullptr);
     attributesModel->initFrom(rhs.attributesModel);
+    reverseMapper.setEnabled(rhs.reverseMapper.isEnabled());
 }
 
 // FIXME: Optimize if necessary
@@ -219,18 +219,10 @@ void AbstractDiagram::Private::addLabel(
 
         // get the size of the label text using a subset of the information going into the final layout
         const QString text = formatDataValueText(dva, index, value);
-        QTextDocument doc;
-        doc.setDocumentMargin(0);
-        if (Qt::mightBeRichText(text)) {
-            doc.setHtml(text);
-        } else {
-            doc.setPlainText(text);
-        }
         const QFont calculatedFont(dva.textAttributes()
                                        .calculatedFont(plane, KDChartEnums::MeasureOrientationMinimum));
-        doc.setDefaultFont(calculatedFont);
 
-        const QRectF plainRect = doc.documentLayout()->frameBoundingRect(doc.rootFrame());
+        const QRectF plainRect(QPointF(0.0, 0.0), labelTextCache.layout(text, calculatedFont).size);
 
         /**
          * A few hints on how the positioning of the text frame is done:
@@ -331,24 +323,7 @@ const QFontMetrics AbstractDiagram::Private::cachedFontMetrics() const
 
 QString AbstractDiagram::Private::formatNumber(qreal value, int decimalDigits) const
 {
-    const int digits = qMax(decimalDigits, 0);
-    const qreal roundingEpsilon = pow(0.1, digits) * (value >= 0.0 ? 0.5 : -0.5);
-    QString asString = QString::number(value + roundingEpsilon, 'f');
-    const int decimalPos = asString.indexOf(QLatin1Char('.'));
-    if (decimalPos < 0) {
-        return asString;
-    }
-
-    int last = qMin(decimalPos + digits, asString.length() - 1);
-    // remove trailing zeros (and maybe decimal dot)
-    while (last > decimalPos && asString[last] == QLatin1Char('0')) {
-        last--;
-    }
-    if (last == decimalPos) {
-        last--;
-    }
-    asString.chop(asString.length() - last - 1);
-    return asString;
+    return mNumberFormatter.rounded(value, decimalDigits);
 }
 
 void AbstractDiagram::Private::forgetAlreadyPaintedDataValues()
@@ -372,9 +347,11 @@ void AbstractDiagram::Private::paintDataValueTextsAndMarkers(
     ctx->painter()->setClipping(false);
 
     if (paintMarkers && !justCalculateRect) {
+        markerSprites.beginBatch();
         for (const LabelPaintInfo &info : std::as_const(cache.paintReplay)) {
             diagram->paintMarker(ctx->painter(), info.index, info.markerPos);
         }
+        markerSprites.flush(ctx->painter());
     }
 
     TextAttributes ta;
@@ -472,27 +449,12 @@ void AbstractDiagram::Private::paintDataValueText(
     }
     prevPaintedDataValueText = text;
 
-    QTextDocument doc;
-    doc.setDocumentMargin(0.0);
-    if (Qt::mightBeRichText(text)) {
-        doc.setHtml(text);
-    } else {
-        doc.setPlainText(text);
-    }
-
     const QFont calculatedFont(ta.calculatedFont(plane, KDChartEnums::MeasureOrientationMinimum));
+    const QRectF rect(QPointF(0.0, 0.0), labelTextCache.layout(text, calculatedFont, painter->device()).size);
 
     const PainterSaver painterSaver(painter);
     painter->setPen(PrintingParameters::scalePen(ta.pen()));
 
-    doc.setDefaultFont(calculatedFont);
-    QAbstractTextDocumentLayout::PaintContext context;
-    context.palette = diagram->palette();
-    context.palette.setColor(QPalette::Text, ta.pen().color());
-
-    QAbstractTextDocumentLayout *const layout = doc.documentLayout();
-    layout->setPaintDevice(painter->device());
-
     painter->translate(pos.x(), pos.y());
     int rotation = ta.rotation();
     if (!valueIsPositive && attrs.mirrorNegativeValueTextRotation()) {
@@ -509,29 +471,13 @@ void AbstractDiagram::Private::paintDataValueText(
     // values that she wants to have written in any case - so we just
     // do not test if such texts would cover some of the others.
     if (!attrs.showOverlappingDataLabels()) {
-        const QRectF br(layout->frameBoundingRect(doc.rootFrame()));
-        QPolygon pr = transform.mapToPolygon(br.toRect());
-        // Using QPainterPath allows us to use intersects() (which has many early-exits)
-        // instead of QPolygon::intersected (which calculates a slow and precise intersection polygon)
-        QPainterPath path;
-        path.addPolygon(pr);
-
-        // iterate backwards because recently added items are more likely to overlap, so we spend
-        // less time checking irrelevant items when there is overlap
-        for (int i = alreadyDrawnDataValueTexts.count() - 1; i >= 0; i--) {
-            if (alreadyDrawnDataValueTexts.at(i).intersects(path)) {
-                // qDebug() << "not painting this label due to overlap";
-                drawIt = false;
-                break;
-            }
-        }
-        if (drawIt) {
-            alreadyDrawnDataValueTexts << path;
-        }
+        const QPolygon pr = transform.mapToPolygon(rect.toRect());
+        // without rotation or shearing the label stays an axis parallel rect
+        const bool isRect = fastDataValueTextOverlapTest && transform.type() <= QTransform::TxScale;
+        drawIt = alreadyDrawnDataValueTexts.addIfFree(QPolygonF(pr), isRect);
     }
 
     if (drawIt) {
-        QRectF rect = layout->frameBoundingRect(doc.rootFrame());
         if (cumulatedBoundingRect) {
             (*cumulatedBoundingRect) |= transform.mapRect(rect);
         }
@@ -557,11 +503,20 @@ void AbstractDiagram::Private::paintDataValueText(
                 QRectF borderRect(QPointF(0, 0), rect.size());
                 painter->drawRoundedRect(borderRect, radius, radius);
             }
-            layout->draw(painter, context);
+            QPalette palette = diagram->palette();
+            palette.setColor(QPalette::Text, ta.pen().color());
+            labelTextCache.draw(painter, text, calculatedFont, palette);
         }
     }
 }
 
+QRectF AbstractDiagram::Private::dataChangedRect(const QModelIndex &topLeft, const QModelIndex &bottomRight) const
+{
+    Q_UNUSED(topLeft);
+    Q_UNUSED(bottomRight);
+    return QRectF();
+}
+
 QModelIndex AbstractDiagram::Private::indexAt(const QPoint &point) const
 {
     QModelIndexList l = indexesAt(point);
@@ -644,14 +599,3 @@ bool AbstractDiagram::Private::isTransposed() const
     }
     return barDiagram->orientation() == Qt::Horizontal;
 }
-
-LineAttributesInfo::LineAttributesInfo()
-{
-}
-
-LineAttributesInfo::LineAttributesInfo(const QModelIndex &_index, const QPointF &_value, const QPointF &_nextValue)
-    : index(_index)
-    , value(_value)
-    , nextValue(_nextValue)
-{
-}
@@ -27,10 +27,15 @@
 #include "KDChartBackgroundAttributes.h"
 #include "KDChartChart.h"
 #include "KDChartDataValueAttributes.h"
+#include "KDChartLabelOverlapGrid_p.h"
+#include "KDChartLabelTextCache_p.h"
+#include "KDChartMarkerSprites_p.h"
+#include "KDChartNumberFormatter_p.h"
 #include "KDChartPaintContext.h"
 #include "KDChartPosition.h"
 #include "KDChartPrintingParameters.h"
 #include "KDChartRelativePosition.h"
+#include "KDChartStyleSnapshot_p.h"
 #include "ReverseMapper.h"
 #include <KDChartCartesianDiagramDataCompressor_p.h>
 
@@ -150,6 +155,10 @@ public:
 
     virtual QModelIndex indexAt(const QPoint &point) const;
 
+    // The part of the plane to repaint after the data from topLeft to bottomRight changed,
+    // as long as the data ranges stay the same. A null rect if that is not known.
+    virtual QRectF dataChangedRect(const QModelIndex &topLeft, const QModelIndex &bottomRight) const;
+
     QModelIndexList indexesAt(const QPoint &point) const;
 
     QModelIndexList indexesIn(const QRect &rect) const;
@@ -186,6 +195,8 @@ public:
 
     AbstractDiagram *diagram = nullptr;
     ReverseMapper reverseMapper;
+    // pens, brushes and attributes of the current paint
+    StyleSnapshot styleSnapshot;
     bool doDumpPaintTime = false; // for use in performance testing code
 
 protected:
@@ -196,6 +207,7 @@ protected:
     mutable QModelIndex attributesModelRootIndex;
     QPointer<AttributesModel> attributesModel;
     bool allowOverlappingDataValueTexts = false;
+    bool fastDataValueTextOverlapTest = false;
     bool antiAliasing = true;
     bool percent = false;
     int datasetDimension = 1;
@@ -206,12 +218,15 @@ protected:
     QMap<Qt::Orientation, QString> unitPrefix;
     QMap<int, QMap<Qt::Orientation, QString>> unitSuffixMap;
     QMap<int, QMap<Qt::Orientation, QString>> unitPrefixMap;
-    QList<QPainterPath> alreadyDrawnDataValueTexts;
+    LabelOverlapGrid alreadyDrawnDataValueTexts;
+    LabelTextCache labelTextCache;
+    MarkerSprites markerSprites;
 
 private:
     QString prevPaintedDataValueText;
     mutable QFontMetrics mCachedFontMetrics;
     mutable QFont mCachedFont;
+    mutable NumberFormatter mNumberFormatter;
     mutable QPaintDevice *mCachedPaintDevice;
 };
 
@@ -228,19 +243,5 @@ inline AbstractDiagram::AbstractDiagram(
     _d->init(plane);
     init();
 }
-
-class LineAttributesInfo
-{
-public:
-    LineAttributesInfo();
-    LineAttributesInfo(const QModelIndex &_index, const QPointF &_value, const QPointF &_nextValue);
-
-    QModelIndex index;
-    QPointF value;
-    QPointF nextValue;
-};
-
-typedef QVector<LineAttributesInfo> LineAttributesInfoList;
-typedef QVectorIterator<LineAttributesInfo> LineAttributesInfoListIterator;
 }
 #endif /* KDCHARTDIAGRAM_P_H */
@@ -9,11 +9,16 @@
 ****************************************************************************/
 
 #include "KDChartAttributesModel.h"
+#include "KDChartColumnarDataSource_p.h"
 #include "KDChartGlobal.h"
 #include "KDChartPalette.h"
+#include "KDChartRingBufferModel.h"
 
+#include <QBitArray>
 #include <QDebug>
+#include <QHash>
 #include <QPen>
+#include <QPersistentModelIndex>
 #include <QPointer>
 
 #include <KDChartAbstractThreeDAttributes.h>
@@ -34,14 +39,174 @@
 
 #include <KDABLibFakes>
 
+#include <algorithm>
+#include <utility>
+
 using namespace KDChart;
 
+namespace {
+/**
+ * The attributes of one role that were set for single cells, stored sparsely:
+ * per column, the cells that have an attribute, sorted by row.
+ */
+class CellAttributes
+{
+public:
+    struct Cell
+    {
+        int row;
+        QVariant value;
+    };
+    using Column = QVector<Cell>;
+
+    const QVariant *find(int row, int column) const
+    {
+        if (column < 0 || column >= columns.size()) {
+            return nullptr;
+        }
+        const Column &cells = columns.at(column);
+        const auto it = lowerBound(cells, row);
+        if (it == cells.cend() || it->row != row) {
+            return nullptr;
+        }
+        return &it->value;
+    }
+
+    void set(int row, int column, const QVariant &value)
+    {
+        if (row < 0 || column < 0) {
+            return;
+        }
+        if (!value.isValid()) {
+            if (column < columns.size()) {
+                Column &cells = columns[column];
+                const auto it = lowerBound(cells, row);
+                if (it != cells.cend() && it->row == row) {
+                    cells.remove(it - cells.cbegin());
+                    --count;
+                }
+            }
+            return;
+        }
+        if (column >= columns.size()) {
+            columns.resize(column + 1);
+        }
+        Column &cells = columns[column];
+        const int position = lowerBound(cells, row) - cells.cbegin();
+        if (position < cells.size() && cells.at(position).row == row) {
+            cells[position].value = value;
+        } else {
+            cells.insert(position, Cell {row, value});
+            ++count;
+        }
+    }
+
+    void removeColumns(int start, int end)
+    {
+        if (start >= columns.size()) {
+            return;
+        }
+        end = qMin(end, int(columns.size()) - 1);
+        for (int column = start; column <= end; ++column) {
+            count -= columns.at(column).size();
+        }
+        columns.remove(start, end - start + 1);
+    }
+
+    QVector<Column> columns;
+    // the number of attributes
+    int count = 0;
+
+private:
+    static Column::const_iterator lowerBound(const Column &cells, int row)
+    {
+        return std::lower_bound(cells.cbegin(), cells.cend(), row,
+                                [](const Cell &cell, int row) { return cell.row < row; });
+    }
+};
+
+// the result of AttributesModel::data(column, role), once it is known
+struct ColumnAttribute
+{
+    QVariant value;
+    bool resolved = false;
+};
+
+// Columns with more rows are not searched for roles that the source model supplies, they
+// count as supplying them. Their cells are then looked up one by one, like the painting
+// of a diagram without a StyleSnapshot does, instead of reading the whole column up front.
+const int MaxSearchedRows = 1024;
+
+// which columns below one root of the source model supply a role for some of their cells
+struct SourceRoleColumns
+{
+    QBitArray searched;
+    QBitArray supplied;
+};
+
+// true if the source model supplies role for any of the rows [first, last] of column
+bool sourceRowsSupplyRole(const QAbstractItemModel *source, const QModelIndex &root,
+                          int column, int first, int last, int role)
+{
+    if (source->rowCount(root) > MaxSearchedRows) {
+        return true;
+    }
+    for (int row = first; row <= last; ++row) {
+        if (source->data(source->index(row, column, root), role).isValid()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Looks at the rows [firstRow, lastRow] of the searched columns in [firstColumn, lastColumn]
+// again, for the roles given or for all roles if roles is empty. Rows that stopped supplying
+// a role are only forgotten when the columns are searched again.
+void updateSourceRoleColumns(QHash<int, SourceRoleColumns> &roleColumns, const QAbstractItemModel *source,
+                             const QModelIndex &root, int firstColumn, int lastColumn, int firstRow,
+                             int lastRow, const QVector<int> &roles = QVector<int>())
+{
+    for (auto it = roleColumns.begin(); it != roleColumns.end(); ++it) {
+        if (!roles.isEmpty() && !roles.contains(it.key())) {
+            continue;
+        }
+        const int last = qMin(lastColumn, int(it->searched.size()) - 1);
+        for (int column = firstColumn; column <= last; ++column) {
+            if (it->searched.testBit(column) && !it->supplied.testBit(column)) {
+                it->supplied.setBit(column, sourceRowsSupplyRole(source, root, column, firstRow, lastRow, it.key()));
+            }
+        }
+    }
+}
+}
+
 class AttributesModel::Private
 {
 public:
     Private();
 
-    QMap<int, QMap<int, QMap<int, QVariant>>> dataMap;
+    // per role, the attributes set for single cells
+    QHash<int, CellAttributes> cellAttributes;
+    // per role and column, the dataset level attributes resolved so far;
+    // cleared whenever anything they depend on changes
+    mutable QHash<int, QVector<ColumnAttribute>> columnAttributes;
+    // per role, what sourceSuppliesRole() found for the top level so far; updated
+    // by changes of the source data and cleared by structural changes
+    mutable QHash<int, SourceRoleColumns> sourceRoleColumns;
+    // the same for the other roots of the source model, also cleared when rows are
+    // inserted or removed anywhere, which may move or invalidate the roots
+    mutable QHash<QPersistentModelIndex, QHash<int, SourceRoleColumns>> nestedSourceRoleColumns;
+
+    // the cache for sourceRoot, if there is one
+    QHash<int, SourceRoleColumns> *sourceRoleColumnsBelow(const QModelIndex &sourceRoot)
+    {
+        if (!sourceRoot.isValid()) {
+            return &sourceRoleColumns;
+        }
+        const auto it = nestedSourceRoleColumns.find(QPersistentModelIndex(sourceRoot));
+        return it == nestedSourceRoleColumns.end() ? nullptr : &it.value();
+    }
+
     QMap<int, QMap<int, QVariant>> horizontalHeaderDataMap;
     QMap<int, QMap<int, QVariant>> verticalHeaderDataMap;
     QMap<int, QVariant> modelDataMap;
@@ -76,6 +241,9 @@ AttributesModel::~AttributesModel()
 void AttributesModel::initFrom(const AttributesModel *other)
 {
     *d = *other->d;
+    d->columnAttributes.clear();
+    d->sourceRoleColumns.clear();
+    d->nestedSourceRoleColumns.clear();
 }
 
 bool AttributesModel::compareHeaderDataMaps(const QMap<int, QMap<int, QVariant>> &mapA,
@@ -114,28 +282,26 @@ bool AttributesModel::compare(const AttributesModel *other) const
     }
 
     {
-        if (d->dataMap.count() != other->d->dataMap.count()) {
-            return false;
-        }
-        QMap<int, QMap<int, QMap<int, QVariant>>>::const_iterator itA = d->dataMap.constBegin();
-        QMap<int, QMap<int, QMap<int, QVariant>>>::const_iterator itB = other->d->dataMap.constBegin();
-        for (; itA != d->dataMap.constEnd(); ++itA, ++itB) {
-            if (itA->count() != itB->count()) {
+        // roles whose attributes were all reset have no attributes at all
+        QList<int> roles = d->cellAttributes.keys() + other->d->cellAttributes.keys();
+        std::sort(roles.begin(), roles.end());
+        roles.erase(std::unique(roles.begin(), roles.end()), roles.end());
+        for (int role : std::as_const(roles)) {
+            const CellAttributes a = d->cellAttributes.value(role);
+            const CellAttributes b = other->d->cellAttributes.value(role);
+            if (a.count != b.count) {
                 return false;
             }
-            QMap<int, QMap<int, QVariant>>::const_iterator it2A = itA->constBegin();
-            QMap<int, QMap<int, QVariant>>::const_iterator it2B = itB->constBegin();
-            for (; it2A != itA->constEnd(); ++it2A, ++it2B) {
-                if (it2A->count() != it2B->count()) {
+            const int columns = qMax(a.columns.size(), b.columns.size());
+            for (int column = 0; column < columns; ++column) {
+                const CellAttributes::Column cellsA = a.columns.value(column);
+                const CellAttributes::Column cellsB = b.columns.value(column);
+                if (cellsA.size() != cellsB.size()) {
                     return false;
                 }
-                QMap<int, QVariant>::const_iterator it3A = it2A->constBegin();
-                QMap<int, QVariant>::const_iterator it3B = it2B->constBegin();
-                for (; it3A != it2A->constEnd(); ++it3A, ++it3B) {
-                    if (it3A.key() != it3B.key()) {
-                        return false;
-                    }
-                    if (!compareAttributes(it3A.key(), it3A.value(), it3B.value())) {
+                for (int i = 0; i < cellsA.size(); ++i) {
+                    if (cellsA.at(i).row != cellsB.at(i).row
+                        || !compareAttributes(role, cellsA.at(i).value, cellsB.at(i).value)) {
                         return false;
                     }
                 }
@@ -279,54 +445,155 @@ QVariant AttributesModel::data(int role) const
 
 QVariant AttributesModel::data(int column, int role) const
 {
-    if (isKnownAttributesRole(role)) {
-        // check if there is something set for the column (dataset)
-        QVariant v;
-        v = headerData(column, Qt::Horizontal, role);
+    QVariant buffer;
+    return *findColumnAttribute(column, role, &buffer);
+}
 
-        // check if there is something set at global level
-        if (!v.isValid())
-            v = data(role); // includes automatic fallback to default
-        return v;
+const QVariant *AttributesModel::findColumnAttribute(int column, int role, QVariant *buffer) const
+{
+    if (!isKnownAttributesRole(role)) {
+        *buffer = QVariant();
+        return buffer;
     }
-    return QVariant();
+
+    const int columns = columnCount(QModelIndex());
+    const bool cacheable = column >= 0 && column < columns;
+    if (cacheable) {
+        const auto it = d->columnAttributes.constFind(role);
+        if (it != d->columnAttributes.constEnd() && column < it->size() && it->at(column).resolved) {
+            return &it->at(column).value;
+        }
+    }
+
+    // check if there is something set for the column (dataset)
+    QVariant v = headerData(column, Qt::Horizontal, role);
+
+    // check if there is something set at global level
+    if (!v.isValid())
+        v = data(role); // includes automatic fallback to default
+
+    if (!cacheable) {
+        *buffer = v;
+        return buffer;
+    }
+    QVector<ColumnAttribute> &resolved = d->columnAttributes[role];
+    if (resolved.size() < columns) {
+        resolved.resize(columns);
+    }
+    ColumnAttribute &attribute = resolved[column];
+    attribute.value = v;
+    attribute.resolved = true;
+    return &attribute.value;
 }
 
 QVariant AttributesModel::data(const QModelIndex &index, int role) const
+{
+    QVariant buffer;
+    return *findData(index, role, &buffer);
+}
+
+const QVariant *AttributesModel::findData(const QModelIndex &index, int role, QVariant *buffer) const
 {
     if (index.isValid()) {
         Q_ASSERT(index.model() == this);
     }
     if (!sourceModel()) {
-        return QVariant();
+        *buffer = QVariant();
+        return buffer;
     }
 
     if (index.isValid()) {
-        const QVariant sourceData = sourceModel()->data(mapToSource(index), role);
-        if (sourceData.isValid()) {
-            return sourceData;
+        *buffer = sourceModel()->data(mapToSource(index), role);
+        if (buffer->isValid()) {
+            return buffer;
+        }
+    }
+
+    return findAttribute(index, role, buffer);
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+void AttributesModel::multiData(const QModelIndex &index, QModelRoleDataSpan roleDataSpan) const
+{
+    if (index.isValid()) {
+        Q_ASSERT(index.model() == this);
+    }
+    if (!sourceModel()) {
+        for (QModelRoleData &roleData : roleDataSpan) {
+            roleData.clearData();
         }
+        return;
     }
 
+    // ask the source model for all roles at once, then fill in the attributes
+    if (index.isValid()) {
+        sourceModel()->multiData(mapToSource(index), roleDataSpan);
+    } else {
+        for (QModelRoleData &roleData : roleDataSpan) {
+            roleData.clearData();
+        }
+    }
+    for (QModelRoleData &roleData : roleDataSpan) {
+        if (!roleData.data().isValid()) {
+            QVariant buffer;
+            roleData.setData(*findAttribute(index, roleData.role(), &buffer));
+        }
+    }
+}
+#endif
+
+const QVariant *AttributesModel::findAttribute(const QModelIndex &index, int role, QVariant *buffer) const
+{
     // check if we are storing a value for this role at this cell index
-    if (d->dataMap.contains(index.column())) {
-        const QMap<int, QMap<int, QVariant>> &colDataMap = d->dataMap[index.column()];
-        if (colDataMap.contains(index.row())) {
-            const QMap<int, QVariant> &dataMap = colDataMap[index.row()];
-            if (dataMap.contains(role)) {
-                const QVariant v = dataMap[role];
-                if (v.isValid()) {
-                    return v;
-                }
+    if (!d->cellAttributes.isEmpty()) {
+        const auto it = d->cellAttributes.constFind(role);
+        if (it != d->cellAttributes.constEnd() && it->count > 0) {
+            if (const QVariant *v = it->find(index.row(), index.column())) {
+                return v;
             }
         }
     }
     // check if there is something set for the column (dataset), or at global level
     if (index.isValid()) {
-        return data(index.column(), role); // includes automatic fallback to default
+        return findColumnAttribute(index.column(), role, buffer); // includes automatic fallback to default
     }
 
-    return QVariant();
+    *buffer = QVariant();
+    return buffer;
+}
+
+bool AttributesModel::hasCellAttributes(int role) const
+{
+    const auto it = d->cellAttributes.constFind(role);
+    return it != d->cellAttributes.constEnd() && it->count > 0;
+}
+
+bool AttributesModel::sourceSuppliesRole(int column, int role, const QModelIndex &root) const
+{
+    const QAbstractItemModel *source = sourceModel();
+    // the models of this library that hold large datasets only supply values
+    if (!source || qobject_cast<const RingBufferModel *>(source) || qobject_cast<const ColumnarDataModel *>(source)) {
+        return false;
+    }
+    const QModelIndex sourceRoot = mapToSource(root);
+    const int columnCount = source->columnCount(sourceRoot);
+    if (column < 0 || column >= columnCount) {
+        return false;
+    }
+
+    SourceRoleColumns &columns = sourceRoot.isValid()
+        ? d->nestedSourceRoleColumns[QPersistentModelIndex(sourceRoot)][role]
+        : d->sourceRoleColumns[role];
+    if (columns.searched.size() != columnCount) {
+        columns.searched.fill(false, columnCount);
+        columns.supplied.fill(false, columnCount);
+    }
+    if (!columns.searched.testBit(column)) {
+        columns.searched.setBit(column);
+        const int rowCount = source->rowCount(sourceRoot);
+        columns.supplied.setBit(column, sourceRowsSupplyRole(source, sourceRoot, column, 0, rowCount - 1, role));
+    }
+    return columns.supplied.testBit(column);
 }
 
 bool AttributesModel::isKnownAttributesRole(int role) const
@@ -363,9 +630,7 @@ bool AttributesModel::setData(const QModelIndex &index, const QVariant &value, i
     if (!isKnownAttributesRole(role)) {
         return sourceModel()->setData(mapToSource(index), value, role);
     } else {
-        QMap<int, QMap<int, QVariant>> &colDataMap = d->dataMap[index.column()];
-        QMap<int, QVariant> &dataMap = colDataMap[index.row()];
-        dataMap.insert(role, value);
+        d->cellAttributes[role].set(index.row(), index.column(), value);
         Q_EMIT attributesChanged(index, index);
         return true;
     }
@@ -390,6 +655,7 @@ bool AttributesModel::setHeaderData(int section, Qt::Orientation orientation,
 
         QMap<int, QVariant> &dataMap = sectionDataMap[section];
         dataMap.insert(role, value);
+        d->columnAttributes.clear();
         if (sourceModel()) {
             int numRows = rowCount(QModelIndex());
             int numCols = columnCount(QModelIndex());
@@ -422,6 +688,7 @@ void AttributesModel::setPaletteType(AttributesModel::PaletteType type)
         return;
     }
     d->paletteType = type;
+    d->columnAttributes.clear();
     switch (type) {
     case PaletteTypeDefault:
         d->palette = Palette::defaultPalette();
@@ -445,6 +712,7 @@ AttributesModel::PaletteType AttributesModel::paletteType() const
 bool KDChart::AttributesModel::setModelData(const QVariant value, int role)
 {
     d->modelDataMap.insert(role, value);
+    d->columnAttributes.clear();
     int numRows = rowCount(QModelIndex());
     int numCols = columnCount(QModelIndex());
     if (sourceModel() && numRows > 0 && numCols > 0) {
@@ -483,6 +751,12 @@ void AttributesModel::setSourceModel(QAbstractItemModel *newModel)
 {
     QAbstractItemModel *oldModel = sourceModel();
     if (oldModel != nullptr) {
+        disconnect(oldModel, &QAbstractItemModel::headerDataChanged,
+                   this, &AttributesModel::slotSourceHeaderChanged);
+        disconnect(oldModel, &QAbstractItemModel::modelReset,
+                   this, &AttributesModel::slotSourceHeaderChanged);
+        disconnect(oldModel, &QAbstractItemModel::layoutChanged,
+                   this, &AttributesModel::slotSourceHeaderChanged);
         disconnect(oldModel, &QAbstractItemModel::dataChanged,
                    this, &AttributesModel::slotDataChanged);
         disconnect(oldModel, &QAbstractItemModel::rowsInserted,
@@ -508,8 +782,18 @@ void AttributesModel::setSourceModel(QAbstractItemModel *newModel)
         disconnect(oldModel, &QAbstractItemModel::layoutChanged,
                    this, &AttributesModel::layoutChanged);
     }
+    d->columnAttributes.clear();
+    d->sourceRoleColumns.clear();
+    d->nestedSourceRoleColumns.clear();
     QAbstractProxyModel::setSourceModel(newModel);
     if (newModel != nullptr) {
+        // connected first, so that the forwarded signals already see the new header data
+        connect(newModel, &QAbstractItemModel::headerDataChanged,
+                this, &AttributesModel::slotSourceHeaderChanged);
+        connect(newModel, &QAbstractItemModel::modelReset,
+                this, &AttributesModel::slotSourceHeaderChanged);
+        connect(newModel, &QAbstractItemModel::layoutChanged,
+                this, &AttributesModel::slotSourceHeaderChanged);
         connect(newModel, &QAbstractItemModel::dataChanged,
                 this, &AttributesModel::slotDataChanged);
         connect(newModel, &QAbstractItemModel::rowsInserted,
@@ -539,6 +823,7 @@ void AttributesModel::setSourceModel(QAbstractItemModel *newModel)
 
 void AttributesModel::slotRowsAboutToBeInserted(const QModelIndex &parent, int start, int end)
 {
+    d->nestedSourceRoleColumns.clear();
     beginInsertRows(mapFromSource(parent), start, end);
 }
 
@@ -549,9 +834,10 @@ void AttributesModel::slotColumnsAboutToBeInserted(const QModelIndex &parent, in
 
 void AttributesModel::slotRowsInserted(const QModelIndex &parent, int start, int end)
 {
-    Q_UNUSED(parent);
-    Q_UNUSED(start);
-    Q_UNUSED(end);
+    if (!parent.isValid()) {
+        updateSourceRoleColumns(d->sourceRoleColumns, sourceModel(), parent, 0,
+                                sourceModel()->columnCount(parent) - 1, start, end);
+    }
     endInsertRows();
 }
 
@@ -560,11 +846,15 @@ void AttributesModel::slotColumnsInserted(const QModelIndex &parent, int start,
     Q_UNUSED(parent);
     Q_UNUSED(start);
     Q_UNUSED(end);
+    d->columnAttributes.clear();
+    d->sourceRoleColumns.clear();
+    d->nestedSourceRoleColumns.clear();
     endInsertColumns();
 }
 
 void AttributesModel::slotRowsAboutToBeRemoved(const QModelIndex &parent, int start, int end)
 {
+    d->nestedSourceRoleColumns.clear();
     beginRemoveRows(mapFromSource(parent), start, end);
 }
 
@@ -575,32 +865,21 @@ void AttributesModel::slotColumnsAboutToBeRemoved(const QModelIndex &parent, int
 
 void AttributesModel::slotRowsRemoved(const QModelIndex &parent, int start, int end)
 {
-    Q_UNUSED(parent);
     Q_UNUSED(start);
     Q_UNUSED(end);
+    if (!parent.isValid()) {
+        // the removed rows may have been the ones that supplied a role, or made a column too long to search
+        for (auto it = d->sourceRoleColumns.begin(); it != d->sourceRoleColumns.end(); ++it) {
+            it->searched &= ~it->supplied;
+        }
+    }
     endRemoveRows();
 }
 
 void AttributesModel::removeEntriesFromDataMap(int start, int end)
 {
-    QMap<int, QMap<int, QMap<int, QVariant>>>::iterator it = d->dataMap.find(end);
-    // check that the element was found
-    if (it != d->dataMap.end()) {
-        ++it;
-        QVector<int> indexesToDel;
-        for (int i = start; i < end && it != d->dataMap.end(); ++i) {
-            d->dataMap[i] = it.value();
-            indexesToDel << it.key();
-            ++it;
-        }
-        if (indexesToDel.isEmpty()) {
-            for (int i = start; i < end; ++i) {
-                indexesToDel << i;
-            }
-        }
-        for (int i = 0; i < indexesToDel.count(); ++i) {
-            d->dataMap.remove(indexesToDel[i]);
-        }
+    for (auto it = d->cellAttributes.begin(); it != d->cellAttributes.end(); ++it) {
+        it->removeColumns(start, end);
     }
 }
 
@@ -639,13 +918,30 @@ void AttributesModel::slotColumnsRemoved(const QModelIndex &parent, int start, i
     removeEntriesFromDataMap(start, end);
     removeEntriesFromDirectionDataMaps(Qt::Horizontal, start, end);
     removeEntriesFromDirectionDataMaps(Qt::Vertical, start, end);
+    d->columnAttributes.clear();
+    d->sourceRoleColumns.clear();
+    d->nestedSourceRoleColumns.clear();
 
     endRemoveColumns();
 }
 
-void AttributesModel::slotDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+void AttributesModel::slotDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    // the changed cells may supply a role now
+    if (QHash<int, SourceRoleColumns> *roleColumns = d->sourceRoleColumnsBelow(topLeft.parent())) {
+        updateSourceRoleColumns(*roleColumns, sourceModel(), topLeft.parent(), topLeft.column(),
+                                bottomRight.column(), topLeft.row(), bottomRight.row(), roles);
+    }
+    Q_EMIT dataChanged(mapFromSource(topLeft), mapFromSource(bottomRight), roles);
+}
+
+void AttributesModel::slotSourceHeaderChanged()
 {
-    Q_EMIT dataChanged(mapFromSource(topLeft), mapFromSource(bottomRight));
+    // the source model's header data take precedence over the dataset attributes
+    d->columnAttributes.clear();
+    // also connected to the reset and layout changes of the source model
+    d->sourceRoleColumns.clear();
+    d->nestedSourceRoleColumns.clear();
 }
 
 void AttributesModel::setDefaultForRole(int role, const QVariant &value)
@@ -659,6 +955,7 @@ void AttributesModel::setDefaultForRole(int role, const QVariant &value)
             d->defaultsMap.erase(it);
         }
     }
+    d->columnAttributes.clear();
 
     Q_ASSERT(defaultsForRole(role).value<KDChart::DataValueAttributes>() == value.value<KDChart::DataValueAttributes>());
 }
@@ -667,6 +964,7 @@ void AttributesModel::setDatasetDimension(int dimension)
 {
     // ### need to "reformat" or throw away internal data?
     d->dataDimension = dimension;
+    d->columnAttributes.clear();
 }
 
 int AttributesModel::datasetDimension() const
@@ -88,6 +88,47 @@ public:
     int columnCount(const QModelIndex &) const override;
     /** \reimp */
     QVariant data(const QModelIndex &, int role = Qt::DisplayRole) const override;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    /** \reimp
+     * Forwards all roles to the source model in one call, and adds the attributes
+     * for roles that the source model does not provide.
+     */
+    void multiData(const QModelIndex &index, QModelRoleDataSpan roleDataSpan) const override;
+#endif
+
+    /**
+     * Returns the data for \a role at \a index like data(), converted to \a T.
+     * The attributes are converted straight from where they are stored, without
+     * copying them through intermediate QVariants.
+     */
+    template<typename T>
+    T attribute(const QModelIndex &index, int role) const
+    {
+        QVariant buffer;
+        return findData(index, role, &buffer)->value<T>();
+    }
+
+    /**
+     * Returns whether an attribute was set for \a role on any single cell
+     * with setData(). If not, all cells of a dataset share the attributes
+     * of the dataset, unless the source model provides them.
+     */
+    bool hasCellAttributes(int role) const;
+
+    /**
+     * Returns whether the source model supplies \a role itself for any cell
+     * of \a column below \a root, in which case that attribute takes
+     * precedence over the attributes set here.
+     *
+     * Each column is searched only once per root. After that, only the
+     * cells that the source model announces as changed, or inserted at the
+     * top level, are looked at again; columns that supplied the role are
+     * searched again once rows were removed. Columns with more than 1024
+     * rows are not searched at all and count as supplying every role, so
+     * that their cells are looked up one by one.
+     */
+    bool sourceSuppliesRole(int column, int role, const QModelIndex &root = QModelIndex()) const;
+
     /** \reimp */
     bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::DisplayRole) override;
     /** Remove any explicit attributes settings that might have been specified before. */
@@ -124,11 +165,19 @@ private Q_SLOTS:
     void slotRowsRemoved(const QModelIndex &parent, int start, int end);
     void slotColumnsRemoved(const QModelIndex &parent, int start, int end);
 
-    void slotDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void slotDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+    void slotSourceHeaderChanged();
 
 private:
     // helper
     QVariant defaultsForRole(int role) const;
+    // The lookup behind data(), data(column, role) and attribute(): the result is either
+    // stored in *buffer or points to the stored attribute, which is valid until the next
+    // call or change of the model.
+    const QVariant *findData(const QModelIndex &index, int role, QVariant *buffer) const;
+    // like findData(), but without asking the source model
+    const QVariant *findAttribute(const QModelIndex &index, int role, QVariant *buffer) const;
+    const QVariant *findColumnAttribute(int column, int role, QVariant *buffer) const;
     bool compareHeaderDataMaps(const QMap<int, QMap<int, QVariant>> &mapA,
                                const QMap<int, QMap<int, QVariant>> &mapB) const;
 
@@ -0,0 +1,579 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#include "KDChartBatchRenderer.h"
+
+#include <QAbstractTableModel>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QPageSize>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QSvgGenerator>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include "KDChartBarDiagram.h"
+#include "KDChartCartesianAxis.h"
+#include "KDChartCartesianCoordinatePlane.h"
+#include "KDChartChart.h"
+#include "KDChartHeaderFooter.h"
+#include "KDChartLegend.h"
+#include "KDChartLineDiagram.h"
+#include "KDChartPieDiagram.h"
+#include "KDChartPolarCoordinatePlane.h"
+
+#include <KDABLibFakes>
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+using namespace KDChart;
+
+#define d (d_func())
+
+namespace {
+
+// The contents of a data file. It is read on a worker thread and handed to a chart on the GUI thread.
+struct Table
+{
+    QString title;
+    QStringList columnNames;
+    QStringList rowNames;
+    // row after row, NaN for missing values
+    QVector<qreal> values;
+};
+
+// the same cells as TableModel::loadFromCSV() of the examples
+QStringList splitLine(const QString &line)
+{
+    const QStringList cells = line.split(QLatin1Char(','));
+    QStringList ret;
+    for (const QString &cell : cells) {
+        QString s = cell.simplified();
+        if (s.startsWith(QLatin1Char('\"'))) {
+            s.remove(0, 1);
+        }
+        if (s.endsWith(QLatin1Char('\"'))) {
+            s.chop(1);
+        }
+        ret.append(s);
+    }
+    return ret;
+}
+
+bool readTable(const QString &fileName, Table *table, QString *errorString)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *errorString = BatchRenderer::tr("Could not open %1: %2").arg(fileName, file.errorString());
+        return false;
+    }
+
+    bool headerRead = false;
+    while (!file.atEnd()) {
+        const QString line = QString::fromUtf8(file.readLine());
+        if (line.trimmed().isEmpty()) {
+            continue;
+        }
+        const QStringList cells = splitLine(line);
+        if (!headerRead) {
+            table->title = cells.first();
+            table->columnNames = cells.mid(1);
+            headerRead = true;
+            continue;
+        }
+        table->rowNames.append(cells.first());
+        for (int column = 1; column <= table->columnNames.count(); ++column) {
+            bool ok = false;
+            const qreal value = cells.value(column).toDouble(&ok);
+            table->values.append(ok ? value : std::numeric_limits<qreal>::quiet_NaN());
+        }
+    }
+
+    if (table->columnNames.isEmpty() || table->rowNames.isEmpty()) {
+        *errorString = BatchRenderer::tr("%1 holds no data").arg(fileName);
+        return false;
+    }
+    return true;
+}
+
+// Shows a Table. A chart that is reused for another job gets the data of that job in a single reset.
+class DataTableModel : public QAbstractTableModel
+{
+public:
+    using QAbstractTableModel::QAbstractTableModel;
+
+    void setTable(Table &&table)
+    {
+        beginResetModel();
+        m_table = std::move(table);
+        endResetModel();
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : m_table.rowNames.count();
+    }
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : m_table.columnNames.count();
+    }
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override
+    {
+        if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole)) {
+            return QVariant();
+        }
+        const qreal value = m_table.values.at(index.row() * m_table.columnNames.count() + index.column());
+        return std::isnan(value) ? QVariant() : QVariant(value);
+    }
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override
+    {
+        if (role != Qt::DisplayRole) {
+            return QAbstractTableModel::headerData(section, orientation, role);
+        }
+        return orientation == Qt::Horizontal ? m_table.columnNames.value(section) : m_table.rowNames.value(section);
+    }
+
+private:
+    Table m_table;
+};
+
+// A chart that is kept for the jobs that need the same elements
+struct RenderChart
+{
+    ~RenderChart()
+    {
+        delete chart;
+    }
+
+    BatchRenderer::ChartType type = BatchRenderer::Line;
+    bool hasHeader = false;
+    bool hasLegend = false;
+    bool busy = false;
+
+    Chart *chart = nullptr;
+    DataTableModel *model = nullptr;
+    AbstractDiagram *diagram = nullptr;
+    HeaderFooter *header = nullptr;
+};
+
+BatchRenderer::OutputFormat outputFormat(const BatchRenderer::Job &job)
+{
+    if (job.format != BatchRenderer::AutomaticFormat) {
+        return job.format;
+    }
+    const QString suffix = QFileInfo(job.outputFile).suffix().toLower();
+    if (suffix == QLatin1String("pdf")) {
+        return BatchRenderer::PdfFormat;
+    }
+    if (suffix == QLatin1String("svg")) {
+        return BatchRenderer::SvgFormat;
+    }
+    return BatchRenderer::ImageFormat;
+}
+
+// Paints a chart laid out at job.size; runs on a worker thread.
+bool paintJob(Chart *chart, const BatchRenderer::Job &job, BatchRenderer::JobResult *result)
+{
+    const QRect target(QPoint(0, 0), job.size);
+    QElapsedTimer timer;
+    timer.start();
+
+    switch (outputFormat(job)) {
+    case BatchRenderer::PdfFormat: {
+        QPdfWriter writer(job.outputFile);
+        // one device pixel per point, so that the page has the size the chart is laid out at
+        writer.setResolution(72);
+        writer.setPageSize(QPageSize(QSizeF(job.size), QPageSize::Point, QString(), QPageSize::ExactMatch));
+        writer.setPageMargins(QMarginsF());
+        QPainter painter;
+        if (!painter.begin(&writer)) {
+            result->errorString = BatchRenderer::tr("Could not write %1").arg(job.outputFile);
+            return false;
+        }
+        painter.fillRect(target, job.background);
+        chart->paint(&painter, target);
+        result->paintTime = timer.nsecsElapsed();
+        timer.restart();
+        painter.end();
+        result->writeTime = timer.nsecsElapsed();
+        return true;
+    }
+    case BatchRenderer::SvgFormat: {
+        QSvgGenerator generator;
+        generator.setFileName(job.outputFile);
+        generator.setSize(job.size);
+        generator.setViewBox(target);
+        QPainter painter;
+        if (!painter.begin(&generator)) {
+            result->errorString = BatchRenderer::tr("Could not write %1").arg(job.outputFile);
+            return false;
+        }
+        painter.fillRect(target, job.background);
+        chart->paint(&painter, target);
+        result->paintTime = timer.nsecsElapsed();
+        timer.restart();
+        painter.end();
+        result->writeTime = timer.nsecsElapsed();
+        return true;
+    }
+    case BatchRenderer::AutomaticFormat:
+    case BatchRenderer::ImageFormat:
+        break;
+    }
+
+    QImage image(job.size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(job.background);
+    QPainter painter(&image);
+    chart->paint(&painter, target);
+    painter.end();
+    result->paintTime = timer.nsecsElapsed();
+    timer.restart();
+
+    if (job.outputFile.isEmpty()) {
+        result->image = image;
+    } else if (!image.save(job.outputFile)) {
+        result->errorString = BatchRenderer::tr("Could not write %1").arg(job.outputFile);
+        return false;
+    }
+    result->writeTime = timer.nsecsElapsed();
+    return true;
+}
+
+template<typename T>
+bool enumFromJson(const QJsonObject &description, const char *key, const QStringList &names, T *value,
+                  QString *errorString)
+{
+    const QJsonValue name = description.value(QLatin1String(key));
+    if (name.isUndefined()) {
+        return true;
+    }
+    const int index = names.indexOf(name.toString().toLower());
+    if (index < 0) {
+        *errorString = BatchRenderer::tr("Unknown %1 \"%2\"").arg(QLatin1String(key), name.toString());
+        return false;
+    }
+    *value = static_cast<T>(index);
+    return true;
+}
+
+bool jobFromJson(const QJsonObject &description, const QDir &dir, BatchRenderer::Job *job, QString *errorString)
+{
+    const QString dataFile = description.value(QLatin1String("data")).toString();
+    if (dataFile.isEmpty()) {
+        *errorString = BatchRenderer::tr("A job has no data file");
+        return false;
+    }
+    job->dataFile = dir.absoluteFilePath(dataFile);
+    const QString outputFile = description.value(QLatin1String("output")).toString();
+    if (!outputFile.isEmpty()) {
+        job->outputFile = dir.absoluteFilePath(outputFile);
+    }
+    job->title = description.value(QLatin1String("title")).toString();
+    job->size.setWidth(description.value(QLatin1String("width")).toInt(job->size.width()));
+    job->size.setHeight(description.value(QLatin1String("height")).toInt(job->size.height()));
+    job->legend = description.value(QLatin1String("legend")).toBool(job->legend);
+    if (description.contains(QLatin1String("background"))) {
+        job->background = QColor(description.value(QLatin1String("background")).toString());
+        if (!job->background.isValid()) {
+            *errorString = BatchRenderer::tr("Unknown background color in the job for %1").arg(dataFile);
+            return false;
+        }
+    }
+    if (job->size.isEmpty()) {
+        *errorString = BatchRenderer::tr("The job for %1 has an empty size").arg(dataFile);
+        return false;
+    }
+
+    // in the order of the enums, AutomaticFormat can not be asked for
+    const QStringList types = {QStringLiteral("line"), QStringLiteral("bar"), QStringLiteral("pie")};
+    const QStringList subTypes = {QStringLiteral("normal"), QStringLiteral("stacked"), QStringLiteral("percent")};
+    const QStringList formats = {QString(), QStringLiteral("image"), QStringLiteral("pdf"), QStringLiteral("svg")};
+    return enumFromJson(description, "type", types, &job->type, errorString)
+        && enumFromJson(description, "subType", subTypes, &job->subType, errorString)
+        && enumFromJson(description, "format", formats, &job->format, errorString);
+}
+}
+
+class BatchRenderer::Private
+{
+public:
+    Private()
+    {
+        pool.setMaxThreadCount(QThread::idealThreadCount());
+        // the threads keep their font engines and glyph caches for the next jobs
+        pool.setExpiryTimeout(-1);
+    }
+
+    RenderChart *idleChart(ChartType type, bool hasHeader, bool hasLegend);
+    RenderChart *createChart(ChartType type, bool hasHeader, bool hasLegend);
+    // hands the data of a job to a chart and lays it out, on the GUI thread
+    RenderChart *setUp(const Job &job, Table &&table);
+
+    // called by the workers
+    void jobLoaded(int job);
+    void jobPainted(int job);
+    // waits until the workers are done with any jobs, and takes them
+    void waitForWorkers(QVector<int> *loaded, QVector<int> *painted);
+
+    QThreadPool pool;
+    std::vector<std::unique_ptr<RenderChart>> charts;
+
+    QMutex mutex;
+    QWaitCondition workerDone;
+    QVector<int> loadedJobs;
+    QVector<int> paintedJobs;
+};
+
+RenderChart *BatchRenderer::Private::idleChart(ChartType type, bool hasHeader, bool hasLegend)
+{
+    for (const auto &chart : charts) {
+        if (!chart->busy && chart->type == type && chart->hasHeader == hasHeader && chart->hasLegend == hasLegend) {
+            return chart.get();
+        }
+    }
+    return createChart(type, hasHeader, hasLegend);
+}
+
+RenderChart *BatchRenderer::Private::createChart(ChartType type, bool hasHeader, bool hasLegend)
+{
+    auto renderChart = std::make_unique<RenderChart>();
+    renderChart->type = type;
+    renderChart->hasHeader = hasHeader;
+    renderChart->hasLegend = hasLegend;
+
+    auto *chart = new Chart();
+    renderChart->chart = chart;
+    renderChart->model = new DataTableModel(chart);
+
+    if (type == Pie) {
+        auto *plane = new PolarCoordinatePlane(chart);
+        chart->replaceCoordinatePlane(plane);
+        auto *pie = new PieDiagram();
+        pie->setModel(renderChart->model);
+        plane->replaceDiagram(pie);
+        renderChart->diagram = pie;
+    } else {
+        AbstractCartesianDiagram *diagram = nullptr;
+        if (type == Bar) {
+            diagram = new BarDiagram();
+        } else {
+            diagram = new LineDiagram();
+        }
+        diagram->setModel(renderChart->model);
+
+        auto *xAxis = new CartesianAxis(diagram);
+        xAxis->setPosition(CartesianAxis::Bottom);
+        diagram->addAxis(xAxis);
+        auto *yAxis = new CartesianAxis(diagram);
+        yAxis->setPosition(CartesianAxis::Left);
+        diagram->addAxis(yAxis);
+
+        chart->coordinatePlane()->replaceDiagram(diagram);
+        renderChart->diagram = diagram;
+    }
+
+    if (hasHeader) {
+        renderChart->header = new HeaderFooter(chart);
+        chart->addHeaderFooter(renderChart->header);
+    }
+    if (hasLegend) {
+        chart->addLegend(new Legend(renderChart->diagram, chart));
+    }
+
+    charts.push_back(std::move(renderChart));
+    return charts.back().get();
+}
+
+RenderChart *BatchRenderer::Private::setUp(const Job &job, Table &&table)
+{
+    const QString title = job.title.isEmpty() ? table.title : job.title;
+    RenderChart *renderChart = idleChart(job.type, !title.isEmpty(), job.legend);
+    renderChart->busy = true;
+
+    renderChart->model->setTable(std::move(table));
+    if (renderChart->header) {
+        renderChart->header->setText(title);
+    }
+    if (auto *lines = qobject_cast<LineDiagram *>(renderChart->diagram)) {
+        lines->setType(static_cast<LineDiagram::LineType>(job.subType));
+    } else if (auto *bars = qobject_cast<BarDiagram *>(renderChart->diagram)) {
+        bars->setType(static_cast<BarDiagram::BarType>(job.subType));
+    }
+
+    renderChart->chart->layoutForPainting(job.size);
+    return renderChart;
+}
+
+void BatchRenderer::Private::jobLoaded(int job)
+{
+    QMutexLocker locker(&mutex);
+    loadedJobs.append(job);
+    workerDone.wakeAll();
+}
+
+void BatchRenderer::Private::jobPainted(int job)
+{
+    QMutexLocker locker(&mutex);
+    paintedJobs.append(job);
+    workerDone.wakeAll();
+}
+
+void BatchRenderer::Private::waitForWorkers(QVector<int> *loaded, QVector<int> *painted)
+{
+    QMutexLocker locker(&mutex);
+    while (loadedJobs.isEmpty() && paintedJobs.isEmpty()) {
+        workerDone.wait(&mutex);
+    }
+    loaded->swap(loadedJobs);
+    painted->swap(paintedJobs);
+}
+
+BatchRenderer::BatchRenderer(QObject *parent)
+    : QObject(parent)
+    , _d(new Private())
+{
+}
+
+BatchRenderer::~BatchRenderer()
+{
+    d->pool.waitForDone();
+    delete _d;
+}
+
+void BatchRenderer::setMaxThreadCount(int count)
+{
+    d->pool.setMaxThreadCount(qMax(1, count));
+}
+
+int BatchRenderer::maxThreadCount() const
+{
+    return d->pool.maxThreadCount();
+}
+
+QVector<BatchRenderer::JobResult> BatchRenderer::render(const QVector<Job> &jobs)
+{
+    Q_ASSERT(QThread::currentThread() == thread());
+
+    QVector<JobResult> results(jobs.size());
+    QVector<Table> tables(jobs.size());
+    QVector<RenderChart *> charts(jobs.size());
+    // the workers write through these, as QVector::operator[]() is not meant for concurrent use
+    JobResult *const jobResults = results.data();
+    Table *const jobTables = tables.data();
+
+    // While a few jobs are painted, as many are read or laid out. Every job in flight holds
+    // at most one chart, which bounds the number of charts as well.
+    const int maxJobsInFlight = 2 * d->pool.maxThreadCount();
+    int nextJob = 0;
+    int jobsInFlight = 0;
+    int finishedJobs = 0;
+
+    while (finishedJobs < jobs.size()) {
+        for (; nextJob < jobs.size() && jobsInFlight < maxJobsInFlight; ++nextJob) {
+            const int job = nextJob;
+            ++jobsInFlight;
+            jobResults[job].job = job;
+            d->pool.start([this, &jobs, jobResults, jobTables, job]() {
+                QElapsedTimer timer;
+                timer.start();
+                JobResult &result = jobResults[job];
+                result.success = readTable(jobs.at(job).dataFile, &jobTables[job], &result.errorString);
+                result.loadTime = timer.nsecsElapsed();
+                d->jobLoaded(job);
+            });
+        }
+
+        QVector<int> loaded;
+        QVector<int> painted;
+        d->waitForWorkers(&loaded, &painted);
+
+        // give the charts back before new jobs look for one
+        for (int job : std::as_const(painted)) {
+            charts[job]->busy = false;
+            --jobsInFlight;
+            ++finishedJobs;
+            Q_EMIT jobFinished(jobResults[job]);
+        }
+
+        for (int job : std::as_const(loaded)) {
+            JobResult &result = jobResults[job];
+            if (!result.success) {
+                --jobsInFlight;
+                ++finishedJobs;
+                Q_EMIT jobFinished(result);
+                continue;
+            }
+
+            QElapsedTimer timer;
+            timer.start();
+            RenderChart *renderChart = d->setUp(jobs.at(job), std::move(jobTables[job]));
+            charts[job] = renderChart;
+            result.layoutTime = timer.nsecsElapsed();
+
+            d->pool.start([this, &jobs, jobResults, renderChart, job]() {
+                JobResult &result = jobResults[job];
+                result.success = paintJob(renderChart->chart, jobs.at(job), &result);
+                d->jobPainted(job);
+            });
+        }
+    }
+    return results;
+}
+
+QVector<BatchRenderer::Job> BatchRenderer::readJobs(const QString &fileName, QString *errorString)
+{
+    QVector<Job> jobs;
+    QString error;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = tr("Could not open %1: %2").arg(fileName, file.errorString());
+    } else {
+        QJsonParseError parseError;
+        const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+        if (document.isNull()) {
+            error = tr("Could not read %1: %2").arg(fileName, parseError.errorString());
+        } else {
+            const QJsonArray descriptions = document.isObject()
+                ? document.object().value(QLatin1String("jobs")).toArray()
+                : document.array();
+            const QDir dir = QFileInfo(fileName).absoluteDir();
+            for (const QJsonValue &description : descriptions) {
+                Job job;
+                if (!jobFromJson(description.toObject(), dir, &job, &error)) {
+                    break;
+                }
+                jobs.append(job);
+            }
+        }
+    }
+
+    if (!error.isEmpty()) {
+        jobs.clear();
+        if (errorString) {
+            *errorString = error;
+        }
+    }
+    return jobs;
+}
@@ -0,0 +1,194 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#ifndef KDCHARTBATCHRENDERER_H
+#define KDCHARTBATCHRENDERER_H
+
+#include <QColor>
+#include <QImage>
+#include <QMetaType>
+#include <QObject>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+#include "kdchart_export.h"
+
+namespace KDChart {
+
+/**
+ * @brief BatchRenderer renders many charts into images, PDF and SVG files
+ * on a pool of worker threads.
+ *
+ * Each Job describes one chart: its type, a CSV file with its data, a
+ * title and where to write the rendering. The data files are read on the
+ * worker threads, the charts are then laid out on the GUI thread and
+ * painted on the worker threads again, so that several jobs are painted at
+ * once while the next ones are prepared.
+ *
+ * The renderer keeps the charts it creates and reuses them for later jobs
+ * of the same type, and its worker threads stay alive as long as the
+ * renderer, along with the fonts they have loaded and the glyphs they have
+ * cached.
+ *
+ * The data files have the layout that the examples use: the first line
+ * holds the dataset names, the first column the row names, and cells that
+ * are not numbers are missing values. The first cell is the title of
+ * the chart, unless the job gives one.
+ *
+ * render() must be called on the GUI thread.
+ *
+ * \code
+ * KDChart::BatchRenderer renderer;
+ * KDChart::BatchRenderer::Job job;
+ * job.type = KDChart::BatchRenderer::Bar;
+ * job.dataFile = QStringLiteral( "sales.csv" );
+ * job.outputFile = QStringLiteral( "sales.pdf" );
+ * const auto results = renderer.render( { job } );
+ * \endcode
+ */
+class KDCHART_EXPORT BatchRenderer : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(BatchRenderer)
+
+public:
+    enum ChartType
+    {
+        Line,
+        Bar,
+        Pie
+    };
+
+    /** How the datasets of line and bar charts are combined */
+    enum SubType
+    {
+        Normal,
+        Stacked,
+        Percent
+    };
+
+    enum OutputFormat
+    {
+        /** Chosen by the suffix of the output file: "pdf", "svg", or an image format */
+        AutomaticFormat,
+        /** An image in any format that QImage writes */
+        ImageFormat,
+        PdfFormat,
+        SvgFormat
+    };
+
+    /** @brief The description of one chart to render */
+    struct Job
+    {
+        ChartType type = Line;
+        SubType subType = Normal;
+        /** The title shown above the chart; empty to use the first cell of the data file */
+        QString title;
+        /** The CSV file to read the data from */
+        QString dataFile;
+        /**
+         * The file to write the rendering to. If it is empty, an image is
+         * rendered and only returned in JobResult::image.
+         */
+        QString outputFile;
+        OutputFormat format = AutomaticFormat;
+        /** The size of the rendering in pixels, or in points for PDF files */
+        QSize size = QSize(800, 600);
+        QColor background = Qt::white;
+        bool legend = true;
+    };
+
+    /**
+     * @brief What became of a Job
+     *
+     * The times are given in nanoseconds.
+     */
+    struct JobResult
+    {
+        /** The position of the job in the list passed to render() */
+        int job = -1;
+        bool success = false;
+        QString errorString;
+        /** The rendering, for image jobs without an output file */
+        QImage image;
+        /** The time spent reading the data file */
+        qint64 loadTime = 0;
+        /** The time spent laying the chart out on the GUI thread */
+        qint64 layoutTime = 0;
+        /** The time spent painting the chart */
+        qint64 paintTime = 0;
+        /** The time spent encoding and writing the output file */
+        qint64 writeTime = 0;
+    };
+
+    explicit BatchRenderer(QObject *parent = nullptr);
+    ~BatchRenderer() override;
+
+    /**
+     * Sets the number of worker threads. The default is
+     * QThread::idealThreadCount().
+     */
+    void setMaxThreadCount(int count);
+    int maxThreadCount() const;
+
+    /**
+     * Renders \a jobs and returns when all of them are finished.
+     * @return the results, in the order of \a jobs
+     */
+    QVector<JobResult> render(const QVector<Job> &jobs);
+
+    /**
+     * Reads job descriptions from the JSON file \a fileName. The file holds
+     * an array of objects, or an object with such an array as its "jobs"
+     * value, with these keys:
+     *
+     * \li "type": "line", "bar" or "pie"
+     * \li "subType": "normal", "stacked" or "percent"
+     * \li "title": the title
+     * \li "data": the data file
+     * \li "output": the output file
+     * \li "format": "image", "pdf" or "svg"
+     * \li "width" and "height": the size of the rendering
+     * \li "background": the background color, like "#ffffff" or "transparent"
+     * \li "legend": whether to show a legend
+     *
+     * Only "data" is required. Relative paths are resolved against the
+     * directory of \a fileName.
+     *
+     * @return the jobs, or an empty list if the file can not be read, in which case
+     * \a errorString is set if it is not null
+     */
+    static QVector<Job> readJobs(const QString &fileName, QString *errorString = nullptr);
+
+Q_SIGNALS:
+    /**
+     * Emitted on the thread that called render() as soon as a job is
+     * finished, which need not be in the order of the jobs.
+     */
+    void jobFinished(const KDChart::BatchRenderer::JobResult &result);
+
+private:
+    class Private;
+    Private *_d;
+    Private *d_func()
+    {
+        return _d;
+    }
+    const Private *d_func() const
+    {
+        return _d;
+    }
+};
+}
+
+Q_DECLARE_METATYPE(KDChart::BatchRenderer::JobResult)
+
+#endif /* KDCHARTBATCHRENDERER_H */
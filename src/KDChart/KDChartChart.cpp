@@ -20,18 +20,24 @@
 #include <QList>
 #include <QPaintEvent>
 #include <QPainter>
+#include <QPicture>
 #include <QPushButton>
+#include <QThread>
+#include <QThreadPool>
 #include <QToolTip>
 #include <QtDebug>
 
+#include "KDChartAbstractArea_p.h"
+#include "KDChartAbstractCoordinatePlane_p.h"
 #include "KDChartAbstractCartesianDiagram.h"
+#include "KDChartCartesianAxis.h"
 #include "KDChartCartesianCoordinatePlane.h"
 #include "KDChartEnums.h"
 #include "KDChartHeaderFooter.h"
 #include "KDChartLayoutItems.h"
 #include "KDChartLegend.h"
+#include "KDChartPaintContext.h"
 #include "KDChartPainterSaver_p.h"
-#include "KDChartPrintingParameters.h"
 #include <KDChartMarkerAttributes.h>
 #include <KDChartTextAttributes.h>
 
@@ -56,6 +62,13 @@ static bool isZeroArea(const QRect &r)
     return !r.width() || !r.height();
 }
 
+// the layouts and widgets of a chart may only be changed in the GUI thread
+static bool isGuiThread()
+{
+    const QCoreApplication *app = QCoreApplication::instance();
+    return app && QThread::currentThread() == app->thread();
+}
+
 static QString lineProlog(int nestingDepth, int lineno)
 {
     QString numbering(QString::number(lineno).rightJustified(5).append(QChar::fromAscii(':')));
@@ -305,6 +318,7 @@ Chart::Private::Private(Chart *chart_)
             }
         }
     }
+    connect(chart, &Chart::propertiesChanged, this, &Private::invalidateLayers);
 }
 
 Chart::Private::~Private()
@@ -1057,8 +1071,17 @@ void Chart::Private::slotResizePlanes()
     }
 }
 
+void Chart::Private::flushDataUpdates()
+{
+    for (AbstractCoordinatePlane *plane : std::as_const(coordinatePlanes)) {
+        AbstractCoordinatePlane::Private::get(plane)->flushDataUpdate(plane);
+    }
+}
+
 void Chart::Private::updateDirtyLayouts()
 {
+    // a paint right after a data change must not show the old data
+    flushDataUpdates();
     if (isPlanesLayoutDirty) {
         for (AbstractCoordinatePlane *p : std::as_const(coordinatePlanes)) {
             p->setGridNeedsRecalculate();
@@ -1082,7 +1105,14 @@ void Chart::Private::reapplyInternalLayouts()
     slotResizePlanes();
 }
 
-void Chart::Private::paintAll(QPainter *painter)
+// Planes outside of the repainted region are left alone; everything else relies on clipping.
+static bool isOutside(const QRegion &region, AbstractLayoutItem *item)
+{
+    return !region.isEmpty() && dynamic_cast<AbstractCoordinatePlane *>(item)
+        && !region.intersects(item->geometry());
+}
+
+void Chart::Private::paintAll(QPainter *painter, const QRegion &region)
 {
     updateDirtyLayouts();
 
@@ -1095,10 +1125,15 @@ void Chart::Private::paintAll(QPainter *painter)
     // Paint the frame (if any)
     AbstractAreaBase::paintFrameAttributes(*painter, rect, frameAttributes);
 
-    chart->reLayoutFloatingLegends();
+    // other threads find them where layoutForPainting() has placed them
+    if (isGuiThread()) {
+        chart->reLayoutFloatingLegends();
+    }
 
     for (AbstractLayoutItem *planeLayoutItem : std::as_const(planeLayoutItems)) {
-        planeLayoutItem->paintAll(*painter);
+        if (!isOutside(region, planeLayoutItem)) {
+            planeLayoutItem->paintAll(*painter);
+        }
     }
     for (TextArea *textLayoutItem : std::as_const(textLayoutItems)) {
         textLayoutItem->paintAll(*painter);
@@ -1112,6 +1147,185 @@ void Chart::Private::paintAll(QPainter *painter)
     }
 }
 
+bool Chart::Private::isLaidOutFor(const QSize &size) const
+{
+    if (size != chart->size() || isPlanesLayoutDirty || isFloatingLegendsLayoutDirty) {
+        return false;
+    }
+    for (AbstractCoordinatePlane *plane : coordinatePlanes) {
+        if (AbstractCoordinatePlane::Private::get(plane)->hasPendingDataUpdate()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Chart::Private::invalidateLayers()
+{
+    ++layerGeneration;
+}
+
+bool Chart::Private::canPaintLayered() const
+{
+    if (!layeredRendering || overrideSize.isValid()) {
+        return false;
+    }
+    // only Cartesian planes paint their grid separately from their diagrams
+    for (AbstractCoordinatePlane *plane : coordinatePlanes) {
+        if (!qobject_cast<CartesianCoordinatePlane *>(plane)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+LayerKey Chart::Private::currentLayerKey() const
+{
+    LayerKey key;
+    key.size = chart->size();
+    key.devicePixelRatio = chart->devicePixelRatioF();
+    key.generation = layerGeneration;
+
+    for (AbstractLayoutItem *planeLayoutItem : planeLayoutItems) {
+        key.geometries.append(planeLayoutItem->geometry());
+        if (auto *area = dynamic_cast<AbstractArea *>(planeLayoutItem)) {
+            key.frameAttributes.append(area->frameAttributes());
+            key.backgroundAttributes.append(area->backgroundAttributes());
+        }
+        if (auto *axis = dynamic_cast<CartesianAxis *>(planeLayoutItem)) {
+            const QStringList labels = axis->labels();
+            const QStringList shortLabels = axis->shortLabels();
+            key.values << labels.size() << shortLabels.size() << axis->position() << axis->customTickLength();
+            key.texts << labels << shortLabels << axis->titleText();
+            key.textAttributes << axis->textAttributes() << axis->titleTextAttributes();
+            key.rulerAttributes.append(axis->rulerAttributes());
+            const QMultiMap<qreal, QString> annotations = axis->annotations();
+            key.values.append(annotations.size());
+            for (auto it = annotations.constBegin(); it != annotations.constEnd(); ++it) {
+                key.values.append(it.key());
+                key.texts.append(it.value());
+            }
+            const QList<qreal> customTicks = axis->customTicks();
+            key.values.append(customTicks.size());
+            for (qreal tick : customTicks) {
+                key.values.append(tick);
+            }
+            // axes without labels of their own show the row headers where the ticks are not calculated
+            auto *plane = const_cast<CartesianCoordinatePlane *>(
+                dynamic_cast<const CartesianCoordinatePlane *>(axis->coordinatePlane()));
+            if (labels.isEmpty() && plane && plane->diagram()) {
+                const bool isVertical = axis->position() == CartesianAxis::Left || axis->position() == CartesianAxis::Right;
+                const DataDimensionsList dimensions = plane->gridDimensionsList();
+                if (!dimensions.isEmpty() && !(isVertical ? dimensions.last() : dimensions.first()).isCalculated) {
+                    const QStringList headerLabels = plane->diagram()->itemRowLabels();
+                    key.values.append(headerLabels.size());
+                    key.texts << headerLabels;
+                }
+            }
+        }
+    }
+    for (TextArea *textLayoutItem : textLayoutItems) {
+        key.geometries.append(textLayoutItem->geometry());
+        key.texts.append(textLayoutItem->text());
+        key.textAttributes.append(textLayoutItem->textAttributes());
+        key.frameAttributes.append(textLayoutItem->frameAttributes());
+        key.backgroundAttributes.append(textLayoutItem->backgroundAttributes());
+    }
+    for (Legend *legend : legends) {
+        // floating legends are not part of the backdrop
+        const bool hidden = legend->isHidden() && legend->testAttribute(Qt::WA_WState_ExplicitShowHide);
+        const bool inBackdrop = !hidden && !legend->position().isFloating();
+        key.geometries.append(inBackdrop ? legend->geometry() : QRect());
+        key.values.append(inBackdrop ? legend->datasetCount() : 0);
+        if (inBackdrop) {
+            // the legend shows the dataset labels of its diagrams unless it has texts of its own
+            const ConstDiagramList diagrams = legend->constDiagrams();
+            for (const AbstractDiagram *diagram : diagrams) {
+                key.texts << diagram->datasetLabels();
+            }
+            const QMap<uint, QString> texts = legend->texts();
+            key.values.append(texts.size());
+            for (auto it = texts.constBegin(); it != texts.constEnd(); ++it) {
+                key.values.append(it.key());
+                key.texts.append(it.value());
+            }
+        }
+    }
+    // the grid and the axes follow the data ranges
+    for (AbstractCoordinatePlane *plane : coordinatePlanes) {
+        const QRectF range = static_cast<CartesianCoordinatePlane *>(plane)->visibleDataRange();
+        key.values << range.left() << range.top() << range.width() << range.height();
+        key.values << plane->zoomFactorX() << plane->zoomFactorY() << plane->zoomCenter().x() << plane->zoomCenter().y();
+        const DataDimensionsList dimensions = plane->gridDimensionsList();
+        for (const DataDimension &dimension : dimensions) {
+            key.values << dimension.start << dimension.end << dimension.stepWidth << dimension.subStepWidth;
+            key.values << dimension.isCalculated << dimension.calcMode << dimension.sequence;
+        }
+    }
+    return key;
+}
+
+static void paintAreaLayers(AbstractArea *area, QPainter &painter, int layers)
+{
+    AbstractArea::Private *areaPrivate = AbstractArea::Private::get(area);
+    areaPrivate->paintLayers = layers;
+    area->paintAll(painter);
+    areaPrivate->paintLayers = AbstractArea::Private::AllLayers;
+}
+
+void Chart::Private::paintLayered(QPainter *painter, const QRegion &region)
+{
+    updateDirtyLayouts();
+    chart->reLayoutFloatingLegends();
+
+    const LayerKey key = currentLayerKey();
+    if (backdropLayer.isNull() || key != backdropLayerKey) {
+        backdropLayerKey = key;
+        backdropLayer = QImage(key.size * key.devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+        backdropLayer.setDevicePixelRatio(key.devicePixelRatio);
+        // measure fonts like the widget does
+        backdropLayer.setDotsPerMeterX(qRound(chart->logicalDpiX() / 0.0254));
+        backdropLayer.setDotsPerMeterY(qRound(chart->logicalDpiY() / 0.0254));
+        backdropLayer.fill(Qt::transparent);
+
+        QPainter layerPainter(&backdropLayer);
+        const QRect rect(QPoint(0, 0), key.size);
+        AbstractAreaBase::paintBackgroundAttributes(layerPainter, rect, backgroundAttributes);
+        AbstractAreaBase::paintFrameAttributes(layerPainter, rect, frameAttributes);
+
+        for (AbstractLayoutItem *planeLayoutItem : std::as_const(planeLayoutItems)) {
+            if (auto *plane = dynamic_cast<AbstractCoordinatePlane *>(planeLayoutItem)) {
+                paintAreaLayers(plane, layerPainter, AbstractArea::Private::BackdropLayer);
+            } else {
+                planeLayoutItem->paintAll(layerPainter);
+            }
+        }
+        for (TextArea *textLayoutItem : std::as_const(textLayoutItems)) {
+            textLayoutItem->paintAll(layerPainter);
+        }
+        for (Legend *legend : std::as_const(legends)) {
+            const bool hidden = legend->isHidden() && legend->testAttribute(Qt::WA_WState_ExplicitShowHide);
+            if (!hidden && !legend->position().isFloating()) {
+                legend->paintIntoRect(layerPainter, legend->geometry());
+            }
+        }
+    }
+    painter->drawImage(QPoint(0, 0), backdropLayer);
+
+    for (AbstractLayoutItem *planeLayoutItem : std::as_const(planeLayoutItems)) {
+        auto *plane = dynamic_cast<AbstractCoordinatePlane *>(planeLayoutItem);
+        if (plane && !isOutside(region, plane)) {
+            paintAreaLayers(plane, *painter, AbstractArea::Private::ContentLayer);
+        }
+    }
+    for (Legend *legend : std::as_const(legends)) {
+        const bool hidden = legend->isHidden() && legend->testAttribute(Qt::WA_WState_ExplicitShowHide);
+        if (!hidden && legend->position().isFloating()) {
+            legend->paintIntoRect(*painter, legend->geometry());
+        }
+    }
+}
+
 // ******** Chart interface implementation ***********
 
 #define d d_func()
@@ -1144,6 +1358,7 @@ Chart::~Chart()
 void Chart::setFrameAttributes(const FrameAttributes &a)
 {
     d->frameAttributes = a;
+    d->invalidateLayers();
 }
 
 FrameAttributes Chart::frameAttributes() const
@@ -1154,6 +1369,7 @@ FrameAttributes Chart::frameAttributes() const
 void Chart::setBackgroundAttributes(const BackgroundAttributes &a)
 {
     d->backgroundAttributes = a;
+    d->invalidateLayers();
 }
 
 BackgroundAttributes Chart::backgroundAttributes() const
@@ -1316,29 +1532,53 @@ int Chart::globalLeadingBottom() const
     return d->globalLeadingBottom;
 }
 
+void Chart::setLayeredRenderingEnabled(bool enabled)
+{
+    d->layeredRendering = enabled;
+    d->backdropLayer = QImage();
+    update();
+}
+
+bool Chart::isLayeredRenderingEnabled() const
+{
+    return d->layeredRendering;
+}
+
 void Chart::paint(QPainter *painter, const QRect &target)
 {
     if (target.isEmpty() || !painter) {
         return;
     }
+    if (!isGuiThread() && !d->isLaidOutFor(target.size())) {
+        // laying the chart out here would race with the GUI thread
+        qWarning("KDChart::Chart::paint: the chart is not laid out for a %dx%d rendering outside of the "
+                 "GUI thread, call layoutForPainting() first",
+                 target.width(), target.height());
+        return;
+    }
 
-    QPaintDevice *prevDevice = GlobalMeasureScaling::paintDevice();
-    GlobalMeasureScaling::setPaintDevice(painter->device());
+    // The scaling of this rendering is carried by its own context rather than by global state,
+    // so that distinct charts can be painted on several threads at once.
+    PaintContext context;
+    context.setPainter(painter);
+    context.setRectangle(target);
+    context.setFontMetricsDevice(painter->device());
 
     // Output on a widget
     if (dynamic_cast<QWidget *>(painter->device()) != nullptr) {
-        GlobalMeasureScaling::setFactors(qreal(target.width()) / qreal(geometry().size().width()),
-                                         qreal(target.height()) / qreal(geometry().size().height()));
+        context.setMeasureFactors(qreal(target.width()) / qreal(geometry().size().width()),
+                                  qreal(target.height()) / qreal(geometry().size().height()));
     } else {
         // Output onto a QPixmap
-        PrintingParameters::setScaleFactor(qreal(painter->device()->logicalDpiX()) / qreal(logicalDpiX()));
+        context.setPenScaleFactor(qreal(painter->device()->logicalDpiX()) / qreal(logicalDpiX()));
 
         const qreal resX = qreal(logicalDpiX()) / qreal(painter->device()->logicalDpiX());
         const qreal resY = qreal(logicalDpiY()) / qreal(painter->device()->logicalDpiY());
 
-        GlobalMeasureScaling::setFactors(qreal(target.width()) / qreal(geometry().size().width()) * resX,
-                                         qreal(target.height()) / qreal(geometry().size().height()) * resY);
+        context.setMeasureFactors(qreal(target.width()) / qreal(geometry().size().width()) * resX,
+                                  qreal(target.height()) / qreal(geometry().size().height()) * resY);
     }
+    const PaintContext *previousContext = PaintContext::setCurrent(&context);
 
     const QPoint translation = target.topLeft();
     painter->translate(translation);
@@ -1373,9 +1613,64 @@ void Chart::paint(QPainter *painter, const QRect &target)
 
     painter->translate(-translation.x(), -translation.y());
 
-    GlobalMeasureScaling::instance()->resetFactors();
-    PrintingParameters::resetScaleFactor();
-    GlobalMeasureScaling::setPaintDevice(prevDevice);
+    PaintContext::setCurrent(previousContext);
+}
+
+void Chart::layoutForPainting(const QSize &size)
+{
+    if (!isGuiThread()) {
+        qWarning("KDChart::Chart::layoutForPainting: must be called in the GUI thread");
+        return;
+    }
+    // updates postponed to the event loop would otherwise relayout the chart while it is painted
+    d->flushDataUpdates();
+    // a hidden chart does not get a resize event, and new texts do not relayout it either
+    resize(size);
+    d->isPlanesLayoutDirty = true;
+    d->isFloatingLegendsLayoutDirty = true;
+    d->updateDirtyLayouts();
+}
+
+void Chart::paintTiled(QImage *image, int maxThreadCount)
+{
+    if (!image || image->isNull()) {
+        return;
+    }
+
+    // Lay the chart out and paint it once, into a recording. Only the rasterizing of the
+    // recording is spread over the threads, so that the chart is never painted concurrently.
+    QPicture picture;
+    QPainter recorder(&picture);
+    paint(&recorder, image->rect());
+    recorder.end();
+    const QByteArray recording(picture.data(), int(picture.size()));
+
+    const int threadCount = maxThreadCount > 0 ? maxThreadCount : QThread::idealThreadCount();
+    // a few bands per thread even out bands that are busier than others
+    const int bandHeight = qMax(64, (image->height() + 4 * threadCount - 1) / (4 * threadCount));
+
+    // The bands are views of the rows of the image, so they need no stitching. They have the
+    // default resolution, like the recording that the chart was laid out for.
+    uchar *const bits = image->bits();
+    const auto bytesPerLine = image->bytesPerLine();
+    const int width = image->width();
+    const QImage::Format format = image->format();
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threadCount);
+    for (int top = 0; top < image->height(); top += bandHeight) {
+        const int height = qMin(bandHeight, image->height() - top);
+        pool.start([=]() {
+            QImage band(bits + top * bytesPerLine, width, height, bytesPerLine, format);
+            // a picture of its own, playing one is not thread-safe
+            QPicture bandPicture;
+            bandPicture.setData(recording.constData(), uint(recording.size()));
+            QPainter painter(&band);
+            painter.translate(0, -top);
+            painter.drawPicture(0, 0, bandPicture);
+        });
+    }
+    pool.waitForDone();
 }
 
 void Chart::resizeEvent(QResizeEvent *event)
@@ -1416,10 +1711,20 @@ void Chart::reLayoutFloatingLegends()
     }
 }
 
-void Chart::paintEvent(QPaintEvent *)
+void Chart::paintEvent(QPaintEvent *event)
 {
     QPainter painter(this);
-    d->paintAll(&painter);
+    // a data change in a diagram only asks for the part of its plane that changed
+    QRegion region;
+    if (!event->rect().contains(rect())) {
+        region = event->region();
+        painter.setClipRegion(region);
+    }
+    if (d->canPaintLayered()) {
+        d->paintLayered(&painter, region);
+    } else {
+        d->paintAll(&painter, region);
+    }
     Q_EMIT finishedDrawing();
 }
 
@@ -50,6 +50,10 @@ Note that grids are painted from the coordinate plane, not from the diagram as o
 
 */
 
+QT_BEGIN_NAMESPACE
+class QImage;
+QT_END_NAMESPACE
+
 namespace KDChart {
 
 class BackgroundAttributes;
@@ -413,6 +417,39 @@ public:
      */
     int globalLeadingBottom() const;
 
+    /**
+     * Enables or disables layered rendering of the chart widget.
+     *
+     * If enabled, the background and frame of the chart, the backgrounds,
+     * frames and grids of the coordinate planes, the axes, headers, footers
+     * and legends are rendered into a cached image. The chart then only
+     * paints its diagrams on top of that image on each update, so charts
+     * that are updated often, e.g. because the data of their model changes,
+     * become much cheaper to repaint.
+     *
+     * The cached image is rendered again after the layout of the chart, the
+     * data ranges shown by the coordinate planes or the properties of any
+     * of its components changed. Changes that do none of these, e.g. a new
+     * row header text shown by a category axis, are not picked up until then;
+     * calling this method again discards the cached image.
+     *
+     * Layered rendering is only used by the chart widget painting itself, not by
+     * paint(), and only if all coordinate planes are Cartesian ones; other charts
+     * are painted directly. Floating legends are painted on top of the diagrams.
+     *
+     * Layered rendering is disabled by default.
+     *
+     * \sa isLayeredRenderingEnabled
+     */
+    void setLayeredRenderingEnabled(bool enabled);
+
+    /**
+     * \return Whether layered rendering is enabled.
+     *
+     * \sa setLayeredRenderingEnabled
+     */
+    bool isLayeredRenderingEnabled() const;
+
     /**
      * Paints all the contents of the chart. Use this method to make KDChart
      * draw into your QPainter.
@@ -421,13 +458,51 @@ public:
      * so make sure to set them to zero, if you want the drawing to have the exact
      * size of the target rectangle.
      *
+     * \note Distinct charts can be painted into QImages from several threads at
+     * once, e.g. to render them headlessly on a thread pool. The charts and their
+     * models still belong to the GUI thread: set them up there, call
+     * layoutForPainting() with the size of the target there, and do not change
+     * them until they have been painted. Outside of the GUI thread, a chart that
+     * is not laid out for the size of \a target is not painted at all.
+     *
      * \param painter The painter to be drawn into.
      * \param target The rectangle to be filled by the Chart's drawing.
      *
-     * \sa setGlobalLeading
+     * \sa setGlobalLeading, layoutForPainting
      */
     void paint(QPainter *painter, const QRect &target);
 
+    /**
+     * Resizes the chart to \a size and lays it out, including the data
+     * changes that have not been handled yet, so that paint() with a target
+     * of that size has nothing left to lay out.
+     *
+     * Call this in the GUI thread before painting the chart in another one.
+     *
+     * \sa paint
+     */
+    void layoutForPainting(const QSize &size);
+
+    /**
+     * Paints all the contents of the chart into \a image, like paint() would
+     * with a painter on \a image and the whole image as the target.
+     *
+     * The chart is laid out and painted only once, into a recording, on the
+     * calling thread. The image is then split into bands of rows, and the
+     * recording is rasterized into the bands on up to \a maxThreadCount
+     * threads at once. This pays off for poster sized images, where
+     * rasterizing takes most of the time; small images are painted faster
+     * with paint(). The image is painted at the default resolution, whatever
+     * its dots per meter.
+     *
+     * \param image The image to be drawn into.
+     * \param maxThreadCount The number of threads to rasterize on, 0 for
+     * QThread::idealThreadCount().
+     *
+     * \sa paint
+     */
+    void paintTiled(QImage *image, int maxThreadCount = 0);
+
     void reLayoutFloatingLegends();
 
 Q_SIGNALS:
@@ -23,6 +23,7 @@
 //
 
 #include <QHBoxLayout>
+#include <QImage>
 #include <QObject>
 #include <QVBoxLayout>
 
@@ -31,7 +32,9 @@
 #include "KDChartChart.h"
 #include "KDChartFrameAttributes.h"
 #include "KDChartLayoutItems.h"
+#include "KDChartRulerAttributes.h"
 #include "KDChartTextArea.h"
+#include "KDChartTextAttributes.h"
 
 #include <KDABLibFakes>
 
@@ -88,6 +91,38 @@ struct LayoutGraphNode
     }
 };
 
+/**
+ * \internal
+ * Everything the cached backdrop layer of a chart depends on, apart from the
+ * properties whose changes bump the layer generation.
+ */
+struct LayerKey
+{
+    QSize size;
+    qreal devicePixelRatio = 0;
+    quint64 generation = 0;
+    QVector<QRect> geometries;
+    // data ranges, zoom and legend states
+    QVector<qreal> values;
+    QStringList texts;
+    QVector<TextAttributes> textAttributes;
+    QVector<FrameAttributes> frameAttributes;
+    QVector<BackgroundAttributes> backgroundAttributes;
+    QVector<RulerAttributes> rulerAttributes;
+
+    bool operator==(const LayerKey &other) const
+    {
+        return size == other.size && devicePixelRatio == other.devicePixelRatio && generation == other.generation
+            && geometries == other.geometries && values == other.values && texts == other.texts
+            && textAttributes == other.textAttributes && frameAttributes == other.frameAttributes
+            && backgroundAttributes == other.backgroundAttributes && rulerAttributes == other.rulerAttributes;
+    }
+    bool operator!=(const LayerKey &other) const
+    {
+        return !operator==(other);
+    }
+};
+
 /**
  * \internal
  */
@@ -141,14 +176,33 @@ public:
 
     Qt::LayoutDirection layoutDirection;
 
+    // the backdrop layer painted below the diagrams, see Chart::setLayeredRenderingEnabled()
+    bool layeredRendering = false;
+    QImage backdropLayer;
+    LayerKey backdropLayerKey;
+    quint64 layerGeneration = 0;
+
     Private(Chart *);
 
     ~Private() override;
 
+    static Private *get(Chart *chart)
+    {
+        return chart->d_func();
+    }
+
     void createLayouts();
+    // carries out the data updates that the planes postponed to the event loop
+    void flushDataUpdates();
     void updateDirtyLayouts();
     void reapplyInternalLayouts(); // TODO: see if this can be merged with updateDirtyLayouts()
-    void paintAll(QPainter *painter);
+    // region is the part of the chart to repaint, an empty region means all of it
+    void paintAll(QPainter *painter, const QRegion &region = QRegion());
+    bool canPaintLayered() const;
+    LayerKey currentLayerKey() const;
+    void paintLayered(QPainter *painter, const QRegion &region = QRegion());
+    // whether a paint() of size finds nothing left to lay out, see Chart::layoutForPainting()
+    bool isLaidOutFor(const QSize &size) const;
 
     struct AxisInfo
     {
@@ -161,6 +215,7 @@ public:
     QVector<LayoutGraphNode *> buildPlaneLayoutGraph();
 
 public Q_SLOTS:
+    void invalidateLayers();
     void slotLayoutPlanes();
     void slotResizePlanes();
     void slotLegendPositionChanged(AbstractAreaWidget *legend);
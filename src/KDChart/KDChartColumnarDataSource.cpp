@@ -0,0 +1,129 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#include "KDChartColumnarDataSource.h"
+#include "KDChartColumnarDataSource_p.h"
+
+#include <KDABLibFakes>
+
+using namespace KDChart;
+
+ColumnarDataSource::ColumnarDataSource(QObject *parent)
+    : QObject(parent)
+{
+}
+
+ColumnarDataSource::~ColumnarDataSource()
+{
+}
+
+const double *ColumnarDataSource::keys(int dataset) const
+{
+    Q_UNUSED(dataset);
+    return nullptr;
+}
+
+QString ColumnarDataSource::datasetName(int dataset) const
+{
+    Q_UNUSED(dataset);
+    return QString();
+}
+
+ColumnarDataModel::ColumnarDataModel(ColumnarDataSource *source, int datasetDimension, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_source(source)
+    , m_datasetDimension(datasetDimension == 2 ? 2 : 1)
+{
+    Q_ASSERT(source);
+    connect(source, &ColumnarDataSource::dataChanged, this, &ColumnarDataModel::slotSourceDataChanged);
+    connect(source, &ColumnarDataSource::reset, this, &ColumnarDataModel::slotSourceReset);
+    connect(source, &QObject::destroyed, this, &ColumnarDataModel::slotSourceReset);
+    updateSpans();
+}
+
+ColumnarDataModel::~ColumnarDataModel()
+{
+}
+
+ColumnarDataSource *ColumnarDataModel::source() const
+{
+    return m_source;
+}
+
+int ColumnarDataModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rowCount;
+}
+
+int ColumnarDataModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_spans.size();
+}
+
+QVariant ColumnarDataModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole)) {
+        return QVariant();
+    }
+    const qreal v = value(index.row(), index.column());
+    return ISNAN(v) ? QVariant() : QVariant(v);
+}
+
+QVariant ColumnarDataModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole && m_source
+        && section >= 0 && section < m_spans.size()) {
+        const QString name = m_source->datasetName(section / m_datasetDimension);
+        if (!name.isEmpty()) {
+            return name;
+        }
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+void ColumnarDataModel::slotSourceDataChanged(int firstDataset, int lastDataset, int firstSample, int lastSample)
+{
+    if (m_rowCount == 0 || m_spans.isEmpty()) {
+        return;
+    }
+    const int firstRow = qBound(0, firstSample, m_rowCount - 1);
+    const int lastRow = qBound(firstRow, lastSample, m_rowCount - 1);
+    const int firstColumn = qBound(0, firstDataset * m_datasetDimension, int(m_spans.size()) - 1);
+    const int lastColumn = qBound(firstColumn, lastDataset * m_datasetDimension + m_datasetDimension - 1,
+                                  int(m_spans.size()) - 1);
+    Q_EMIT dataChanged(index(firstRow, firstColumn), index(lastRow, lastColumn));
+}
+
+void ColumnarDataModel::slotSourceReset()
+{
+    beginResetModel();
+    updateSpans();
+    endResetModel();
+}
+
+void ColumnarDataModel::updateSpans()
+{
+    m_spans.clear();
+    m_rowCount = 0;
+    // m_source is already null if this is called because the source was destroyed
+    if (!m_source) {
+        return;
+    }
+    m_rowCount = m_source->sampleCount();
+    const int datasets = m_source->datasetCount();
+    m_spans.reserve(datasets * m_datasetDimension);
+    for (int dataset = 0; dataset < datasets; ++dataset) {
+        if (m_datasetDimension == 2) {
+            m_spans.append(m_source->keys(dataset));
+        }
+        Q_ASSERT(m_source->values(dataset));
+        m_spans.append(m_source->values(dataset));
+    }
+}
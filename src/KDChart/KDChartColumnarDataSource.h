@@ -0,0 +1,83 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#ifndef KDCHARTCOLUMNARDATASOURCE_H
+#define KDCHARTCOLUMNARDATASOURCE_H
+
+#include <QObject>
+#include <QString>
+
+#include "kdchart_export.h"
+
+namespace KDChart {
+
+/**
+ * \brief ColumnarDataSource gives Cartesian diagrams direct access to
+ * sample buffers that are already stored as contiguous arrays.
+ *
+ * Instead of wrapping large buffers into a QAbstractItemModel, where
+ * every value has to be boxed into a QVariant and read through virtual
+ * calls, an implementation of this interface simply returns a pointer
+ * to the values of each dataset. Pass it to
+ * AbstractCartesianDiagram::setDataSource() instead of calling setModel().
+ *
+ * All datasets have sampleCount() values. A value that is NaN is treated
+ * like a missing value in a model. Datasets may optionally provide key
+ * values, which are used by diagrams with a dataset dimension of 2 (like
+ * Plotter); without keys, the sample number is used as the key.
+ *
+ * The pointers returned by values() and keys() must stay valid until the
+ * next emission of reset(). After changing values in place, emit
+ * dataChanged() for the affected range; after changing the number of
+ * datasets or samples, or after reallocating a buffer, emit reset().
+ */
+class KDCHART_EXPORT ColumnarDataSource : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(ColumnarDataSource)
+
+public:
+    explicit ColumnarDataSource(QObject *parent = nullptr);
+    ~ColumnarDataSource() override;
+
+    /** \return the number of datasets */
+    virtual int datasetCount() const = 0;
+    /** \return the number of samples in each dataset */
+    virtual int sampleCount() const = 0;
+    /** \return the sampleCount() values of \a dataset, must not be null */
+    virtual const double *values(int dataset) const = 0;
+    /**
+     * \return the sampleCount() keys of \a dataset, or null to use the
+     * sample number as key. The default implementation returns null.
+     */
+    virtual const double *keys(int dataset) const;
+    /**
+     * \return the name shown in legends for \a dataset. The default
+     * implementation returns an empty string, which makes the diagram
+     * fall back to its default dataset names.
+     */
+    virtual QString datasetName(int dataset) const;
+
+Q_SIGNALS:
+    /**
+     * Emit this signal after changing the samples \a firstSample to
+     * \a lastSample (inclusive) of the datasets \a firstDataset to
+     * \a lastDataset (inclusive) in place.
+     */
+    void dataChanged(int firstDataset, int lastDataset, int firstSample, int lastSample);
+    /**
+     * Emit this signal after changing the number of datasets or samples,
+     * or when any of the pointers returned by values() or keys() changed.
+     */
+    void reset();
+};
+}
+
+#endif
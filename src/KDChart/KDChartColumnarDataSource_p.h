@@ -0,0 +1,88 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#ifndef KDCHARTCOLUMNARDATASOURCE_P_H
+#define KDCHARTCOLUMNARDATASOURCE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the KD Chart API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QAbstractTableModel>
+#include <QPointer>
+#include <QVector>
+
+#include "KDChartColumnarDataSource.h"
+
+namespace KDChart {
+
+/**
+ * \internal
+ * Presents a ColumnarDataSource as a flat table model, so that attributes,
+ * legends and everything else that works on indexes keeps working.
+ * With a dataset dimension of 2, every dataset gets a key and a value column.
+ * The CartesianDiagramDataCompressor bypasses data() and reads the
+ * values directly through value().
+ */
+class KDCHART_EXPORT ColumnarDataModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    ColumnarDataModel(ColumnarDataSource *source, int datasetDimension, QObject *parent = nullptr);
+    ~ColumnarDataModel() override;
+
+    ColumnarDataSource *source() const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // non-virtual versions of rowCount() and columnCount()
+    int sampleCount() const
+    {
+        return m_rowCount;
+    }
+    int spanCount() const
+    {
+        return m_spans.size();
+    }
+    // no range checks, the caller is responsible for valid arguments
+    qreal value(int row, int column) const
+    {
+        const double *span = m_spans.at(column);
+        // key columns without keys enumerate the samples
+        return span ? span[row] : qreal(row);
+    }
+
+private Q_SLOTS:
+    void slotSourceDataChanged(int firstDataset, int lastDataset, int firstSample, int lastSample);
+    void slotSourceReset();
+
+private:
+    void updateSpans();
+
+    QPointer<ColumnarDataSource> m_source;
+    int m_datasetDimension;
+    int m_rowCount = 0;
+    // one per model column
+    QVector<const double *> m_spans;
+};
+}
+
+#endif
@@ -0,0 +1,150 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#include "KDChartLabelOverlapGrid_p.h"
+
+#include <KDABLibFakes>
+
+#include <cmath>
+
+using namespace KDChart;
+
+// areas covering more cells than this are not put into the grid
+static const int MaxCellsPerArea = 64;
+
+static quint64 cellKey(int column, int row)
+{
+    return (quint64(quint32(column)) << 32) | quint32(row);
+}
+
+// unlike QRectF::intersects(), rects that only touch count as overlapping, as
+// they do for QPainterPath::intersects()
+static bool boundsOverlap(const QRectF &a, const QRectF &b)
+{
+    return a.left() <= b.right() && b.left() <= a.right()
+        && a.top() <= b.bottom() && b.top() <= a.bottom();
+}
+
+void LabelOverlapGrid::clear()
+{
+    m_entries.clear();
+    m_cellSize = 0;
+    m_cells.clear();
+    m_oversized.clear();
+    m_visits.clear();
+    m_query = 0;
+}
+
+bool LabelOverlapGrid::addIfFree(const QPolygonF &area, bool isRect)
+{
+    const QRectF bounds = area.boundingRect();
+    if (m_cellSize <= 0) {
+        // labels tend to have similar sizes, so the first one decides
+        m_cellSize = qMax(qreal(8.0), 2 * qMax(bounds.width(), bounds.height()));
+    }
+
+    QPainterPath path;
+    if (!isRect) {
+        // Using QPainterPath allows us to use intersects() (which has many early-exits)
+        // instead of QPolygon::intersected (which calculates a slow and precise intersection polygon)
+        path.addPolygon(area);
+    }
+
+    ++m_query;
+    // test recently added labels first, they are more likely to overlap
+    for (int i = m_oversized.count() - 1; i >= 0; --i) {
+        if (overlaps(m_entries.at(m_oversized.at(i)), bounds, path)) {
+            return false;
+        }
+    }
+    int firstColumn, lastColumn, firstRow, lastRow;
+    const bool inGrid = cellRange(bounds, &firstColumn, &lastColumn, &firstRow, &lastRow);
+    if (inGrid) {
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int column = firstColumn; column <= lastColumn; ++column) {
+                const auto cell = m_cells.constFind(cellKey(column, row));
+                if (cell == m_cells.constEnd()) {
+                    continue;
+                }
+                for (int i = cell->count() - 1; i >= 0; --i) {
+                    const int entry = cell->at(i);
+                    if (m_visits.at(entry) == m_query) {
+                        continue;
+                    }
+                    m_visits[entry] = m_query;
+                    if (overlaps(m_entries.at(entry), bounds, path)) {
+                        return false;
+                    }
+                }
+            }
+        }
+    } else {
+        // too large or not finite: test all of them
+        for (int entry = m_entries.count() - 1; entry >= 0; --entry) {
+            if (m_visits.at(entry) != m_query && overlaps(m_entries.at(entry), bounds, path)) {
+                return false;
+            }
+        }
+    }
+
+    const int entry = m_entries.count();
+    m_entries.append({ bounds, path });
+    m_visits.append(0);
+    if (inGrid) {
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int column = firstColumn; column <= lastColumn; ++column) {
+                m_cells[cellKey(column, row)].append(entry);
+            }
+        }
+    } else {
+        m_oversized.append(entry);
+    }
+    return true;
+}
+
+bool LabelOverlapGrid::overlaps(const Entry &entry, const QRectF &bounds, const QPainterPath &path) const
+{
+    if (!boundsOverlap(entry.bounds, bounds)) {
+        return false;
+    }
+    if (entry.path.isEmpty() && path.isEmpty()) {
+        // like QPainterPath::intersects() for two rects, which includes touching ones
+        return true;
+    }
+    if (entry.path.isEmpty()) {
+        QPainterPath entryPath;
+        entryPath.addRect(entry.bounds);
+        return entryPath.intersects(path);
+    }
+    if (path.isEmpty()) {
+        QPainterPath rectPath;
+        rectPath.addRect(bounds);
+        return entry.path.intersects(rectPath);
+    }
+    return entry.path.intersects(path);
+}
+
+bool LabelOverlapGrid::cellRange(const QRectF &rect, int *firstColumn, int *lastColumn, int *firstRow, int *lastRow) const
+{
+    const qreal left = std::floor(rect.left() / m_cellSize);
+    const qreal right = std::floor(rect.right() / m_cellSize);
+    const qreal top = std::floor(rect.top() / m_cellSize);
+    const qreal bottom = std::floor(rect.bottom() / m_cellSize);
+    // also false for NaNs
+    if (!((right - left + 1) * (bottom - top + 1) <= MaxCellsPerArea)
+        || !(qAbs(left) < 1e9 && qAbs(right) < 1e9 && qAbs(top) < 1e9 && qAbs(bottom) < 1e9)) {
+        return false;
+    }
+    *firstColumn = int(left);
+    *lastColumn = int(right);
+    *firstRow = int(top);
+    *lastRow = int(bottom);
+    return true;
+}
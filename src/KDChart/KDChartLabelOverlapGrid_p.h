@@ -0,0 +1,80 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#ifndef KDCHARTLABELOVERLAPGRID_P_H
+#define KDCHARTLABELOVERLAPGRID_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the KD Chart API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QHash>
+#include <QPainterPath>
+#include <QPolygonF>
+#include <QRectF>
+#include <QVector>
+
+#include "kdchart_export.h"
+
+namespace KDChart {
+
+/**
+ * \internal
+ * The areas of the data value labels painted so far, to find out whether
+ * a new label would overlap one of them.
+ *
+ * The bounding rects of the labels are kept in a uniform grid, so that only
+ * the few labels near a new one are tested exactly. Rectangular areas can
+ * be compared by their rects alone; all others are tested as paths.
+ */
+class KDCHART_EXPORT LabelOverlapGrid
+{
+public:
+    void clear();
+
+    /**
+     * Adds \a area unless it overlaps an area added before.
+     * If \a isRect is true, \a area is an axis parallel rectangle and is
+     * compared with other such rectangles by their bounding rects only.
+     * \return false if \a area overlaps and was not added
+     */
+    bool addIfFree(const QPolygonF &area, bool isRect);
+
+private:
+    struct Entry
+    {
+        QRectF bounds;
+        // empty for rectangles compared by their bounds
+        QPainterPath path;
+    };
+
+    bool overlaps(const Entry &entry, const QRectF &bounds, const QPainterPath &path) const;
+    // the cells covered by rect, false if it covers too many of them
+    bool cellRange(const QRectF &rect, int *firstColumn, int *lastColumn, int *firstRow, int *lastRow) const;
+
+    QVector<Entry> m_entries;
+    qreal m_cellSize = 0;
+    QHash<quint64, QVector<int>> m_cells;
+    // entries too large for the grid, tested against every new area
+    QVector<int> m_oversized;
+    // the last query each entry was tested in, to test it only once per query
+    QVector<int> m_visits;
+    int m_query = 0;
+};
+}
+
+#endif
@@ -0,0 +1,108 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#include "KDChartLabelTextCache_p.h"
+
+#include <QAbstractTextDocumentLayout>
+#include <QPaintDevice>
+#include <QPainter>
+#include <QPalette>
+#include <QTextDocument>
+
+#include <KDABLibFakes>
+
+using namespace KDChart;
+
+// true if QStaticText lays out text the same way as QTextDocument::setPlainText()
+static bool isSingleLinePlainText(const QString &text)
+{
+    if (text.isEmpty() || Qt::mightBeRichText(text)) {
+        return false;
+    }
+    for (const QChar c : text) {
+        switch (c.unicode()) {
+        case '\n':
+        case '\r':
+        case '\t':
+        case QChar::LineSeparator:
+        case QChar::ParagraphSeparator:
+            return false;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+static void setUpDocument(QTextDocument *doc, const QString &text, const QFont &font)
+{
+    doc->setDocumentMargin(0.0);
+    if (Qt::mightBeRichText(text)) {
+        doc->setHtml(text);
+    } else {
+        doc->setPlainText(text);
+    }
+    doc->setDefaultFont(font);
+}
+
+LabelTextCache::Layout LabelTextCache::layout(const QString &text, const QFont &font, const QPaintDevice *device)
+{
+    const Key key = { text, font, device ? device->logicalDpiX() : 0, device ? device->logicalDpiY() : 0 };
+    const auto it = m_layouts.constFind(key);
+    if (it != m_layouts.constEnd()) {
+        return it.value();
+    }
+
+    Layout layout;
+    if (isSingleLinePlainText(text)) {
+        layout.staticText.setText(text);
+        layout.staticText.setTextFormat(Qt::PlainText);
+        layout.staticText.prepare(QTransform(), device ? QFont(font, device) : font);
+        layout.size = layout.staticText.size();
+    } else {
+        QTextDocument doc;
+        setUpDocument(&doc, text, font);
+        QAbstractTextDocumentLayout *const docLayout = doc.documentLayout();
+        if (device) {
+            docLayout->setPaintDevice(const_cast<QPaintDevice *>(device));
+        }
+        layout.size = docLayout->frameBoundingRect(doc.rootFrame()).size();
+    }
+
+    if (m_layouts.size() >= MaxLayouts) {
+        m_layouts.clear();
+    }
+    m_layouts.insert(key, layout);
+    return layout;
+}
+
+void LabelTextCache::draw(QPainter *painter, const QString &text, const QFont &font, const QPalette &palette)
+{
+    const Layout textLayout = layout(text, font, painter->device());
+    if (textLayout.isPlainText()) {
+        painter->setFont(font);
+        painter->setPen(palette.color(QPalette::Text));
+        painter->drawStaticText(QPointF(0.0, 0.0), textLayout.staticText);
+        return;
+    }
+
+    QTextDocument doc;
+    setUpDocument(&doc, text, font);
+    QAbstractTextDocumentLayout::PaintContext context;
+    context.palette = palette;
+    QAbstractTextDocumentLayout *const docLayout = doc.documentLayout();
+    docLayout->setPaintDevice(painter->device());
+    docLayout->draw(painter, context);
+}
+
+void LabelTextCache::clear()
+{
+    m_layouts.clear();
+}
@@ -0,0 +1,114 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#ifndef KDCHARTLABELTEXTCACHE_P_H
+#define KDCHARTLABELTEXTCACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the KD Chart API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QFont>
+#include <QHash>
+#include <QSizeF>
+#include <QStaticText>
+#include <QString>
+
+#include "kdchart_export.h"
+
+QT_BEGIN_NAMESPACE
+class QPaintDevice;
+class QPainter;
+class QPalette;
+QT_END_NAMESPACE
+
+namespace KDChart {
+
+/**
+ * \internal
+ * Measures and paints the texts of data value labels.
+ *
+ * Single line plain text is laid out once with QStaticText; only texts that
+ * might be rich text go through QTextDocument. The sizes of the texts are
+ * kept across paints, since the same values tend to be labeled again and
+ * again. Rotating a label does not change the size of its text, so the
+ * rotation is left to the caller.
+ */
+class KDCHART_EXPORT LabelTextCache
+{
+public:
+    struct Layout
+    {
+        // the size of the text, which starts at (0, 0)
+        QSizeF size;
+        // set for plain text only
+        QStaticText staticText;
+
+        bool isPlainText() const
+        {
+            return !staticText.text().isEmpty();
+        }
+    };
+
+    /**
+     * The layout of \a text in \a font on \a device, or on the screen if
+     * \a device is null.
+     */
+    Layout layout(const QString &text, const QFont &font, const QPaintDevice *device = nullptr);
+
+    /**
+     * Paints \a text with its top left corner at (0, 0) in the color of the
+     * text role of \a palette, like QTextDocument does.
+     */
+    void draw(QPainter *painter, const QString &text, const QFont &font, const QPalette &palette);
+
+    void clear();
+
+    // the number of texts whose layouts are cached
+    int count() const
+    {
+        return m_layouts.count();
+    }
+
+    // the cache is dropped when it grows beyond this, e.g. for a diagram whose
+    // labels all differ
+    static constexpr int MaxLayouts = 2048;
+
+private:
+    struct Key
+    {
+        QString text;
+        QFont font;
+        int dpiX;
+        int dpiY;
+
+        bool operator==(const Key &other) const
+        {
+            return text == other.text && dpiX == other.dpiX && dpiY == other.dpiY && font == other.font;
+        }
+
+        friend size_t qHash(const Key &key, size_t seed = 0) noexcept
+        {
+            return qHash(key.text, seed) ^ qHash(key.font, seed) ^ qHash(key.dpiX * 4099 + key.dpiY, seed);
+        }
+    };
+
+    QHash<Key, Layout> m_layouts;
+};
+}
+
+#endif
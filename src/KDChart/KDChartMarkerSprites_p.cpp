@@ -0,0 +1,349 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#include "KDChartMarkerSprites_p.h"
+
+#include "KDChartPainterSaver_p.h"
+#include "KDChartPrintingParameters.h"
+
+#include <QCoreApplication>
+#include <QPaintEngine>
+#include <QRadialGradient>
+#include <QThread>
+
+#include <KDABLibFakes>
+
+using namespace KDChart;
+
+static const int AtlasSide = 512;
+// larger markers are drawn as vector graphics
+static const int MaxSpriteSide = 128;
+
+// true if painter rasterizes, so that blitting sprites looks the same as drawing
+static bool isRasterEngine(QPainter *painter)
+{
+    const QPaintEngine *engine = painter->paintEngine();
+    if (!engine) {
+        return false;
+    }
+    switch (engine->type()) {
+    case QPaintEngine::Raster:
+    case QPaintEngine::OpenGL:
+    case QPaintEngine::OpenGL2:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// pixmaps may only be used in the GUI thread, charts rendered elsewhere draw vector markers
+static bool isGuiThread()
+{
+    const QCoreApplication *app = QCoreApplication::instance();
+    return app && QThread::currentThread() == app->thread();
+}
+
+// true if painting with brush does not depend on where it is painted
+static bool isPlain(const QBrush &brush)
+{
+    return brush.style() == Qt::NoBrush || brush.style() == Qt::SolidPattern;
+}
+
+bool MarkerSprites::paint(QPainter *painter, const MarkerAttributes &attributes, const QBrush &brush,
+                          const QPen &pen, const QPointF &pos, const QSizeF &size)
+{
+    if (attributes.markerStyle() == MarkerAttributes::NoMarker) {
+        return true;
+    }
+    if (!isRasterEngine(painter) || !isGuiThread() || !isPlain(brush) || (pen.style() != Qt::NoPen && !isPlain(pen.brush()))) {
+        // the caller draws this marker right away, on top of the ones before it
+        paintPending(painter);
+        return false;
+    }
+    const QTransform transform = painter->combinedTransform();
+    if (transform.type() > QTransform::TxScale || transform.m11() <= 0.0 || transform.m22() <= 0.0) {
+        paintPending(painter);
+        return false;
+    }
+    const qreal ratio = painter->device()->devicePixelRatioF();
+    const qreal scaleX = transform.m11() * ratio;
+    const qreal scaleY = transform.m22() * ratio;
+    const Sprite *sprite = findOrAdd(painter, attributes, brush, pen, size, scaleX, scaleY);
+    if (!sprite) {
+        paintPending(painter);
+        return false;
+    }
+
+    const QPointF center = sprite->deviceBounds.center();
+    const QPainter::PixmapFragment fragment = QPainter::PixmapFragment::create(
+        pos + QPointF(center.x() / scaleX, center.y() / scaleY), QRectF(sprite->source),
+        1.0 / scaleX, 1.0 / scaleY);
+    if (!m_batching) {
+        painter->drawPixmapFragments(&fragment, 1, m_atlas);
+        return true;
+    }
+    if (!m_fragments.isEmpty() && painter->worldTransform() != m_batchTransform) {
+        paintPending(painter);
+    }
+    m_batchTransform = painter->worldTransform();
+    m_fragments.append(fragment);
+    return true;
+}
+
+void MarkerSprites::beginBatch()
+{
+    m_batching = true;
+}
+
+void MarkerSprites::flush(QPainter *painter)
+{
+    m_batching = false;
+    paintPending(painter);
+}
+
+void MarkerSprites::paintPending(QPainter *painter)
+{
+    if (m_fragments.isEmpty()) {
+        return;
+    }
+    const PainterSaver painterSaver(painter);
+    painter->setWorldTransform(m_batchTransform);
+    painter->drawPixmapFragments(m_fragments.constData(), m_fragments.count(), m_atlas);
+    m_fragments.clear();
+}
+
+void MarkerSprites::clear()
+{
+    m_atlas = QPixmap();
+    m_sprites.clear();
+    m_lastSprite = -1;
+    m_shelfX = 0;
+    m_shelfY = 0;
+    m_shelfHeight = 0;
+    m_fragments.clear();
+}
+
+const MarkerSprites::Sprite *MarkerSprites::findOrAdd(QPainter *painter, const MarkerAttributes &attributes,
+                                                      const QBrush &brush, const QPen &pen, const QSizeF &size,
+                                                      qreal scaleX, qreal scaleY)
+{
+    const MarkerAttributes::MarkerStyle style = attributes.markerStyle();
+    // the pen as paintShape() uses it
+    const QPen scaledPen = PrintingParameters::scalePen(pen);
+    const QPainterPath path = style == MarkerAttributes::PainterPathMarker ? attributes.customMarkerPath() : QPainterPath();
+    const auto matches = [&](const Sprite &sprite) {
+        return sprite.style == style && sprite.threeD == attributes.threeD() && sprite.size == size
+            && sprite.scaleX == scaleX && sprite.scaleY == scaleY && sprite.brush == brush
+            && sprite.pen == scaledPen && sprite.path == path;
+    };
+    // the markers of a dataset usually look the same, so try the last one first
+    if (m_lastSprite >= 0 && matches(m_sprites.at(m_lastSprite))) {
+        return &m_sprites.at(m_lastSprite);
+    }
+    for (int i = 0; i < m_sprites.count(); ++i) {
+        if (matches(m_sprites.at(i))) {
+            m_lastSprite = i;
+            return &m_sprites.at(i);
+        }
+    }
+
+    // the area that paintShape() paints, around the center of the marker
+    QRectF bounds;
+    // rings, crosses and paths are outlined in the color of the brush
+    qreal outlineWidth = PrintingParameters::scalePen(QPen(brush.color())).widthF();
+    if (style == MarkerAttributes::PainterPathMarker) {
+        const QRectF pathRect = path.boundingRect();
+        const qreal scaling = qMin(size.height() / pathRect.height(), size.width() / pathRect.width());
+        if (!qIsFinite(scaling)) {
+            return nullptr;
+        }
+        bounds = QRectF(pathRect.topLeft() * scaling, pathRect.size() * scaling);
+        // the outline is scaled along with the path
+        outlineWidth *= scaling;
+    } else {
+        const qreal extent = qMax(size.width(), size.height());
+        bounds = QRectF(-0.5 * extent, -0.5 * extent, extent, extent);
+    }
+    QRectF deviceBounds(bounds.left() * scaleX, bounds.top() * scaleY,
+                        bounds.width() * scaleX, bounds.height() * scaleY);
+    // room for the pen, including mitered corners, and for antialiasing
+    const qreal maxScale = qMax(qMax(scaleX, scaleY), qreal(1.0));
+    const qreal penWidth = qMax(qMax(scaledPen.widthF(), outlineWidth), qreal(1.0)) * maxScale;
+    deviceBounds.adjust(-penWidth - 2.0, -penWidth - 2.0, penWidth + 2.0, penWidth + 2.0);
+    if (!deviceBounds.isValid() || deviceBounds.width() > MaxSpriteSide || deviceBounds.height() > MaxSpriteSide) {
+        return nullptr;
+    }
+    const QRect alignedBounds = deviceBounds.toAlignedRect();
+
+    QRect source;
+    if (!allocate(alignedBounds.size(), &source)) {
+        // the atlas is full: paint what refers to it, and start over
+        if (m_batching) {
+            flush(painter);
+            m_batching = true;
+        }
+        clear();
+        if (!allocate(alignedBounds.size(), &source)) {
+            return nullptr;
+        }
+    }
+
+    {
+        QPainter atlasPainter(&m_atlas);
+        atlasPainter.setCompositionMode(QPainter::CompositionMode_Source);
+        atlasPainter.fillRect(source, Qt::transparent);
+        atlasPainter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        atlasPainter.setClipRect(source);
+        atlasPainter.translate(source.topLeft() - alignedBounds.topLeft());
+        atlasPainter.scale(scaleX, scaleY);
+        atlasPainter.setRenderHints(painter->renderHints());
+        paintShape(&atlasPainter, attributes, brush, pen, size);
+    }
+
+    const Sprite sprite = { style, attributes.threeD(), size, scaleX, scaleY, scaledPen, brush, path,
+                            QRectF(alignedBounds), source };
+    m_sprites.append(sprite);
+    m_lastSprite = m_sprites.count() - 1;
+    return &m_sprites.last();
+}
+
+bool MarkerSprites::allocate(const QSize &size, QRect *source)
+{
+    if (m_atlas.isNull()) {
+        m_atlas = QPixmap(AtlasSide, AtlasSide);
+        m_atlas.fill(Qt::transparent);
+    }
+    if (m_shelfX + size.width() > AtlasSide) {
+        m_shelfX = 0;
+        m_shelfY += m_shelfHeight;
+        m_shelfHeight = 0;
+    }
+    if (m_shelfY + size.height() > AtlasSide) {
+        return false;
+    }
+    *source = QRect(QPoint(m_shelfX, m_shelfY), size);
+    // leave a pixel between the sprites, so that none bleeds into another
+    m_shelfX += size.width() + 1;
+    m_shelfHeight = qMax(m_shelfHeight, size.height() + 1);
+    return true;
+}
+
+void MarkerSprites::paintShape(QPainter *painter, const MarkerAttributes &attributes,
+                               const QBrush &brush, const QPen &pen, const QSizeF &maSize)
+{
+    painter->setPen(PrintingParameters::scalePen(pen));
+    painter->setBrush(brush);
+    painter->setRenderHint(QPainter::Antialiasing);
+    switch (attributes.markerStyle()) {
+    case MarkerAttributes::MarkerCircle: {
+        if (attributes.threeD()) {
+            QRadialGradient grad;
+            grad.setCoordinateMode(QGradient::ObjectBoundingMode);
+            QColor drawColor = brush.color();
+            grad.setCenter(0.5, 0.5);
+            grad.setRadius(1.0);
+            grad.setFocalPoint(0.35, 0.35);
+            grad.setColorAt(0.00, drawColor.lighter(150));
+            grad.setColorAt(0.20, drawColor);
+            grad.setColorAt(0.50, drawColor.darker(150));
+            grad.setColorAt(0.75, drawColor.darker(200));
+            grad.setColorAt(0.95, drawColor.darker(250));
+            grad.setColorAt(1.00, drawColor.darker(200));
+            QBrush newBrush(grad);
+            newBrush.setTransform(brush.transform());
+            painter->setBrush(newBrush);
+        }
+        painter->drawEllipse(QRectF(0 - maSize.height() / 2, 0 - maSize.width() / 2,
+                                    maSize.height(), maSize.width()));
+    } break;
+    case MarkerAttributes::MarkerSquare: {
+        QRectF rect(0 - maSize.width() / 2, 0 - maSize.height() / 2,
+                    maSize.width(), maSize.height());
+        painter->drawRect(rect);
+        break;
+    }
+    case MarkerAttributes::MarkerDiamond: {
+        QVector<QPointF> diamondPoints;
+        QPointF top, left, bottom, right;
+        top = QPointF(0, 0 - maSize.height() / 2);
+        left = QPointF(0 - maSize.width() / 2, 0);
+        bottom = QPointF(0, maSize.height() / 2);
+        right = QPointF(maSize.width() / 2, 0);
+        diamondPoints << top << left << bottom << right;
+        painter->drawPolygon(diamondPoints);
+        break;
+    }
+    // both handled by AbstractDiagram::paintMarker():
+    case MarkerAttributes::Marker1Pixel:
+    case MarkerAttributes::Marker4Pixels:
+        break;
+    case MarkerAttributes::MarkerRing: {
+        painter->setBrush(Qt::NoBrush);
+        painter->setPen(PrintingParameters::scalePen(QPen(brush.color())));
+        painter->drawEllipse(QRectF(0 - maSize.height() / 2, 0 - maSize.width() / 2,
+                                    maSize.height(), maSize.width()));
+        break;
+    }
+    case MarkerAttributes::MarkerCross: {
+        // Note: Markers can have outline,
+        //       so just drawing two rects is NOT the solution here!
+        const qreal w02 = maSize.width() * 0.2;
+        const qreal w05 = maSize.width() * 0.5;
+        const qreal h02 = maSize.height() * 0.2;
+        const qreal h05 = maSize.height() * 0.5;
+        QVector<QPointF> crossPoints;
+        QPointF p[12];
+        p[0] = QPointF(-w02, -h05);
+        p[1] = QPointF(w02, -h05);
+        p[2] = QPointF(w02, -h02);
+        p[3] = QPointF(w05, -h02);
+        p[4] = QPointF(w05, h02);
+        p[5] = QPointF(w02, h02);
+        p[6] = QPointF(w02, h05);
+        p[7] = QPointF(-w02, h05);
+        p[8] = QPointF(-w02, h02);
+        p[9] = QPointF(-w05, h02);
+        p[10] = QPointF(-w05, -h02);
+        p[11] = QPointF(-w02, -h02);
+        for (int i = 0; i < 12; ++i)
+            crossPoints << p[i];
+        crossPoints << p[0];
+        painter->drawPolygon(crossPoints);
+        break;
+    }
+    case MarkerAttributes::MarkerFastCross: {
+        QPointF left, right, top, bottom;
+        left = QPointF(-maSize.width() / 2, 0);
+        right = QPointF(maSize.width() / 2, 0);
+        top = QPointF(0, -maSize.height() / 2);
+        bottom = QPointF(0, maSize.height() / 2);
+        painter->setPen(PrintingParameters::scalePen(QPen(brush.color())));
+        painter->drawLine(left, right);
+        painter->drawLine(top, bottom);
+        break;
+    }
+    case MarkerAttributes::NoMarker:
+        break;
+    case MarkerAttributes::PainterPathMarker: {
+        QPainterPath path = attributes.customMarkerPath();
+        const QRectF pathBoundingRect = path.boundingRect();
+        const qreal xScaling = maSize.height() / pathBoundingRect.height();
+        const qreal yScaling = maSize.width() / pathBoundingRect.width();
+        const qreal scaling = qMin(xScaling, yScaling);
+        painter->scale(scaling, scaling);
+        painter->setPen(PrintingParameters::scalePen(QPen(brush.color())));
+        painter->drawPath(path);
+        break;
+    }
+    default:
+        Q_ASSERT_X(false, "paintMarkers()",
+                   "Type item does not match a defined Marker Type.");
+    }
+}
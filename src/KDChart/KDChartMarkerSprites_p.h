@@ -0,0 +1,109 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#ifndef KDCHARTMARKERSPRITES_P_H
+#define KDCHARTMARKERSPRITES_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the KD Chart API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QBrush>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPen>
+#include <QPixmap>
+#include <QTransform>
+#include <QVector>
+
+#include "KDChartMarkerAttributes.h"
+
+namespace KDChart {
+
+/**
+ * \internal
+ * Paints markers from an atlas of prerendered sprites.
+ *
+ * Each distinct marker (style, size, pen, brush and scale of the painter)
+ * is rendered once into the atlas. Between beginBatch() and flush(), the
+ * markers are collected and blitted with a single drawPixmapFragments()
+ * call. Sprites are only used on raster paint engines; on printers and
+ * other vector devices, markers are drawn as vector graphics.
+ */
+class MarkerSprites
+{
+public:
+    /**
+     * Paints the marker centered at \a pos, from a sprite if that is possible.
+     * \return false if the marker has to be drawn with paintShape() instead,
+     * in which case the sprites collected before it have been painted
+     */
+    bool paint(QPainter *painter, const MarkerAttributes &attributes, const QBrush &brush,
+               const QPen &pen, const QPointF &pos, const QSizeF &size);
+
+    // collects the sprites painted until flush()
+    void beginBatch();
+    // paints the sprites collected since beginBatch()
+    void flush(QPainter *painter);
+    // paints the sprites collected so far and keeps collecting, call this
+    // before drawing anything that has to appear on top of them
+    void paintPending(QPainter *painter);
+
+    void clear();
+
+    /**
+     * Draws the marker centered at the origin as vector graphics.
+     */
+    static void paintShape(QPainter *painter, const MarkerAttributes &attributes,
+                           const QBrush &brush, const QPen &pen, const QSizeF &size);
+
+private:
+    struct Sprite
+    {
+        MarkerAttributes::MarkerStyle style;
+        bool threeD;
+        QSizeF size;
+        qreal scaleX;
+        qreal scaleY;
+        QPen pen;
+        QBrush brush;
+        QPainterPath path;
+        // the sprite in device pixels, relative to the center of the marker
+        QRectF deviceBounds;
+        // the sprite in the atlas
+        QRect source;
+    };
+
+    const Sprite *findOrAdd(QPainter *painter, const MarkerAttributes &attributes, const QBrush &brush,
+                            const QPen &pen, const QSizeF &size, qreal scaleX, qreal scaleY);
+    bool allocate(const QSize &size, QRect *source);
+
+    QPixmap m_atlas;
+    QVector<Sprite> m_sprites;
+    int m_lastSprite = -1;
+    // the shelf that sprites are added to
+    int m_shelfX = 0;
+    int m_shelfY = 0;
+    int m_shelfHeight = 0;
+
+    bool m_batching = false;
+    QTransform m_batchTransform;
+    QVector<QPainter::PixmapFragment> m_fragments;
+};
+}
+
+#endif
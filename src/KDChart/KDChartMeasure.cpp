@@ -16,6 +16,7 @@
 #include <KDChartBackgroundAttributes.h>
 #include <KDChartCartesianCoordinatePlane.h>
 #include <KDChartFrameAttributes.h>
+#include <KDChartPaintContext.h>
 #include <KDChartTextAttributes.h>
 
 #include <KDABLibFakes>
@@ -189,6 +190,8 @@ void GlobalMeasureScaling::resetFactors()
 
 const QPair<qreal, qreal> GlobalMeasureScaling::currentFactors()
 {
+    if (const PaintContext *context = PaintContext::current())
+        return context->measureFactors();
     return instance()->mFactors.top();
 }
 
@@ -199,6 +202,8 @@ void GlobalMeasureScaling::setPaintDevice(QPaintDevice *paintDevice)
 
 QPaintDevice *GlobalMeasureScaling::paintDevice()
 {
+    if (const PaintContext *context = PaintContext::current())
+        return context->fontMetricsDevice();
     return instance()->m_paintDevice;
 }
 }
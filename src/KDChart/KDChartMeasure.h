@@ -144,9 +144,10 @@ private:
  *
  * Normally there should be no need to call any of these methods yourself.
  *
- * They are used by KDChart::Chart::paint( QPainter*, const QRect& )
- * to adjust all of the relative Measures according to the target
- * rectangle's size.
+ * KDChart::Chart::paint( QPainter*, const QRect& ) adjusts all of the
+ * relative Measures to the target rectangle's size through the
+ * PaintContext it renders with. While that PaintContext is current,
+ * its factors and paint device take precedence over the ones set here.
  *
  * Default factors are (1.0, 1.0)
  */
@@ -10,10 +10,44 @@
 
 #include "KDChartModelDataCache_p.h"
 
+#include "KDChartAttributesModel.h"
+
+#include <algorithm>
 #include <limits>
 
 using namespace KDChart::ModelDataCachePrivate;
 
+void KDChart::ModelDataCachePrivate::clearBits(quint64 *words, int first, int end)
+{
+    if (first >= end)
+        return;
+
+    const int firstWord = first / BitsPerWord;
+    const int lastWord = (end - 1) / BitsPerWord;
+    // the bits from first on in the first word, and up to end - 1 in the last word
+    const quint64 firstMask = ~quint64(0) << (first % BitsPerWord);
+    const quint64 lastMask = ~quint64(0) >> (BitsPerWord - 1 - (end - 1) % BitsPerWord);
+    if (firstWord == lastWord) {
+        words[firstWord] &= ~(firstMask & lastMask);
+        return;
+    }
+    words[firstWord] &= ~firstMask;
+    std::fill(words + firstWord + 1, words + lastWord, quint64(0));
+    words[lastWord] &= ~lastMask;
+}
+
+void KDChart::ModelDataCachePrivate::shiftBitsDown(quint64 *words, int wordCount, int count)
+{
+    const int wordShift = count / BitsPerWord;
+    const int bitShift = count % BitsPerWord;
+    for (int i = 0; i < wordCount; ++i) {
+        const int source = i + wordShift;
+        const quint64 low = source < wordCount ? words[source] : 0;
+        const quint64 high = source + 1 < wordCount ? words[source + 1] : 0;
+        words[i] = bitShift == 0 ? low : (low >> bitShift) | (high << (BitsPerWord - bitShift));
+    }
+}
+
 ModelSignalMapperConnector::ModelSignalMapperConnector(ModelSignalMapper &mapper)
     : QObject(nullptr)
     , m_mapper(mapper)
@@ -34,6 +68,9 @@ void ModelSignalMapperConnector::connectSignals(QAbstractItemModel *model)
     connect(model, &QAbstractItemModel::modelReset, this, &ModelSignalMapperConnector::modelReset);
     connect(model, &QAbstractItemModel::rowsInserted, this, &ModelSignalMapperConnector::rowsInserted);
     connect(model, &QAbstractItemModel::rowsRemoved, this, &ModelSignalMapperConnector::rowsRemoved);
+    // attributes like DataHiddenRole are announced separately
+    if (auto *attributesModel = qobject_cast<KDChart::AttributesModel *>(model))
+        connect(attributesModel, &KDChart::AttributesModel::attributesChanged, this, &ModelSignalMapperConnector::attributesChanged);
 }
 
 void ModelSignalMapperConnector::disconnectSignals(QAbstractItemModel *model)
@@ -46,6 +83,8 @@ void ModelSignalMapperConnector::disconnectSignals(QAbstractItemModel *model)
     disconnect(model, &QAbstractItemModel::modelReset, this, &ModelSignalMapperConnector::modelReset);
     disconnect(model, &QAbstractItemModel::rowsInserted, this, &ModelSignalMapperConnector::rowsInserted);
     disconnect(model, &QAbstractItemModel::rowsRemoved, this, &ModelSignalMapperConnector::rowsRemoved);
+    if (auto *attributesModel = qobject_cast<KDChart::AttributesModel *>(model))
+        disconnect(attributesModel, &KDChart::AttributesModel::attributesChanged, this, &ModelSignalMapperConnector::attributesChanged);
 }
 
 void ModelSignalMapperConnector::resetModel()
@@ -87,3 +126,8 @@ void ModelSignalMapperConnector::rowsRemoved(const QModelIndex &parent, int star
 {
     m_mapper.rowsRemoved(parent, start, end);
 }
+
+void ModelSignalMapperConnector::attributesChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    m_mapper.attributesChanged(topLeft, bottomRight);
+}
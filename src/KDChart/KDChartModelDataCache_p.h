@@ -11,18 +11,17 @@
 #ifndef KDCHARTMODELDATACACHE_H
 #define KDCHARTMODELDATACACHE_H
 
+#include <algorithm>
 #include <limits>
+#include <utility>
 
+#include <QAbstractItemModel>
 #include <QModelIndex>
 #include <QObject>
 #include <QVector>
 
 #include "kdchart_export.h"
 
-QT_BEGIN_NAMESPACE
-class QAbstractItemModel;
-QT_END_NAMESPACE
-
 namespace KDChart {
 namespace ModelDataCachePrivate {
 class KDCHART_EXPORT ModelSignalMapper
@@ -44,6 +43,7 @@ public:
     virtual void modelReset() = 0;
     virtual void rowsInserted(const QModelIndex &, int, int) = 0;
     virtual void rowsRemoved(const QModelIndex &, int, int) = 0;
+    virtual void attributesChanged(const QModelIndex &, const QModelIndex &) = 0;
 };
 
 // this class maps slots to a non-QObject instantiating ModelSignalMapper
@@ -66,6 +66,7 @@ protected Q_SLOTS:
     void modelReset();
     void rowsInserted(const QModelIndex &, int, int);
     void rowsRemoved(const QModelIndex &, int, int);
+    void attributesChanged(const QModelIndex &, const QModelIndex &);
 
 private:
     ModelSignalMapper &m_mapper;
@@ -82,6 +83,14 @@ inline qreal nan<qreal>()
 {
     return std::numeric_limits<qreal>::quiet_NaN();
 }
+
+// number of bits per word of a validity bitset
+const int BitsPerWord = 64;
+
+// clears bits [first, end) of a bitset
+KDCHART_EXPORT void clearBits(quint64 *words, int first, int end);
+// moves every bit down by count positions, filling up with cleared bits
+KDCHART_EXPORT void shiftBitsDown(quint64 *words, int wordCount, int count);
 }
 
 template<class T, int ROLE>
@@ -99,31 +108,8 @@ public:
 
     T data(const QModelIndex &index) const
     {
-        if (!index.isValid() || index.parent() != m_rootIndex || index.row() >= m_model->rowCount(m_rootIndex) || index.column() >= m_model->columnCount(m_rootIndex))
+        if (!checkIndex(index))
             return ModelDataCachePrivate::nan<T>();
-
-        if (index.row() >= m_data.count()) {
-            qWarning("KDChart didn't receive signal rowsInserted, resetModel or layoutChanged, "
-                     "but an index with a row outside of the known bounds.");
-
-            // apparently, data were added behind our back (w/o signals)
-            const_cast<ModelDataCache<T, ROLE> *>(this)->rowsInserted(m_rootIndex,
-                                                                      m_data.count(),
-                                                                      m_model->rowCount(m_rootIndex) - 1);
-            Q_ASSERT(index.row() < m_data.count());
-        }
-
-        if (index.column() >= m_data.first().count()) {
-            qWarning("KDChart didn't got signal columnsInserted, resetModel or layoutChanged, "
-                     "but an index with a column outside of the known bounds.");
-
-            // apparently, data were added behind our back (w/o signals)
-            const_cast<ModelDataCache<T, ROLE> *>(this)->columnsInserted(m_rootIndex,
-                                                                         m_data.first().count(),
-                                                                         m_model->columnCount(m_rootIndex) - 1);
-            Q_ASSERT(index.column() < m_data.first().count());
-        }
-
         return data(index.row(), index.column());
     }
 
@@ -135,13 +121,68 @@ public:
         Q_ASSERT(row < m_model->rowCount(m_rootIndex));
         Q_ASSERT(column < m_model->columnCount(m_rootIndex));
 
-        Q_ASSERT(row < m_data.count());
-        Q_ASSERT(column < m_data.first().count());
+        Q_ASSERT(row < m_rowCount);
+        Q_ASSERT(column < m_columnSlots.count());
 
         if (isCached(row, column))
-            return m_data.at(row).at(column);
+            return m_values.at(valueOffset(row, column));
 
-        return fetchFromModel(row, column, ROLE);
+        return fetchFromModel(row, column);
+    }
+
+    // Besides the values, also cache a boolean role like DataHiddenRole for every cell.
+    // Both are fetched together, see prefetch().
+    void setFlagRole(int role)
+    {
+        m_flagRole = role;
+        modelReset();
+    }
+
+    int flagRole() const
+    {
+        return m_flagRole;
+    }
+
+    bool flag(const QModelIndex &index) const
+    {
+        Q_ASSERT(m_flagRole != -1);
+        if (!checkIndex(index))
+            return false;
+        return flag(index.row(), index.column());
+    }
+
+    bool flag(int row, int column) const
+    {
+        Q_ASSERT(m_flagRole != -1);
+        Q_ASSERT(row >= 0 && row < m_rowCount);
+        Q_ASSERT(column >= 0 && column < m_columnSlots.count());
+
+        if (!isCached(row, column))
+            fetchFromModel(row, column);
+        return testBit(m_flags, row, column);
+    }
+
+    // Fetches all values (and flags) of the rows [firstRow, endRow) of a column
+    // that are not cached yet, in one pass over the model.
+    void prefetch(int column, int firstRow, int endRow) const
+    {
+        if (m_model == nullptr || column < 0 || column >= m_columnSlots.count())
+            return;
+        firstRow = qMax(0, firstRow);
+        endRow = qMin(endRow, m_rowCount);
+
+        const quint64 *valid = m_valid.constData() + m_columnSlots.at(column) * wordsPerColumn();
+        int row = firstRow;
+        while (row < endRow) {
+            // skip words whose rows are all cached
+            if (row % ModelDataCachePrivate::BitsPerWord == 0 && valid[row / ModelDataCachePrivate::BitsPerWord] == ~quint64(0)) {
+                row += ModelDataCachePrivate::BitsPerWord;
+                continue;
+            }
+            if (!isCached(row, column))
+                fetchFromModel(row, column);
+            ++row;
+        }
     }
 
     void setModel(QAbstractItemModel *model)
@@ -174,23 +215,103 @@ public:
         return m_rootIndex;
     }
 
+    // the model dropped count rows at the top and appended as many at the bottom
+    // (see RingBufferModel::rowsShifted()), slide the cached values accordingly
+    void rowsShifted(int count)
+    {
+        if (m_model == nullptr || count <= 0)
+            return;
+
+        if (count >= m_rowCount) {
+            modelReset();
+        } else {
+            for (int slot : std::as_const(m_columnSlots)) {
+                T *values = m_values.data() + slot * m_rowCapacity;
+                std::move(values + count, values + m_rowCount, values);
+                ModelDataCachePrivate::shiftBitsDown(validityWords(slot), wordsPerColumn(), count);
+                if (m_flagRole != -1)
+                    ModelDataCachePrivate::shiftBitsDown(m_flags.data() + slot * wordsPerColumn(), wordsPerColumn(), count);
+            }
+        }
+        // the dataChanged() for the whole table that follows is already taken care of
+        m_shiftPending = true;
+    }
+
+    // the memory held by the cache, in bytes
+    qint64 allocatedBytes() const
+    {
+        return qint64(m_values.capacity()) * qint64(sizeof(T))
+            + qint64(m_valid.capacity() + m_flags.capacity()) * qint64(sizeof(quint64))
+            + qint64(m_columnSlots.capacity() + m_freeSlots.capacity()) * qint64(sizeof(int));
+    }
+
 protected:
+    bool checkIndex(const QModelIndex &index) const
+    {
+        if (!index.isValid() || index.parent() != m_rootIndex || index.row() >= m_model->rowCount(m_rootIndex) || index.column() >= m_model->columnCount(m_rootIndex))
+            return false;
+
+        if (index.row() >= m_rowCount) {
+            qWarning("KDChart didn't receive signal rowsInserted, resetModel or layoutChanged, "
+                     "but an index with a row outside of the known bounds.");
+
+            // apparently, data were added behind our back (w/o signals)
+            const_cast<ModelDataCache<T, ROLE> *>(this)->rowsInserted(m_rootIndex,
+                                                                      m_rowCount,
+                                                                      m_model->rowCount(m_rootIndex) - 1);
+            Q_ASSERT(index.row() < m_rowCount);
+        }
+
+        if (index.column() >= m_columnSlots.count()) {
+            qWarning("KDChart didn't got signal columnsInserted, resetModel or layoutChanged, "
+                     "but an index with a column outside of the known bounds.");
+
+            // apparently, data were added behind our back (w/o signals)
+            const_cast<ModelDataCache<T, ROLE> *>(this)->columnsInserted(m_rootIndex,
+                                                                         m_columnSlots.count(),
+                                                                         m_model->columnCount(m_rootIndex) - 1);
+            Q_ASSERT(index.column() < m_columnSlots.count());
+        }
+        return true;
+    }
+
     bool isCached(int row, int column) const
     {
-        return m_cacheValid.at(row).at(column);
+        return testBit(m_valid, row, column);
     }
 
-    T fetchFromModel(int row, int column, int role) const
+    T fetchFromModel(int row, int column) const
     {
         Q_ASSERT(m_model != nullptr);
 
         const QModelIndex index = m_model->index(row, column, m_rootIndex);
-        const QVariant data = index.data(role);
+        bool flag = false;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        // one call for the value and the flag, instead of one data() call each
+        QModelRoleData roleData[2] = {QModelRoleData(ROLE), QModelRoleData(m_flagRole)};
+        m_model->multiData(index, QModelRoleDataSpan(roleData, m_flagRole == -1 ? 1 : 2));
+        const QVariant &data = roleData[0].data();
+        if (m_flagRole != -1)
+            flag = roleData[1].data().value<bool>();
+#else
+        const QVariant data = index.data(ROLE);
+        if (m_flagRole != -1)
+            flag = index.data(m_flagRole).value<bool>();
+#endif
         const T value = data.isNull() ? ModelDataCachePrivate::nan<T>()
                                       : (data.value<T>());
 
-        m_data[row][column] = value;
-        m_cacheValid[row][column] = true;
+        const int slot = m_columnSlots.at(column);
+        const int word = slot * wordsPerColumn() + row / ModelDataCachePrivate::BitsPerWord;
+        const quint64 bit = quint64(1) << (row % ModelDataCachePrivate::BitsPerWord);
+        m_values[slot * m_rowCapacity + row] = value;
+        m_valid[word] |= bit;
+        if (m_flagRole != -1) {
+            if (flag)
+                m_flags[word] |= bit;
+            else
+                m_flags[word] &= ~bit;
+        }
 
         return value;
     }
@@ -206,13 +327,10 @@ protected:
         Q_ASSERT(start <= end);
         Q_ASSERT(start <= m_model->columnCount(m_rootIndex));
 
-        const int rowCount = m_data.count();
-        for (int row = 0; row < rowCount; ++row) {
-            m_data[row].insert(start, end - start + 1, T());
-            m_cacheValid[row].insert(start, end - start + 1, false);
-            Q_ASSERT(m_data.at(row).count() == m_model->columnCount(m_rootIndex));
-            Q_ASSERT(m_cacheValid.at(row).count() == m_model->columnCount(m_rootIndex));
-        }
+        // new columns get a free column slot of the storage, no values are moved
+        for (int column = start; column <= end; ++column)
+            m_columnSlots.insert(column, allocateSlot());
+        Q_ASSERT(m_columnSlots.count() == m_model->columnCount(m_rootIndex));
     }
 
     void columnsRemoved(const QModelIndex &parent, int start, int end) override
@@ -225,13 +343,13 @@ protected:
 
         Q_ASSERT(start <= end);
 
-        const int rowCount = m_data.count();
-        for (int row = 0; row < rowCount; ++row) {
-            m_data[row].remove(start, end - start + 1);
-            m_cacheValid[row].remove(start, end - start + 1);
-            Q_ASSERT(m_data.at(row).count() == m_model->columnCount(m_rootIndex));
-            Q_ASSERT(m_cacheValid.at(row).count() == m_model->columnCount(m_rootIndex));
+        for (int column = start; column <= end; ++column) {
+            const int slot = m_columnSlots.at(column);
+            ModelDataCachePrivate::clearBits(validityWords(slot), 0, m_rowCount);
+            m_freeSlots.append(slot);
         }
+        m_columnSlots.remove(start, end - start + 1);
+        Q_ASSERT(m_columnSlots.count() == m_model->columnCount(m_rootIndex));
     }
 
     void dataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight) override
@@ -244,6 +362,28 @@ protected:
         if (!topLeft.isValid() || !bottomRight.isValid() || topLeft.parent() != m_rootIndex)
             return;
 
+        if (m_shiftPending) {
+            m_shiftPending = false;
+            if (topLeft.row() == 0 && topLeft.column() == 0 && bottomRight.row() == m_rowCount - 1
+                && bottomRight.column() == m_columnSlots.count() - 1)
+                return;
+        }
+
+        invalidate(topLeft, bottomRight);
+    }
+
+    void attributesChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight) override
+    {
+        // only the flags can depend on attributes
+        if (!m_model || m_flagRole == -1)
+            return;
+        if (!topLeft.isValid() || !bottomRight.isValid() || topLeft.parent() != m_rootIndex)
+            return;
+        invalidate(topLeft, bottomRight);
+    }
+
+    void invalidate(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+    {
         Q_ASSERT(topLeft.model() == m_model && bottomRight.model() == m_model);
 
         const int minRow = qMax(0, topLeft.row());
@@ -256,11 +396,9 @@ protected:
         Q_ASSERT(maxRow < m_model->rowCount(m_rootIndex));
         Q_ASSERT(maxCol < m_model->columnCount(m_rootIndex));
 
-        for (int row = minRow; row <= maxRow; ++row) {
-            for (int col = minCol; col <= maxCol; ++col) {
-                m_cacheValid[row][col] = false;
-                Q_ASSERT(!isCached(row, col));
-            }
+        for (int col = minCol; col <= maxCol; ++col) {
+            ModelDataCachePrivate::clearBits(validityWords(m_columnSlots.at(col)), minRow, maxRow + 1);
+            Q_ASSERT(!isCached(minRow, col));
         }
     }
 
@@ -271,19 +409,25 @@ protected:
 
     void modelReset() override
     {
-        m_data.clear();
-        m_cacheValid.clear();
+        m_values.clear();
+        m_valid.clear();
+        m_flags.clear();
+        m_columnSlots.clear();
+        m_freeSlots.clear();
+        m_rowCount = 0;
+        m_rowCapacity = 0;
+        m_slotCount = 0;
 
         if (m_model == nullptr)
             return;
 
         const int columnCount = m_model->columnCount(m_rootIndex);
-        const int rowCount = m_model->rowCount(m_rootIndex);
-        m_data.fill(QVector<T>(columnCount), rowCount);
-        m_cacheValid.fill(QVector<bool>(columnCount, false), rowCount);
+        reserveRows(m_model->rowCount(m_rootIndex));
+        m_rowCount = m_model->rowCount(m_rootIndex);
+        for (int column = 0; column < columnCount; ++column)
+            m_columnSlots.append(allocateSlot());
 
-        Q_ASSERT(m_data.count() == rowCount);
-        Q_ASSERT(m_cacheValid.count() == rowCount);
+        Q_ASSERT(m_columnSlots.count() == columnCount);
     }
 
     void rowsInserted(const QModelIndex &parent, int start, int end) override
@@ -297,12 +441,16 @@ protected:
         Q_ASSERT(start <= end);
         Q_ASSERT(end - start + 1 <= m_model->rowCount(m_rootIndex));
 
-        const int columnCount = m_model->columnCount(m_rootIndex);
-        m_data.insert(start, end - start + 1, QVector<T>(columnCount));
-        m_cacheValid.insert(start, end - start + 1, QVector<bool>(columnCount, false));
+        const int oldRowCount = m_rowCount;
+        reserveRows(m_rowCount + end - start + 1);
+        m_rowCount += end - start + 1;
+        // appended rows are not cached yet, rows inserted before others shift those
+        if (start < oldRowCount) {
+            for (int slot : std::as_const(m_columnSlots))
+                ModelDataCachePrivate::clearBits(validityWords(slot), start, m_rowCount);
+        }
 
-        Q_ASSERT(m_data.count() == m_model->rowCount(m_rootIndex));
-        Q_ASSERT(m_cacheValid.count() == m_model->rowCount(m_rootIndex));
+        Q_ASSERT(m_rowCount == m_model->rowCount(m_rootIndex));
     }
 
     void rowsRemoved(const QModelIndex &parent, int start, int end) override
@@ -310,16 +458,17 @@ protected:
         Q_ASSERT(m_model != nullptr);
         Q_ASSERT(parent.model() == m_model || !parent.isValid());
 
-        if (parent != m_rootIndex || start >= m_data.count())
+        if (parent != m_rootIndex || start >= m_rowCount)
             return;
 
         Q_ASSERT(start <= end);
 
-        m_data.remove(start, end - start + 1);
-        m_cacheValid.remove(start, end - start + 1);
+        // the rows behind the removed ones are read again when needed
+        for (int slot : std::as_const(m_columnSlots))
+            ModelDataCachePrivate::clearBits(validityWords(slot), start, m_rowCount);
+        m_rowCount -= qMin(end, m_rowCount - 1) - start + 1;
 
-        Q_ASSERT(m_data.count() == m_model->rowCount(m_rootIndex));
-        Q_ASSERT(m_cacheValid.count() == m_model->rowCount(m_rootIndex));
+        Q_ASSERT(m_rowCount == m_model->rowCount(m_rootIndex));
     }
 
     void resetModel() override
@@ -330,11 +479,94 @@ protected:
     }
 
 private:
+    int wordsPerColumn() const
+    {
+        return m_rowCapacity / ModelDataCachePrivate::BitsPerWord;
+    }
+
+    int valueOffset(int row, int column) const
+    {
+        return m_columnSlots.at(column) * m_rowCapacity + row;
+    }
+
+    bool testBit(const QVector<quint64> &words, int row, int column) const
+    {
+        const int slot = m_columnSlots.at(column);
+        return (words.at(slot * wordsPerColumn() + row / ModelDataCachePrivate::BitsPerWord)
+                >> (row % ModelDataCachePrivate::BitsPerWord))
+            & 1;
+    }
+
+    quint64 *validityWords(int slot)
+    {
+        return m_valid.data() + slot * wordsPerColumn();
+    }
+
+    // grows the storage of every column slot to at least rowCount rows
+    void reserveRows(int rowCount)
+    {
+        if (rowCount <= m_rowCapacity)
+            return;
+
+        int capacity = qMax(m_rowCapacity, ModelDataCachePrivate::BitsPerWord);
+        while (capacity < rowCount)
+            capacity *= 2;
+        const int words = capacity / ModelDataCachePrivate::BitsPerWord;
+
+        QVector<T> values(m_slotCount * capacity);
+        QVector<quint64> valid(m_slotCount * words, 0);
+        QVector<quint64> flags(m_flagRole == -1 ? 0 : m_slotCount * words, 0);
+        for (int slot = 0; slot < m_slotCount; ++slot) {
+            std::copy(m_values.constData() + slot * m_rowCapacity,
+                      m_values.constData() + slot * m_rowCapacity + m_rowCount,
+                      values.data() + slot * capacity);
+            std::copy(m_valid.constData() + slot * wordsPerColumn(),
+                      m_valid.constData() + (slot + 1) * wordsPerColumn(),
+                      valid.data() + slot * words);
+            if (m_flagRole != -1)
+                std::copy(m_flags.constData() + slot * wordsPerColumn(),
+                          m_flags.constData() + (slot + 1) * wordsPerColumn(),
+                          flags.data() + slot * words);
+        }
+        m_values.swap(values);
+        m_valid.swap(valid);
+        m_flags.swap(flags);
+        m_rowCapacity = capacity;
+    }
+
+    // a column slot whose validity bits are all cleared
+    int allocateSlot()
+    {
+        if (!m_freeSlots.isEmpty())
+            return m_freeSlots.takeLast();
+        if (m_rowCapacity == 0)
+            reserveRows(1);
+        m_values.resize(m_values.size() + m_rowCapacity);
+        m_valid.resize(m_valid.size() + wordsPerColumn());
+        if (m_flagRole != -1)
+            m_flags.resize(m_flags.size() + wordsPerColumn());
+        return m_slotCount++;
+    }
+
     QAbstractItemModel *m_model = nullptr;
     QModelIndex m_rootIndex;
     ModelDataCachePrivate::ModelSignalMapperConnector m_connector;
-    mutable QVector<QVector<T>> m_data;
-    mutable QVector<QVector<bool>> m_cacheValid;
+    // All values, column by column: every column slot holds m_rowCapacity values.
+    // Rows beyond m_rowCount are never marked valid.
+    mutable QVector<T> m_values;
+    // one validity bit per value, m_rowCapacity / BitsPerWord words per column slot
+    mutable QVector<quint64> m_valid;
+    // the flag of every cached value if there is a flag role, same layout as m_valid
+    mutable QVector<quint64> m_flags;
+    int m_flagRole = -1;
+    // the column slot of every model column
+    QVector<int> m_columnSlots;
+    // column slots of removed columns, for reuse
+    QVector<int> m_freeSlots;
+    int m_slotCount = 0;
+    int m_rowCount = 0;
+    int m_rowCapacity = 0;
+    bool m_shiftPending = false;
 };
 }
 
@@ -0,0 +1,150 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#include "KDChartNumberFormatter_p.h"
+
+#include <QByteArray>
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#include <KDABLibFakes>
+
+using namespace KDChart;
+
+// the results are dropped when there are more of them than this
+static const int MaxResults = 512;
+
+// digits after the decimal point formatNumber() used to get from QString::number()
+static const int MaxRoundedDigits = 6;
+
+static const int MaxFixedDigits = 99;
+
+// enough for the integral digits of the largest double, the sign, the
+// decimal point and MaxFixedDigits
+static const int BufferSize = 512;
+
+// Writes value with decimalDigits digits after the decimal point, without a
+// terminating zero, and returns the number of characters written.
+static int writeFixed(char *buffer, qreal value, int decimalDigits)
+{
+#if defined(__cpp_lib_to_chars)
+    const std::to_chars_result result = std::to_chars(buffer, buffer + BufferSize, double(value),
+                                                      std::chars_format::fixed, decimalDigits);
+    if (result.ec == std::errc()) {
+        return int(result.ptr - buffer);
+    }
+#endif
+    const QByteArray fallback = QByteArray::number(value, 'f', decimalDigits);
+    const int length = qMin(int(fallback.size()), BufferSize);
+    memcpy(buffer, fallback.constData(), size_t(length));
+    return length;
+}
+
+NumberFormatter::NumberFormatter(const QLocale &locale)
+    : m_decimalPoint(locale.decimalPoint())
+    , m_minusSign(locale.negativeSign())
+{
+}
+
+QString NumberFormatter::fixed(qreal value, int decimalDigits)
+{
+    if (!std::isfinite(value)) {
+        return QString::number(value, 'f', decimalDigits);
+    }
+    decimalDigits = qBound(0, decimalDigits, MaxFixedDigits);
+    const Key key = { value, decimalDigits, false };
+    const auto it = m_results.constFind(key);
+    if (it != m_results.constEnd()) {
+        return it.value();
+    }
+
+    char buffer[BufferSize];
+    const int length = writeFixed(buffer, value, decimalDigits);
+    const QString result = localized(buffer, buffer + length);
+    if (m_results.size() >= MaxResults) {
+        m_results.clear();
+    }
+    m_results.insert(key, result);
+    return result;
+}
+
+QString NumberFormatter::rounded(qreal value, int decimalDigits)
+{
+    const int digits = qMax(decimalDigits, 0);
+    const qreal roundingEpsilon = std::pow(0.1, digits) * (value >= 0.0 ? 0.5 : -0.5);
+    if (!std::isfinite(value + roundingEpsilon)) {
+        return QString::number(value + roundingEpsilon, 'f');
+    }
+    const Key key = { value, digits, true };
+    const auto it = m_results.constFind(key);
+    if (it != m_results.constEnd()) {
+        return it.value();
+    }
+
+    char buffer[BufferSize];
+    int length = writeFixed(buffer, value + roundingEpsilon, MaxRoundedDigits);
+    const char *const decimalPoint = static_cast<const char *>(memchr(buffer, '.', size_t(length)));
+    if (decimalPoint) {
+        const int decimalPos = int(decimalPoint - buffer);
+        int last = qMin(decimalPos + digits, length - 1);
+        // remove trailing zeros (and maybe the decimal point)
+        while (last > decimalPos && buffer[last] == '0') {
+            last--;
+        }
+        if (last == decimalPos) {
+            last--;
+        }
+        length = last + 1;
+    }
+    const QString result = localized(buffer, buffer + length);
+    if (m_results.size() >= MaxResults) {
+        m_results.clear();
+    }
+    m_results.insert(key, result);
+    return result;
+}
+
+int NumberFormatter::significantDecimalDigits(qreal value, int maxDigits)
+{
+    maxDigits = qBound(0, maxDigits, MaxFixedDigits);
+    char buffer[BufferSize];
+    const int length = writeFixed(buffer, value, maxDigits);
+    const char *const decimalPoint = static_cast<const char *>(memchr(buffer, '.', size_t(length)));
+    if (!decimalPoint) {
+        return 0;
+    }
+    const char *const digits = decimalPoint + 1;
+    int ret = qMin(maxDigits, int(buffer + length - digits));
+    for (; ret > 0; ret--) {
+        if (digits[ret - 1] != '0') {
+            break;
+        }
+    }
+    return ret;
+}
+
+void NumberFormatter::clear()
+{
+    m_results.clear();
+}
+
+QString NumberFormatter::localized(const char *first, const char *last) const
+{
+    QString result = QString::fromLatin1(first, int(last - first));
+    if (m_decimalPoint != QLatin1String(".")) {
+        result.replace(QLatin1Char('.'), m_decimalPoint);
+    }
+    if (m_minusSign != QLatin1String("-")) {
+        result.replace(QLatin1Char('-'), m_minusSign);
+    }
+    return result;
+}
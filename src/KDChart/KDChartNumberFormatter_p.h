@@ -0,0 +1,95 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#ifndef KDCHARTNUMBERFORMATTER_P_H
+#define KDCHARTNUMBERFORMATTER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the KD Chart API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QHash>
+#include <QLocale>
+#include <QString>
+
+#include "KDChartGlobal.h"
+
+namespace KDChart {
+
+/**
+ * \internal
+ * Formats the numbers of data value texts and axis labels.
+ *
+ * The digits are written with std::to_chars where the standard library
+ * supports it for floating point numbers, without going through QString
+ * and QLocale for each number. The decimal point and minus sign are taken
+ * from the locale given to the constructor, which is the C locale unless
+ * told otherwise. Since the same values get labeled on every paint, the
+ * last few hundred results are remembered.
+ */
+class KDCHART_EXPORT NumberFormatter
+{
+public:
+    explicit NumberFormatter(const QLocale &locale = QLocale::c());
+
+    /**
+     * \a value with exactly \a decimalDigits digits after the decimal point,
+     * like QString::number(value, 'f', decimalDigits).
+     */
+    QString fixed(qreal value, int decimalDigits);
+
+    /**
+     * \a value rounded half away from zero to at most \a decimalDigits digits
+     * after the decimal point, and at most six of them, without trailing zeros.
+     */
+    QString rounded(qreal value, int decimalDigits);
+
+    /**
+     * The number of digits after the decimal point that \a value needs, up to
+     * \a maxDigits.
+     */
+    static int significantDecimalDigits(qreal value, int maxDigits = 15);
+
+    void clear();
+
+private:
+    struct Key
+    {
+        qreal value;
+        int decimalDigits;
+        bool rounded;
+
+        bool operator==(const Key &other) const
+        {
+            return value == other.value && decimalDigits == other.decimalDigits && rounded == other.rounded;
+        }
+
+        friend size_t qHash(const Key &key, size_t seed = 0) noexcept
+        {
+            return qHash(key.value, seed) ^ qHash(key.decimalDigits * 2 + (key.rounded ? 1 : 0), seed);
+        }
+    };
+
+    QString localized(const char *first, const char *last) const;
+
+    QString m_decimalPoint;
+    QString m_minusSign;
+    QHash<Key, QString> m_results;
+};
+}
+
+#endif
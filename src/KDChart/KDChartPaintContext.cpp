@@ -20,12 +20,18 @@ using namespace KDChart;
 
 #define d (d_func())
 
+// the rendering in progress on each thread, see Chart::paint()
+static thread_local const PaintContext *currentContext = nullptr;
+
 class PaintContext::Private
 {
 public:
     QPainter *painter = nullptr;
     QRectF rect;
     AbstractCoordinatePlane *plane = nullptr;
+    QPair<qreal, qreal> measureFactors = qMakePair(qreal(1.0), qreal(1.0));
+    QPaintDevice *fontMetricsDevice = nullptr;
+    qreal penScaleFactor = 1.0;
 
     Private()
     {
@@ -35,13 +41,31 @@ public:
 PaintContext::PaintContext()
     : _d(new Private())
 {
+    if (currentContext) {
+        d->measureFactors = currentContext->measureFactors();
+        d->fontMetricsDevice = currentContext->fontMetricsDevice();
+        d->penScaleFactor = currentContext->penScaleFactor();
+    }
 }
 
 PaintContext::~PaintContext()
 {
+    Q_ASSERT(currentContext != this);
     delete _d;
 }
 
+const PaintContext *PaintContext::current()
+{
+    return currentContext;
+}
+
+const PaintContext *PaintContext::setCurrent(const PaintContext *context)
+{
+    const PaintContext *previous = currentContext;
+    currentContext = context;
+    return previous;
+}
+
 const QRectF PaintContext::rectangle() const
 {
     return d->rect;
@@ -71,3 +95,46 @@ void PaintContext::setCoordinatePlane(AbstractCoordinatePlane *plane)
 {
     d->plane = plane;
 }
+
+QPair<qreal, qreal> PaintContext::measureFactors() const
+{
+    return d->measureFactors;
+}
+
+void PaintContext::setMeasureFactors(qreal factorX, qreal factorY)
+{
+    d->measureFactors = qMakePair(factorX, factorY);
+}
+
+QPaintDevice *PaintContext::fontMetricsDevice() const
+{
+    return d->fontMetricsDevice;
+}
+
+void PaintContext::setFontMetricsDevice(QPaintDevice *device)
+{
+    d->fontMetricsDevice = device;
+}
+
+qreal PaintContext::penScaleFactor() const
+{
+    return d->penScaleFactor;
+}
+
+void PaintContext::setPenScaleFactor(qreal factor)
+{
+    d->penScaleFactor = factor;
+}
+
+QPen PaintContext::scaledPen(const QPen &pen) const
+{
+    if (d->penScaleFactor == 1.0)
+        return pen;
+
+    QPen resultPen = pen;
+    resultPen.setWidthF(resultPen.widthF() * d->penScaleFactor);
+    if (resultPen.widthF() == 0.0)
+        resultPen.setWidthF(d->penScaleFactor);
+
+    return resultPen;
+}
@@ -12,10 +12,13 @@
 #define PAINTCONTEXT_H
 
 #include "KDChartGlobal.h"
+#include <QPair>
+#include <QPen>
 #include <QRectF>
 
 QT_BEGIN_NAMESPACE
 class QPainter;
+class QPaintDevice;
 QT_END_NAMESPACE
 
 namespace KDChart {
@@ -24,6 +27,12 @@ class AbstractCoordinatePlane;
 
 /**
  * @brief Stores information about painting diagrams
+ *
+ * Besides the painter and the area to paint, a PaintContext carries the scaling of the
+ * rendering it belongs to: the factors applied to measures, the device that fonts are
+ * measured on and the factor applied to pen widths. Chart::paint() makes its context
+ * current() on the calling thread, so that charts can be rendered on several threads at
+ * once. A new PaintContext starts with the scaling of the current one.
  * \internal
  */
 class KDCHART_EXPORT PaintContext
@@ -32,6 +41,17 @@ public:
     PaintContext();
     ~PaintContext();
 
+    /**
+     * @return the context of the rendering in progress on the calling thread,
+     * or nullptr if there is none
+     */
+    static const PaintContext *current();
+    /**
+     * Makes \a context the current() one on the calling thread.
+     * @return the context that was current before
+     */
+    static const PaintContext *setCurrent(const PaintContext *context);
+
     const QRectF rectangle() const;
     void setRectangle(const QRectF &rect);
 
@@ -41,6 +61,19 @@ public:
     AbstractCoordinatePlane *coordinatePlane() const;
     void setCoordinatePlane(AbstractCoordinatePlane *plane);
 
+    /** The factors that measures are scaled with, see GlobalMeasureScaling */
+    QPair<qreal, qreal> measureFactors() const;
+    void setMeasureFactors(qreal factorX, qreal factorY);
+
+    /** The device to calculate font metrics for, or nullptr for the screen */
+    QPaintDevice *fontMetricsDevice() const;
+    void setFontMetricsDevice(QPaintDevice *device);
+
+    /** The factor that pen widths are scaled with, see PrintingParameters */
+    qreal penScaleFactor() const;
+    void setPenScaleFactor(qreal factor);
+    QPen scaledPen(const QPen &pen) const;
+
 private:
     class Private;
     Private *_d;
@@ -9,6 +9,7 @@
 ****************************************************************************/
 
 #include "KDChartPrintingParameters.h"
+#include "KDChartPaintContext.h"
 
 using namespace KDChart;
 
@@ -34,6 +35,9 @@ void PrintingParameters::resetScaleFactor()
 
 QPen PrintingParameters::scalePen(const QPen &pen)
 {
+    if (const PaintContext *context = PaintContext::current())
+        return context->scaledPen(pen);
+
     if (instance()->scaleFactor == 1.0)
         return pen;
 
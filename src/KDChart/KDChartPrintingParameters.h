@@ -29,6 +29,9 @@ namespace KDChart {
 /**
  * PrintingParameters stores the scale factor which lines has to been scaled with when printing.
  * It's essentially printer's logical DPI / widget's logical DPI
+ *
+ * While a chart is rendered by Chart::paint(), the factor of PaintContext::current() is used
+ * instead, so the factor set here only applies to painting outside of such a rendering.
  * \internal
  */
 class PrintingParameters
@@ -0,0 +1,176 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#include "KDChartRingBufferModel.h"
+
+#include <KDABLibFakes>
+
+#include <algorithm>
+#include <limits>
+
+using namespace KDChart;
+
+RingBufferModel::RingBufferModel(int capacity, int columnCount, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_capacity(qMax(0, capacity))
+    , m_columnCount(qMax(0, columnCount))
+    , m_values(m_capacity * m_columnCount)
+    , m_headers(m_columnCount)
+{
+}
+
+RingBufferModel::~RingBufferModel()
+{
+}
+
+int RingBufferModel::capacity() const
+{
+    return m_capacity;
+}
+
+void RingBufferModel::setCapacity(int capacity)
+{
+    capacity = qMax(0, capacity);
+    if (capacity == m_capacity) {
+        return;
+    }
+    beginResetModel();
+    // keep the newest rows, in order
+    const int kept = qMin(m_size, capacity);
+    QVector<qreal> values(capacity * m_columnCount);
+    for (int row = 0; row < kept; ++row) {
+        const qreal *source = m_values.constData() + offset(m_size - kept + row);
+        std::copy(source, source + m_columnCount, values.data() + row * m_columnCount);
+    }
+    m_values = values;
+    m_capacity = capacity;
+    m_head = 0;
+    m_size = kept;
+    endResetModel();
+}
+
+void RingBufferModel::clear()
+{
+    if (m_size == 0) {
+        return;
+    }
+    beginResetModel();
+    m_head = 0;
+    m_size = 0;
+    endResetModel();
+}
+
+void RingBufferModel::appendRow(const QVector<qreal> &values)
+{
+    if (values.size() >= m_columnCount) {
+        appendRows(values.constData(), 1);
+        return;
+    }
+    QVector<qreal> row(m_columnCount, std::numeric_limits<qreal>::quiet_NaN());
+    std::copy(values.constBegin(), values.constEnd(), row.begin());
+    appendRows(row.constData(), 1);
+}
+
+void RingBufferModel::appendRows(const qreal *values, int rowCount)
+{
+    if (rowCount <= 0 || m_capacity == 0 || m_columnCount == 0) {
+        return;
+    }
+
+    if (rowCount >= m_capacity) {
+        // only the newest rows survive, everything else is replaced
+        beginResetModel();
+        values += (rowCount - m_capacity) * m_columnCount;
+        for (int row = 0; row < m_capacity; ++row) {
+            writeRow(row, values + row * m_columnCount);
+        }
+        m_head = 0;
+        m_size = m_capacity;
+        endResetModel();
+        return;
+    }
+
+    // fill up the free rows first...
+    const int inserted = qMin(rowCount, m_capacity - m_size);
+    if (inserted > 0) {
+        beginInsertRows(QModelIndex(), m_size, m_size + inserted - 1);
+        for (int i = 0; i < inserted; ++i) {
+            writeRow((m_head + m_size + i) % m_capacity, values + i * m_columnCount);
+        }
+        m_size += inserted;
+        endInsertRows();
+        values += inserted * m_columnCount;
+    }
+
+    // ...then overwrite the oldest rows
+    const int evicted = rowCount - inserted;
+    if (evicted > 0) {
+        for (int i = 0; i < evicted; ++i) {
+            writeRow(m_head, values + i * m_columnCount);
+            m_head = (m_head + 1) % m_capacity;
+        }
+        Q_EMIT rowsShifted(evicted);
+        Q_EMIT dataChanged(index(0, 0), index(m_size - 1, m_columnCount - 1));
+    }
+}
+
+qreal RingBufferModel::value(int row, int column) const
+{
+    return m_values.at(offset(row) + column);
+}
+
+int RingBufferModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_size;
+}
+
+int RingBufferModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_columnCount;
+}
+
+QVariant RingBufferModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole)) {
+        return QVariant();
+    }
+    const qreal v = value(index.row(), index.column());
+    return ISNAN(v) ? QVariant() : QVariant(v);
+}
+
+QVariant RingBufferModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && (role == Qt::DisplayRole || role == Qt::EditRole)
+        && section >= 0 && section < m_columnCount && !m_headers.at(section).isNull()) {
+        return m_headers.at(section);
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+bool RingBufferModel::setHeaderData(int section, Qt::Orientation orientation, const QVariant &value, int role)
+{
+    if (orientation != Qt::Horizontal || (role != Qt::DisplayRole && role != Qt::EditRole)
+        || section < 0 || section >= m_columnCount) {
+        return false;
+    }
+    m_headers[section] = value.toString();
+    Q_EMIT headerDataChanged(orientation, section, section);
+    return true;
+}
+
+int RingBufferModel::offset(int row) const
+{
+    return ((m_head + row) % m_capacity) * m_columnCount;
+}
+
+void RingBufferModel::writeRow(int storageRow, const qreal *values)
+{
+    std::copy(values, values + m_columnCount, m_values.data() + storageRow * m_columnCount);
+}
@@ -0,0 +1,102 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#ifndef KDCHARTRINGBUFFERMODEL_H
+#define KDCHARTRINGBUFFERMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+
+#include "kdchart_export.h"
+
+namespace KDChart {
+
+/**
+ * \brief RingBufferModel is a table model for streaming data with a fixed
+ * number of columns and at most capacity() rows.
+ *
+ * New rows are appended at the bottom in constant time. Once the model is
+ * full, every appended row evicts the oldest row at the top, so the row
+ * count stays at capacity() and row 0 always holds the oldest sample.
+ *
+ * While the model fills up, rows are announced with the usual
+ * rowsInserted() signal. Evicting rows does not emit rowsRemoved() and
+ * rowsInserted(); instead, rowsShifted() is emitted, followed by a
+ * dataChanged() for the whole table for views that do not know about
+ * shifting. Cartesian diagrams use rowsShifted() to slide their caches
+ * instead of reading all values again.
+ *
+ * Values that are NaN are presented as missing values.
+ */
+class KDCHART_EXPORT RingBufferModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    RingBufferModel(int capacity, int columnCount, QObject *parent = nullptr);
+    ~RingBufferModel() override;
+
+    /** \return the maximum number of rows */
+    int capacity() const;
+    /**
+     * Sets the maximum number of rows. If the model holds more rows than
+     * \a capacity, the oldest rows are dropped. This resets the model.
+     */
+    void setCapacity(int capacity);
+
+    /** Removes all rows. */
+    void clear();
+
+    /**
+     * Appends a row. \a values must contain columnCount() values,
+     * missing values are treated as NaN.
+     */
+    void appendRow(const QVector<qreal> &values);
+    /**
+     * Appends \a rowCount rows at once, which is cheaper than calling
+     * appendRow() repeatedly. \a values contains columnCount() values
+     * for each row, one row after the other.
+     */
+    void appendRows(const qreal *values, int rowCount);
+
+    /** \return the value at \a row and \a column, without range checks */
+    qreal value(int row, int column) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool setHeaderData(int section, Qt::Orientation orientation, const QVariant &value,
+                       int role = Qt::EditRole) override;
+
+Q_SIGNALS:
+    /**
+     * Emitted when \a count rows were evicted at the top and the same number
+     * of rows was appended at the bottom, so that the row count did not
+     * change and every remaining row moved up by \a count.
+     */
+    void rowsShifted(int count);
+
+private:
+    // the storage index of the first value of a row
+    int offset(int row) const;
+    void writeRow(int storageRow, const qreal *values);
+
+    int m_capacity;
+    int m_columnCount;
+    // index of the storage row that holds row 0
+    int m_head = 0;
+    int m_size = 0;
+    QVector<qreal> m_values;
+    QVector<QString> m_headers;
+};
+}
+
+#endif
@@ -0,0 +1,39 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#include "KDChartStyleSnapshot_p.h"
+
+#include <KDABLibFakes>
+
+using namespace KDChart;
+
+void StyleSnapshot::resolveLines(const AttributesModel *model, const QModelIndex &root)
+{
+    pen.resolve(model, DatasetPenRole, root);
+    brush.resolve(model, DatasetBrushRole, root);
+    lineAttributes.resolve(model, LineAttributesRole, root);
+    threeDLineAttributes.resolve(model, ThreeDLineAttributesRole, root);
+    valueTrackerAttributes.resolve(model, ValueTrackerAttributesRole, root);
+    dataValueAttributes.resolve(model, DataValueLabelAttributesRole, root);
+}
+
+void StyleSnapshot::resolveBars(const AttributesModel *model, const QModelIndex &root)
+{
+    pen.resolve(model, DatasetPenRole, root);
+    brush.resolve(model, DatasetBrushRole, root);
+    threeDBarAttributes.resolve(model, ThreeDBarAttributesRole, root);
+    dataValueAttributes.resolve(model, DataValueLabelAttributesRole, root);
+}
+
+bool StyleSnapshot::hasUniformLines(int column) const
+{
+    return pen.isUniform(column) && brush.isUniform(column)
+        && threeDLineAttributes.isUniform(column) && valueTrackerAttributes.isUniform(column);
+}
@@ -0,0 +1,139 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+#ifndef KDCHARTSTYLESNAPSHOT_P_H
+#define KDCHARTSTYLESNAPSHOT_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the KD Chart API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QBitArray>
+#include <QBrush>
+#include <QModelIndex>
+#include <QPen>
+#include <QVector>
+
+#include "KDChartAttributesModel.h"
+#include "KDChartDataValueAttributes.h"
+#include "KDChartLineAttributes.h"
+#include "KDChartThreeDBarAttributes.h"
+#include "KDChartThreeDLineAttributes.h"
+#include "KDChartValueTrackerAttributes.h"
+
+namespace KDChart {
+
+/**
+ * \internal
+ * One attribute role of a diagram, resolved for all datasets at once.
+ * Cells with an attribute of their own, set on the cell or supplied by the
+ * source model, are looked up one by one; all other cells share the
+ * attribute of their dataset without querying the AttributesModel.
+ */
+template<typename T>
+class ResolvedAttribute
+{
+public:
+    // resolves role for the datasets below root, an index of model
+    void resolve(const AttributesModel *model, int role, const QModelIndex &root)
+    {
+        m_model = model;
+        m_role = role;
+        m_cellAttributes = model->hasCellAttributes(role);
+        const int columnCount = model->columnCount(root);
+        m_datasets.resize(columnCount);
+        m_sourceColumns.fill(false, columnCount);
+        for (int column = 0; column < columnCount; ++column) {
+            m_datasets[column] = model->data(column, role).value<T>();
+            if (model->sourceSuppliesRole(column, role, root)) {
+                m_sourceColumns.setBit(column);
+            }
+        }
+    }
+
+    bool isResolved() const
+    {
+        return m_model != nullptr;
+    }
+
+    int role() const
+    {
+        return m_role;
+    }
+
+    // true if all cells of all columns shared the attribute of their dataset when resolved
+    bool isUniform() const
+    {
+        return isResolved() && !m_cellAttributes && m_sourceColumns.count(true) == 0;
+    }
+
+    // true if all cells of column share the attribute of their dataset
+    bool isUniform(int column) const
+    {
+        return !m_cellAttributes && column >= 0 && column < m_datasets.size() && !m_sourceColumns.testBit(column);
+    }
+
+    // The attribute of the cell at index, which may belong to the attributes model
+    // or to its source model. The reference is valid until the next call.
+    const T &value(const QModelIndex &index) const
+    {
+        Q_ASSERT(m_model);
+        const int column = index.column();
+        if (isUniform(column)) {
+            return m_datasets.at(column);
+        }
+        m_cellValue = m_model->attribute<T>(index.model() == m_model ? index : m_model->mapFromSource(index), m_role);
+        return m_cellValue;
+    }
+
+private:
+    const AttributesModel *m_model = nullptr;
+    int m_role = -1;
+    bool m_cellAttributes = false;
+    QVector<T> m_datasets;
+    // columns whose attributes the source model supplies
+    QBitArray m_sourceColumns;
+    mutable T m_cellValue;
+};
+
+/**
+ * \internal
+ * The pens, brushes and attributes that Cartesian diagrams paint with, resolved
+ * once at the start of each paint so that painting each data point and segment
+ * does not go through the AttributesModel again.
+ */
+class StyleSnapshot
+{
+public:
+    void resolveLines(const AttributesModel *model, const QModelIndex &root);
+    void resolveBars(const AttributesModel *model, const QModelIndex &root);
+
+    // true if all lines of column can be painted with the same pen, brush,
+    // 3D line and value tracker attributes
+    bool hasUniformLines(int column) const;
+
+    ResolvedAttribute<QPen> pen;
+    ResolvedAttribute<QBrush> brush;
+    ResolvedAttribute<LineAttributes> lineAttributes;
+    ResolvedAttribute<ThreeDLineAttributes> threeDLineAttributes;
+    ResolvedAttribute<ValueTrackerAttributes> valueTrackerAttributes;
+    ResolvedAttribute<ThreeDBarAttributes> threeDBarAttributes;
+    ResolvedAttribute<DataValueAttributes> dataValueAttributes;
+};
+}
+
+#endif
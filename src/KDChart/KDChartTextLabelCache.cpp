@@ -11,37 +11,114 @@
 #include "KDChartTextLabelCache.h"
 
 #include <cmath>
+#include <limits>
 
 #include <QApplication>
+#include <QDataStream>
 #include <QImage>
+#include <QMutexLocker>
 #include <QPainter>
 #include <QPixmap>
+#include <QThread>
 #include <QtDebug>
 
-#ifndef NDEBUG
-int HitCount = 0;
-int MissCount = 0;
-#define INC_HIT_COUNT \
-    {                 \
-        ++HitCount;   \
-    }
-#define INC_MISS_COUNT \
-    {                  \
-        ++MissCount;   \
+static const int DefaultMaximumBytes = 8 * 1024 * 1024;
+
+// pixmaps may only be used in the GUI thread, labels rendered elsewhere stay images
+static bool isGuiThread()
+{
+    const QCoreApplication *app = QCoreApplication::instance();
+    return app && QThread::currentThread() == app->thread();
+}
+
+static int pixmapBytes(const QPixmap &pixmap)
+{
+    return int(qMin(qint64(pixmap.width()) * pixmap.height() * qMax(pixmap.depth(), 8) / 8,
+                    qint64(std::numeric_limits<int>::max())));
+}
+
+PrerenderedElementCache::PrerenderedElementCache()
+    : m_elements(DefaultMaximumBytes)
+{
+}
+
+PrerenderedElementCache *PrerenderedElementCache::instance()
+{
+    static PrerenderedElementCache cache;
+    return &cache;
+}
+
+bool PrerenderedElementCache::find(const QByteArray &key, QPixmap *pixmap, QVector<QPointF> *points)
+{
+    const QMutexLocker locker(&m_mutex);
+    const Element *element = m_elements.object(key);
+    if (!element) {
+        ++m_missCount;
+        return false;
     }
-#define DUMP_CACHE_STATS                                         \
-    if (HitCount != 0 && MissCount != 0) {                       \
-        int total = HitCount + MissCount;                        \
-        qreal hitQuote = (1.0 * HitCount) / total;               \
-        qDebug() << "PrerenderedLabel dtor: hits/misses/total:"  \
-                 << HitCount << "/" << MissCount << "/" << total \
-                 << "(" << 100 * hitQuote << "% hits)";          \
+    ++m_hitCount;
+    *pixmap = element->pixmap;
+    if (points) {
+        *points = element->points;
     }
-#else
-#define INC_HIT_COUNT
-#define INC_MISS_COUNT
-#define DUMP_CACHE_STATS
-#endif
+    return true;
+}
+
+void PrerenderedElementCache::insert(const QByteArray &key, const QPixmap &pixmap, const QVector<QPointF> &points)
+{
+    const QMutexLocker locker(&m_mutex);
+    // QCache deletes the element right away if it is too expensive
+    m_elements.insert(key, new Element { pixmap, points }, qMax(pixmapBytes(pixmap), 1));
+}
+
+void PrerenderedElementCache::setMaximumBytes(int bytes)
+{
+    const QMutexLocker locker(&m_mutex);
+    m_elements.setMaxCost(bytes);
+}
+
+int PrerenderedElementCache::maximumBytes() const
+{
+    const QMutexLocker locker(&m_mutex);
+    return int(m_elements.maxCost());
+}
+
+int PrerenderedElementCache::bytes() const
+{
+    const QMutexLocker locker(&m_mutex);
+    return int(m_elements.totalCost());
+}
+
+int PrerenderedElementCache::count() const
+{
+    const QMutexLocker locker(&m_mutex);
+    return int(m_elements.count());
+}
+
+int PrerenderedElementCache::hitCount() const
+{
+    const QMutexLocker locker(&m_mutex);
+    return m_hitCount;
+}
+
+int PrerenderedElementCache::missCount() const
+{
+    const QMutexLocker locker(&m_mutex);
+    return m_missCount;
+}
+
+void PrerenderedElementCache::resetCounters()
+{
+    const QMutexLocker locker(&m_mutex);
+    m_hitCount = 0;
+    m_missCount = 0;
+}
+
+void PrerenderedElementCache::clear()
+{
+    const QMutexLocker locker(&m_mutex);
+    m_elements.clear();
+}
 
 PrerenderedElement::PrerenderedElement()
 {
@@ -77,7 +154,6 @@ PrerenderedLabel::PrerenderedLabel()
 
 PrerenderedLabel::~PrerenderedLabel()
 {
-    DUMP_CACHE_STATS;
 }
 
 /**
@@ -139,6 +215,23 @@ const QBrush &PrerenderedLabel::brush() const
     return m_brush;
 }
 
+/**
+ * Sets the label's pen to \a pen
+ */
+void PrerenderedLabel::setPen(const QPen &pen)
+{
+    m_pen = pen;
+    invalidate();
+}
+
+/**
+ * @return the label's pen
+ */
+const QPen &PrerenderedLabel::pen() const
+{
+    return m_pen;
+}
+
 /**
  * Sets the angle of the label to \a angle degrees
  */
@@ -156,19 +249,75 @@ qreal PrerenderedLabel::angle() const
     return m_angle;
 }
 
+/**
+ * Sets the ratio of device pixels to the label's pixels to \a ratio,
+ * to render it sharply on high resolution screens
+ */
+void PrerenderedLabel::setDevicePixelRatio(qreal ratio)
+{
+    if (ratio == m_devicePixelRatio) {
+        return;
+    }
+    m_devicePixelRatio = ratio;
+    invalidate();
+}
+
+/**
+ * @return the ratio of device pixels to the label's pixels
+ */
+qreal PrerenderedLabel::devicePixelRatio() const
+{
+    return m_devicePixelRatio;
+}
+
 const QPixmap &PrerenderedLabel::pixmap() const
 {
     if (m_dirty) {
-        INC_MISS_COUNT;
         paint();
-    } else {
-        INC_HIT_COUNT;
+    }
+    // rendered by another thread
+    if (m_pixmap.isNull() && !m_image.isNull() && isGuiThread()) {
+        m_pixmap = QPixmap::fromImage(m_image);
     }
     return m_pixmap;
 }
 
+void PrerenderedLabel::draw(QPainter *painter, const QPointF &topLeft) const
+{
+    if (m_dirty) {
+        paint();
+    }
+    if (m_pixmap.isNull()) {
+        painter->drawImage(topLeft, m_image);
+    } else {
+        painter->drawPixmap(topLeft, m_pixmap);
+    }
+}
+
+QByteArray PrerenderedLabel::cacheKey() const
+{
+    QByteArray key;
+    QDataStream stream(&key, QIODevice::WriteOnly);
+    stream << QByteArray("PrerenderedLabel") << m_text << m_font << m_pen << m_brush
+           << m_angle << m_devicePixelRatio;
+    return key;
+}
+
 void PrerenderedLabel::paint() const
 {
+    // the cache holds pixmaps, which other threads must not touch
+    const bool onGuiThread = isGuiThread();
+    const QByteArray key = cacheKey();
+    QVector<QPointF> points;
+    m_image = QImage();
+    if (onGuiThread && PrerenderedElementCache::instance()->find(key, &m_pixmap, &points) && points.count() == 3) {
+        m_referenceBottomLeft = points.at(0);
+        m_textBaseLineVector = points.at(1);
+        m_textAscendVector = points.at(2);
+        m_dirty = false;
+        return;
+    }
+
     // FIXME find a better value using font metrics of text (this
     // requires finding the diameter of the circle formed by rotating
     // the bounding rect around the center):
@@ -177,13 +326,9 @@ void PrerenderedLabel::paint() const
 
     QRectF boundingRect;
     const QColor FullTransparent(255, 255, 255, 0);
-#ifdef Q_WS_X11
-    QImage pixmap(Width, Height, QImage::Format_ARGB32_Premultiplied);
-    qWarning() << "PrerenderedLabel::paint: using QImage for prerendered labels "
-               << "to work around XRender/Qt4 bug.";
-#else
-    QPixmap pixmap(Width, Height);
-#endif
+    const qreal ratio = m_devicePixelRatio;
+    QImage pixmap(qRound(Width * ratio), qRound(Height * ratio), QImage::Format_ARGB32_Premultiplied);
+    pixmap.setDevicePixelRatio(ratio);
     // pixmap.fill( FullTransparent );
     {
         static const QPointF Center(0.0, 0.0);
@@ -192,7 +337,7 @@ void PrerenderedLabel::paint() const
         painter.setRenderHint(QPainter::TextAntialiasing, true);
         painter.setRenderHint(QPainter::Antialiasing, true);
 
-        // QImage (X11 workaround) does not have fill():
+        // clear the canvas:
         painter.setPen(FullTransparent);
         painter.setBrush(FullTransparent);
         QPainter::CompositionMode mode = painter.compositionMode();
@@ -230,16 +375,15 @@ void PrerenderedLabel::paint() const
 
     m_dirty = false; // now all the calculation vectors are valid
 
-    QPixmap temp(static_cast<int>(boundingRect.width()),
-                 static_cast<int>(boundingRect.height()));
+    QImage temp(static_cast<int>(boundingRect.width() * ratio),
+                static_cast<int>(boundingRect.height() * ratio), QImage::Format_ARGB32_Premultiplied);
+    temp.setDevicePixelRatio(ratio);
     {
         temp.fill(FullTransparent);
         QPainter painter(&temp);
-#ifdef Q_WS_X11
-        painter.drawImage(QPointF(0.0, 0.0), pixmap, boundingRect);
-#else
-        painter.drawPixmap(QPointF(0.0, 0.0), pixmap, boundingRect);
-#endif
+        // the source rect is in device pixels
+        const QRectF source(boundingRect.topLeft() * ratio, boundingRect.size() * ratio);
+        painter.drawImage(QPointF(0.0, 0.0), pixmap, source);
 // #define PRERENDEREDLABEL_DEBUG
 #ifdef PRERENDEREDLABEL_DEBUG
         painter.setPen(QPen(Qt::red, 2));
@@ -267,7 +411,16 @@ void PrerenderedLabel::paint() const
 #endif
     }
 
-    m_pixmap = temp;
+    if (!onGuiThread) {
+        if (!m_pixmap.isNull()) {
+            m_pixmap = QPixmap();
+        }
+        m_image = temp;
+        return;
+    }
+    m_pixmap = QPixmap::fromImage(temp);
+    PrerenderedElementCache::instance()->insert(key, m_pixmap,
+                                                { m_referenceBottomLeft, m_textBaseLineVector, m_textAscendVector });
 }
 
 QPointF PrerenderedLabel::referencePointLocation() const
@@ -278,10 +431,7 @@ QPointF PrerenderedLabel::referencePointLocation() const
 QPointF PrerenderedLabel::referencePointLocation(KDChartEnums::PositionValue position) const
 {
     if (m_dirty) {
-        INC_MISS_COUNT;
         paint();
-    } else {
-        INC_HIT_COUNT;
     }
 
     switch (position) {
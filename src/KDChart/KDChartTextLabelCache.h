@@ -12,16 +12,88 @@
 #define KDCHARTTEXTLABELCACHE_H
 
 #include <QBrush>
+#include <QByteArray>
+#include <QCache>
 #include <QFont>
+#include <QImage>
+#include <QMutex>
 #include <QPen>
 #include <QPixmap>
+#include <QVector>
 
 #include "KDChartEnums.h"
+#include "kdchart_export.h"
+
+/**
+ * @brief PrerenderedElementCache keeps rasterized elements like labels and
+ * symbols for reuse, so that equal elements are only rendered once in the
+ * whole process.
+ *
+ * Elements are found by a key that describes everything that goes into
+ * their appearance. Along with the pixmap, an element may store a few
+ * points of its geometry, such as the reference points of a label.
+ *
+ * The cache holds at most maximumBytes() bytes of pixmap data, and drops the
+ * least recently used elements when it needs room. The hit and miss counts
+ * help to find a budget that suits an application. All methods are thread
+ * safe, but pixmaps can only be created in the GUI thread.
+ */
+class KDCHART_EXPORT PrerenderedElementCache
+{
+public:
+    /** @return the cache shared by all of KD Chart. */
+    static PrerenderedElementCache *instance();
+
+    /** Looks up the element stored for \a key.
+        If there is one, it is copied to \a pixmap and \a points, and
+        becomes the most recently used element.
+        @return whether the element was found */
+    bool find(const QByteArray &key, QPixmap *pixmap, QVector<QPointF> *points = nullptr);
+
+    /** Stores \a pixmap and \a points for \a key, replacing what was stored
+        for \a key before. Elements larger than maximumBytes() are not stored. */
+    void insert(const QByteArray &key, const QPixmap &pixmap, const QVector<QPointF> &points = QVector<QPointF>());
+
+    /** Sets the budget of pixmap data to \a bytes, dropping elements if
+        they exceed it. The default is 8 MiB. */
+    void setMaximumBytes(int bytes);
+    /** @return the budget of pixmap data in bytes */
+    int maximumBytes() const;
+    /** @return the number of bytes of pixmap data stored */
+    int bytes() const;
+    /** @return the number of elements stored */
+    int count() const;
+
+    /** @return how often find() found an element */
+    int hitCount() const;
+    /** @return how often find() found no element */
+    int missCount() const;
+    /** Sets the hit and miss counts to zero. */
+    void resetCounters();
+
+    /** Drops all elements. */
+    void clear();
+
+private:
+    PrerenderedElementCache();
+    Q_DISABLE_COPY(PrerenderedElementCache)
+
+    struct Element
+    {
+        QPixmap pixmap;
+        QVector<QPointF> points;
+    };
+
+    mutable QMutex m_mutex;
+    QCache<QByteArray, Element> m_elements;
+    int m_hitCount = 0;
+    int m_missCount = 0;
+};
 
 /**
  * @brief  base class for prerendered elements like labels, pixmaps, markers, etc.
  */
-class PrerenderedElement
+class KDCHART_EXPORT PrerenderedElement
 {
 public:
     PrerenderedElement();
@@ -73,6 +145,12 @@ private:
     elements. Reference points use the positions defined in
     KDChartEnums.
 
+    The pixmaps of labels are shared through the
+    PrerenderedElementCache, so labels that look the same are only
+    rendered once, even if they belong to different charts. Labels
+    rendered outside of the GUI thread bypass the cache and keep their
+    rendering as an image, use draw() to paint them there.
+
     Usage:
     <pre>
     qreal angle = 90.0;
@@ -82,10 +160,7 @@ private:
 */
 
 // FIXME this is merely a prototype
-// FIXME caching could be done by a second layer that can be used to,
-// e.g., query for a prerendered element by id or name, or by changing
-// the pixmap() method to do lazy evaluation.
-class PrerenderedLabel : public PrerenderedElement
+class KDCHART_EXPORT PrerenderedLabel : public PrerenderedElement
 {
 public:
     PrerenderedLabel();
@@ -106,8 +181,15 @@ public:
     void setAngle(qreal angle);
     qreal angle() const;
 
+    void setDevicePixelRatio(qreal ratio);
+    qreal devicePixelRatio() const;
+
     // reimp PrerenderedElement:
+    // Outside of the GUI thread, where pixmaps can not be used, this is a null pixmap.
     const QPixmap &pixmap() const override;
+    /** Draws the label with its top left corner at \a topLeft, also outside
+        of the GUI thread. */
+    void draw(QPainter *painter, const QPointF &topLeft) const;
     QPointF referencePointLocation(KDChartEnums::PositionValue position) const override;
     // overload: return location of referencePoint():
     QPointF referencePointLocation() const;
@@ -121,6 +203,9 @@ private:
         update when needed. */
     void paint() const;
 
+    // describes everything the pixmap depends on
+    QByteArray cacheKey() const;
+
     // store the settings (these are used for the painting):
     mutable bool m_dirty = true;
     QFont m_font;
@@ -128,9 +213,12 @@ private:
     QBrush m_brush;
     QPen m_pen;
     qreal m_angle = 0.0;
+    qreal m_devicePixelRatio = 1.0;
 
     // these are valid once the label has been rendered:
     mutable QPixmap m_pixmap;
+    // the label instead of m_pixmap if it was rendered outside of the GUI thread
+    mutable QImage m_image;
     mutable QPointF m_referenceBottomLeft;
     mutable QPointF m_textBaseLineVector;
     mutable QPointF m_textAscendVector;
@@ -12,7 +12,6 @@
 
 #include <math.h>
 
-#include <QGraphicsScene>
 #include <QPainterPath>
 #include <QPolygonF>
 #include <QRect>
@@ -21,8 +20,69 @@
 #include "ChartGraphicsItem.h"
 #include "KDChartAbstractDiagram.h"
 
+#include <algorithm>
+#include <functional>
+
 using namespace KDChart;
 
+// the grid has at most MaxGridSide x MaxGridSide cells
+static const int MaxGridSide = 256;
+
+static bool rectContains(const QRectF &rect, const QPointF &point)
+{
+    return point.x() >= rect.left() && point.x() <= rect.right()
+        && point.y() >= rect.top() && point.y() <= rect.bottom();
+}
+
+static bool rectsIntersect(const QRectF &a, const QRectF &b)
+{
+    return a.left() <= b.right() && b.left() <= a.right()
+        && a.top() <= b.bottom() && b.top() <= a.bottom();
+}
+
+// odd-even fill rule, like QPolygonF::containsPoint( point, Qt::OddEvenFill )
+static bool polygonContains(const QPointF *points, int count, const QPointF &point)
+{
+    bool inside = false;
+    for (int i = 0, j = count - 1; i < count; j = i++) {
+        const QPointF &a = points[i];
+        const QPointF &b = points[j];
+        if ((a.y() > point.y()) != (b.y() > point.y())
+            && point.x() < (b.x() - a.x()) * (point.y() - a.y()) / (b.y() - a.y()) + a.x()) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+// how far the band around a line extends beyond the line's bounds
+static const qreal LineBandMargin = 1.42;
+
+// lines do not make good polygons to click on. we calculate a 2
+// pixel wide rectangle, where the original line is exactly
+// centered in.
+static void lineBand(const QPointF &from, const QPointF &to, QPointF *band)
+{
+    // make a 3 pixel wide polygon from the line:
+    QPointF left, right;
+    if (from.x() < to.x()) {
+        left = from;
+        right = to;
+    } else {
+        right = from;
+        left = to;
+    }
+    const QPointF lineVector(right - left);
+    const qreal lineVectorLength = sqrt(lineVector.x() * lineVector.x() + lineVector.y() * lineVector.y());
+    const QPointF lineVectorUnit(lineVector / lineVectorLength);
+    const QPointF normOfLineVectorUnit(-lineVectorUnit.y(), lineVectorUnit.x());
+    // now the four polygon end points:
+    band[0] = left - lineVectorUnit + normOfLineVectorUnit;
+    band[1] = left - lineVectorUnit - normOfLineVectorUnit;
+    band[2] = right + lineVectorUnit - normOfLineVectorUnit;
+    band[3] = right + lineVectorUnit + normOfLineVectorUnit;
+}
+
 ReverseMapper::ReverseMapper()
 {
 }
@@ -34,8 +94,6 @@ ReverseMapper::ReverseMapper(AbstractDiagram *diagram)
 
 ReverseMapper::~ReverseMapper()
 {
-    delete m_scene;
-    m_scene = nullptr;
 }
 
 void ReverseMapper::setDiagram(AbstractDiagram *diagram)
@@ -43,122 +101,322 @@ void ReverseMapper::setDiagram(AbstractDiagram *diagram)
     m_diagram = diagram;
 }
 
+void ReverseMapper::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+    if (!enabled) {
+        clear();
+        m_entries.squeeze();
+        m_points.squeeze();
+    }
+}
+
+bool ReverseMapper::isEnabled() const
+{
+    return m_enabled;
+}
+
 void ReverseMapper::clear()
 {
-    m_itemMap.clear();
-    delete m_scene;
-    m_scene = new QGraphicsScene();
+    // keeps the capacity, the next paint adds about as many shapes again
+    m_entries.clear();
+    m_points.clear();
+    m_bounds = QRectF();
+    m_gridValid = false;
+    m_indexOrderValid = false;
 }
 
 QModelIndexList ReverseMapper::indexesIn(const QRect &rect) const
 {
     Q_ASSERT(m_diagram);
-    if (m_scene && m_scene->sceneRect().intersects(rect)) {
-        const QList<QGraphicsItem *> items = m_scene->items(rect);
-        QModelIndexList indexes;
-        for (QGraphicsItem *item : items) {
-            auto *i = qgraphicsitem_cast<ChartGraphicsItem *>(item);
-            if (i) {
-                QModelIndex index(m_diagram->model()->index(i->row(), i->column(), m_diagram->rootIndex())); // checked
-                indexes << index;
+    const QRectF area(rect);
+    if (m_entries.isEmpty() || !rectsIntersect(m_bounds, area)) {
+        return QModelIndexList();
+    }
+    buildGrid();
+
+    int firstColumn, lastColumn, firstRow, lastRow;
+    gridCells(area, &firstColumn, &lastColumn, &firstRow, &lastRow);
+    QVector<int> candidates;
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int column = firstColumn; column <= lastColumn; ++column) {
+            const int cell = row * m_gridColumns + column;
+            for (int i = m_cellStarts.at(cell); i < m_cellStarts.at(cell + 1); ++i) {
+                candidates << m_cellEntries.at(i);
             }
         }
-        return indexes;
-    } else {
-        return QModelIndexList();
     }
+    // the most recently added shapes come first, as they are on top
+    std::sort(candidates.begin(), candidates.end(), std::greater<int>());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    QModelIndexList indexes;
+    for (int entryNumber : std::as_const(candidates)) {
+        const Entry &entry = m_entries.at(entryNumber);
+        if (rectsIntersect(entry.bounds, area) && intersects(entry, area)) {
+            indexes << entryIndex(entry);
+        }
+    }
+    return indexes;
 }
 
 QModelIndexList ReverseMapper::indexesAt(const QPointF &point) const
 {
     Q_ASSERT(m_diagram);
-    if (m_scene && m_scene->sceneRect().contains(point)) {
-        const QList<QGraphicsItem *> items = m_scene->items(point);
-        QModelIndexList indexes;
-        for (QGraphicsItem *item : items) {
-            auto *i = qgraphicsitem_cast<ChartGraphicsItem *>(item);
-            if (i) {
-                QModelIndex index(m_diagram->model()->index(i->row(), i->column(), m_diagram->rootIndex())); // checked
-                if (!indexes.contains(index))
-                    indexes << index;
-            }
-        }
-        return indexes;
-    } else {
+    if (m_entries.isEmpty() || !rectContains(m_bounds, point)) {
         return QModelIndexList();
     }
+    buildGrid();
+
+    int firstColumn, lastColumn, firstRow, lastRow;
+    gridCells(QRectF(point, point), &firstColumn, &lastColumn, &firstRow, &lastRow);
+    const int cell = firstRow * m_gridColumns + firstColumn;
+    QModelIndexList indexes;
+    // the most recently added shapes come first, as they are on top
+    for (int i = m_cellStarts.at(cell + 1) - 1; i >= m_cellStarts.at(cell); --i) {
+        const Entry &entry = m_entries.at(m_cellEntries.at(i));
+        if (rectContains(entry.bounds, point) && contains(entry, point)) {
+            const QModelIndex index = entryIndex(entry);
+            if (!indexes.contains(index))
+                indexes << index;
+        }
+    }
+    return indexes;
 }
 
 QPolygonF ReverseMapper::polygon(int row, int column) const
 {
     if (!m_diagram->model()->hasIndex(row, column, m_diagram->rootIndex()))
         return QPolygon();
-    const QModelIndex index = m_diagram->model()->index(row, column, m_diagram->rootIndex()); // checked
-    return m_itemMap.contains(index) ? m_itemMap[index]->polygon() : QPolygon();
+    const Entry *entry = lastEntry(row, column);
+    return entry ? entryPolygon(*entry) : QPolygon();
 }
 
 QRectF ReverseMapper::boundingRect(int row, int column) const
 {
     if (!m_diagram->model()->hasIndex(row, column, m_diagram->rootIndex()))
         return QRectF();
-    const QModelIndex index = m_diagram->model()->index(row, column, m_diagram->rootIndex()); // checked
-    return m_itemMap.contains(index) ? m_itemMap[index]->polygon().boundingRect() : QRectF();
+    const Entry *entry = lastEntry(row, column);
+    return entry ? entryPolygon(*entry).boundingRect() : QRectF();
 }
 
 void ReverseMapper::addItem(ChartGraphicsItem *item)
 {
-    Q_ASSERT(m_scene);
-    m_scene->addItem(item);
-    m_itemMap.insert(m_diagram->model()->index(item->row(), item->column(), m_diagram->rootIndex()), item); // checked
+    addPolygon(item->row(), item->column(), item->polygon());
+    delete item;
 }
 
 void ReverseMapper::addRect(int row, int column, const QRectF &rect)
 {
-    addPolygon(row, column, QPolygonF(rect));
+    if (!m_enabled) {
+        return;
+    }
+    addEntry(row, column, RectShape, rect.normalized());
 }
 
 void ReverseMapper::addPolygon(int row, int column, const QPolygonF &polygon)
 {
-    auto *item = new ChartGraphicsItem(row, column);
-    item->setPolygon(polygon);
-    addItem(item);
+    if (!m_enabled) {
+        return;
+    }
+    addEntry(row, column, PolygonShape, polygon.boundingRect(), polygon.constData(), polygon.count());
 }
 
 void ReverseMapper::addCircle(int row, int column, const QPointF &location, const QSizeF &diameter)
 {
-    QPainterPath path;
+    if (!m_enabled) {
+        return;
+    }
     QPointF ossfet(-0.5 * diameter.width(), -0.5 * diameter.height());
-    path.addEllipse(QRectF(location + ossfet, diameter));
-    addPolygon(row, column, QPolygonF(path.toFillPolygon()));
+    addEntry(row, column, EllipseShape, QRectF(location + ossfet, diameter).normalized());
 }
 
 void ReverseMapper::addLine(int row, int column, const QPointF &from, const QPointF &to)
 {
+    if (!m_enabled) {
+        return;
+    }
     // that's no line, dude... make a small circle around that point, instead
     if (from == to) {
         addCircle(row, column, from, QSizeF(1.5, 1.5));
         return;
     }
-    // lines do not make good polygons to click on. we calculate a 2
-    // pixel wide rectangle, where the original line is exactly
-    // centered in.
-    // make a 3 pixel wide polygon from the line:
-    QPointF left, right;
-    if (from.x() < to.x()) {
-        left = from;
-        right = to;
+    // only the ends are kept, the band around the line is made when it is hit tested
+    const QPointF points[2] = { from, to };
+    QRectF bounds;
+    bounds.setCoords(qMin(from.x(), to.x()) - LineBandMargin, qMin(from.y(), to.y()) - LineBandMargin,
+                     qMax(from.x(), to.x()) + LineBandMargin, qMax(from.y(), to.y()) + LineBandMargin);
+    addEntry(row, column, LineShape, bounds, points, 2);
+}
+
+void ReverseMapper::addEntry(int row, int column, Shape shape, const QRectF &bounds,
+                             const QPointF *points, int pointCount)
+{
+    const Entry entry = { bounds, row, column, shape, int(m_points.count()), pointCount };
+    m_entries.append(entry);
+    for (int i = 0; i < pointCount; ++i) {
+        m_points.append(points[i]);
+    }
+
+    // not QRectF::united(), which ignores empty rects such as the bounds of straight lines
+    if (m_entries.count() == 1) {
+        m_bounds = bounds;
     } else {
-        right = from;
-        left = to;
+        m_bounds.setCoords(qMin(m_bounds.left(), bounds.left()), qMin(m_bounds.top(), bounds.top()),
+                           qMax(m_bounds.right(), bounds.right()), qMax(m_bounds.bottom(), bounds.bottom()));
     }
-    const QPointF lineVector(right - left);
-    const qreal lineVectorLength = sqrt(lineVector.x() * lineVector.x() + lineVector.y() * lineVector.y());
-    const QPointF lineVectorUnit(lineVector / lineVectorLength);
-    const QPointF normOfLineVectorUnit(-lineVectorUnit.y(), lineVectorUnit.x());
-    // now the four polygon end points:
-    const QPointF one(left - lineVectorUnit + normOfLineVectorUnit);
-    const QPointF two(left - lineVectorUnit - normOfLineVectorUnit);
-    const QPointF three(right + lineVectorUnit - normOfLineVectorUnit);
-    const QPointF four(right + lineVectorUnit + normOfLineVectorUnit);
-    addPolygon(row, column, QPolygonF() << one << two << three << four);
+    m_gridValid = false;
+    m_indexOrderValid = false;
+}
+
+bool ReverseMapper::contains(const Entry &entry, const QPointF &point) const
+{
+    switch (entry.shape) {
+    case RectShape:
+        return true; // the bounds were checked already
+    case EllipseShape: {
+        const qreal rx = entry.bounds.width() / 2;
+        const qreal ry = entry.bounds.height() / 2;
+        if (rx <= 0 || ry <= 0) {
+            return false;
+        }
+        const qreal dx = (point.x() - entry.bounds.center().x()) / rx;
+        const qreal dy = (point.y() - entry.bounds.center().y()) / ry;
+        return dx * dx + dy * dy <= 1.0;
+    }
+    case PolygonShape:
+        return polygonContains(m_points.constData() + entry.firstPoint, entry.pointCount, point);
+    case LineShape: {
+        QPointF band[4];
+        lineBand(m_points.at(entry.firstPoint), m_points.at(entry.firstPoint + 1), band);
+        return polygonContains(band, 4, point);
+    }
+    }
+    return false;
+}
+
+bool ReverseMapper::intersects(const Entry &entry, const QRectF &rect) const
+{
+    if (entry.shape == RectShape) {
+        return true; // the bounds were checked already
+    }
+    return entryPolygon(entry).intersects(QPolygonF(rect));
+}
+
+QPolygonF ReverseMapper::entryPolygon(const Entry &entry) const
+{
+    switch (entry.shape) {
+    case RectShape:
+        return QPolygonF(entry.bounds);
+    case EllipseShape: {
+        QPainterPath path;
+        path.addEllipse(entry.bounds);
+        return path.toFillPolygon();
+    }
+    case PolygonShape: {
+        QPolygonF polygon(entry.pointCount);
+        std::copy(m_points.constBegin() + entry.firstPoint,
+                  m_points.constBegin() + entry.firstPoint + entry.pointCount, polygon.begin());
+        return polygon;
+    }
+    case LineShape: {
+        QPolygonF polygon(4);
+        lineBand(m_points.at(entry.firstPoint), m_points.at(entry.firstPoint + 1), polygon.data());
+        return polygon;
+    }
+    }
+    return QPolygonF();
+}
+
+const ReverseMapper::Entry *ReverseMapper::lastEntry(int row, int column) const
+{
+    const auto less = [this](int a, int b) {
+        const Entry &ea = m_entries.at(a);
+        const Entry &eb = m_entries.at(b);
+        if (ea.row != eb.row)
+            return ea.row < eb.row;
+        return ea.column < eb.column;
+    };
+    if (!m_indexOrderValid) {
+        m_indexOrder.resize(m_entries.count());
+        for (int i = 0; i < m_indexOrder.count(); ++i) {
+            m_indexOrder[i] = i;
+        }
+        // stable, so that the most recently added entry of a cell comes last
+        std::stable_sort(m_indexOrder.begin(), m_indexOrder.end(), less);
+        m_indexOrderValid = true;
+    }
+
+    const auto after = std::upper_bound(m_indexOrder.constBegin(), m_indexOrder.constEnd(), qMakePair(row, column),
+                                        [this](const QPair<int, int> &cell, int entryNumber) {
+                                            const Entry &entry = m_entries.at(entryNumber);
+                                            if (cell.first != entry.row)
+                                                return cell.first < entry.row;
+                                            return cell.second < entry.column;
+                                        });
+    if (after == m_indexOrder.constBegin()) {
+        return nullptr;
+    }
+    const Entry &entry = m_entries.at(*(after - 1));
+    return entry.row == row && entry.column == column ? &entry : nullptr;
+}
+
+QModelIndex ReverseMapper::entryIndex(const Entry &entry) const
+{
+    return m_diagram->model()->index(entry.row, entry.column, m_diagram->rootIndex()); // checked
+}
+
+void ReverseMapper::buildGrid() const
+{
+    if (m_gridValid) {
+        return;
+    }
+    // about two entries per cell for shapes spread evenly
+    const int side = qBound(1, int(ceil(sqrt(m_entries.count() / 2.0))), MaxGridSide);
+    m_gridColumns = side;
+    m_gridRows = side;
+
+    // count the entries of each cell first, then fill them in
+    m_cellStarts.fill(0, m_gridColumns * m_gridRows + 1);
+    for (const Entry &entry : m_entries) {
+        int firstColumn, lastColumn, firstRow, lastRow;
+        gridCells(entry.bounds, &firstColumn, &lastColumn, &firstRow, &lastRow);
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int column = firstColumn; column <= lastColumn; ++column) {
+                ++m_cellStarts[row * m_gridColumns + column + 1];
+            }
+        }
+    }
+    for (int cell = 0; cell < m_gridColumns * m_gridRows; ++cell) {
+        m_cellStarts[cell + 1] += m_cellStarts.at(cell);
+    }
+    m_cellEntries.resize(m_cellStarts.last());
+    QVector<int> next = m_cellStarts;
+    for (int i = 0; i < m_entries.count(); ++i) {
+        int firstColumn, lastColumn, firstRow, lastRow;
+        gridCells(m_entries.at(i).bounds, &firstColumn, &lastColumn, &firstRow, &lastRow);
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int column = firstColumn; column <= lastColumn; ++column) {
+                m_cellEntries[next[row * m_gridColumns + column]++] = i;
+            }
+        }
+    }
+    m_gridValid = true;
+}
+
+void ReverseMapper::gridCells(const QRectF &rect, int *firstColumn, int *lastColumn, int *firstRow, int *lastRow) const
+{
+    const qreal cellWidth = m_bounds.width() / m_gridColumns;
+    const qreal cellHeight = m_bounds.height() / m_gridRows;
+    // bounded before converting to int, so that coordinates far off the grid do not overflow
+    const auto gridColumn = [&](qreal x) {
+        return cellWidth > 0 ? int(qBound(qreal(0), (x - m_bounds.left()) / cellWidth, qreal(m_gridColumns - 1))) : 0;
+    };
+    const auto gridRow = [&](qreal y) {
+        return cellHeight > 0 ? int(qBound(qreal(0), (y - m_bounds.top()) / cellHeight, qreal(m_gridRows - 1))) : 0;
+    };
+    *firstColumn = gridColumn(rect.left());
+    *lastColumn = gridColumn(rect.right());
+    *firstRow = gridRow(rect.top());
+    *lastRow = gridRow(rect.bottom());
 }
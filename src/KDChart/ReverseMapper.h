@@ -11,12 +11,12 @@
 #ifndef REVERSEMAPPER_H
 #define REVERSEMAPPER_H
 
-#include <QHash>
 #include <QModelIndex>
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
 
 QT_BEGIN_NAMESPACE
-class QRectF;
-class QGraphicsScene;
 class QPolygonF;
 QT_END_NAMESPACE
 
@@ -27,6 +27,12 @@ class ChartGraphicsItem;
 
 /**
  * @brief The ReverseMapper stores information about objects on a chart and their respective model indexes
+ *
+ * The shapes are kept in flat arrays, so adding one does not allocate anything
+ * on its own, and lines are kept as their two ends only. The grid used to find
+ * the shapes at a point or in a rect is built on the first lookup after shapes
+ * were added, so painting a diagram that is never clicked or hovered costs
+ * little more than recording the shapes.
  * \internal
  */
 class ReverseMapper
@@ -39,6 +45,10 @@ public:
 
     void setDiagram(AbstractDiagram *diagram);
 
+    // while disabled, nothing is added and no shapes are found
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
     void clear();
 
     QModelIndexList indexesAt(const QPointF &point) const;
@@ -47,6 +57,7 @@ public:
     QPolygonF polygon(int row, int column) const;
     QRectF boundingRect(int row, int column) const;
 
+    // takes the polygon, row and column of item, and deletes it
     void addItem(ChartGraphicsItem *item);
 
     // convenience methods:
@@ -56,9 +67,52 @@ public:
     void addLine(int row, int column, const QPointF &from, const QPointF &to);
 
 private:
-    QGraphicsScene *m_scene = nullptr;
+    enum Shape
+    {
+        PolygonShape,
+        RectShape,
+        EllipseShape,
+        LineShape
+    };
+
+    struct Entry
+    {
+        QRectF bounds;
+        int row;
+        int column;
+        Shape shape;
+        // the corners of a PolygonShape, or the ends of a LineShape, in m_points
+        int firstPoint;
+        int pointCount;
+    };
+
+    void addEntry(int row, int column, Shape shape, const QRectF &bounds,
+                  const QPointF *points = nullptr, int pointCount = 0);
+    bool contains(const Entry &entry, const QPointF &point) const;
+    bool intersects(const Entry &entry, const QRectF &rect) const;
+    QPolygonF entryPolygon(const Entry &entry) const;
+    const Entry *lastEntry(int row, int column) const;
+    QModelIndex entryIndex(const Entry &entry) const;
+
+    void buildGrid() const;
+    void gridCells(const QRectF &rect, int *firstColumn, int *lastColumn, int *firstRow, int *lastRow) const;
+
     AbstractDiagram *m_diagram = nullptr;
-    QHash<QModelIndex, ChartGraphicsItem *> m_itemMap;
+    bool m_enabled = true;
+    QVector<Entry> m_entries;
+    QVector<QPointF> m_points;
+    // the union of the bounds of all entries
+    QRectF m_bounds;
+
+    // the entries overlapping each grid cell, in the order they were added
+    mutable QVector<int> m_cellStarts;
+    mutable QVector<int> m_cellEntries;
+    mutable int m_gridColumns = 0;
+    mutable int m_gridRows = 0;
+    mutable bool m_gridValid = false;
+    // the entries ordered by row, column and age, for polygon() and boundingRect()
+    mutable QVector<int> m_indexOrder;
+    mutable bool m_indexOrderValid = false;
 };
 }
 
@@ -71,10 +71,10 @@ void TernaryAxis::paintCtx(PaintContext *paintContext)
         m_fifty,
     };
     for (PrerenderedLabel *label : labels) {
-        const QPixmap &pixmap = label->pixmap();
+        label->setDevicePixelRatio(p->device()->devicePixelRatioF());
         QPointF point = plane->translate(label->position())
             - label->referencePointLocation();
-        p->drawPixmap(point, pixmap);
+        label->draw(p, point);
     }
 }
 
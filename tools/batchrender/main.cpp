@@ -0,0 +1,109 @@
+/****************************************************************************
+**
+** This file is part of the KD Chart library.
+**
+** SPDX-FileCopyrightText: 2001 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+**
+** SPDX-License-Identifier: MIT
+**
+****************************************************************************/
+
+// Renders the charts described in JSON files, see KDChart::BatchRenderer::readJobs().
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include <KDChartBatchRenderer>
+
+#include <cstdio>
+
+using namespace KDChart;
+
+static QString milliseconds(qint64 nanoseconds)
+{
+    return QString::number(nanoseconds / 1e6, 'f', 1);
+}
+
+int main(int argc, char **argv)
+{
+    // the charts are never shown, so a display is not needed
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    QApplication::setApplicationName(QStringLiteral("kdchart-batchrender"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Renders the charts described in JSON job files "
+                                                    "into images, PDF and SVG files."));
+    parser.addHelpOption();
+    const QCommandLineOption threadsOption(QStringList() << QStringLiteral("j") << QStringLiteral("threads"),
+                                           QStringLiteral("Render on <count> threads, by default one per core."),
+                                           QStringLiteral("count"));
+    parser.addOption(threadsOption);
+    const QCommandLineOption quietOption(QStringList() << QStringLiteral("q") << QStringLiteral("quiet"),
+                                         QStringLiteral("Only report failed jobs and the summary."));
+    parser.addOption(quietOption);
+    parser.addPositionalArgument(QStringLiteral("jobs"), QStringLiteral("The JSON job files."),
+                                 QStringLiteral("jobs..."));
+    parser.process(app);
+
+    const QStringList jobFiles = parser.positionalArguments();
+    if (jobFiles.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QVector<BatchRenderer::Job> jobs;
+    for (const QString &jobFile : jobFiles) {
+        QString errorString;
+        const QVector<BatchRenderer::Job> fileJobs = BatchRenderer::readJobs(jobFile, &errorString);
+        if (!errorString.isEmpty()) {
+            err << errorString << Qt::endl;
+            return 1;
+        }
+        jobs += fileJobs;
+    }
+
+    BatchRenderer renderer;
+    if (parser.isSet(threadsOption)) {
+        bool ok = false;
+        const int threads = parser.value(threadsOption).toInt(&ok);
+        if (!ok || threads < 1) {
+            err << "Invalid thread count: " << parser.value(threadsOption) << Qt::endl;
+            return 1;
+        }
+        renderer.setMaxThreadCount(threads);
+    }
+
+    const bool quiet = parser.isSet(quietOption);
+    int failedJobs = 0;
+    QObject::connect(&renderer, &BatchRenderer::jobFinished, [&](const BatchRenderer::JobResult &result) {
+        const BatchRenderer::Job &job = jobs.at(result.job);
+        if (!result.success) {
+            ++failedJobs;
+            err << "FAILED " << job.dataFile << ": " << result.errorString << Qt::endl;
+        } else if (!quiet) {
+            out << job.outputFile
+                << "  load " << milliseconds(result.loadTime) << " ms"
+                << "  layout " << milliseconds(result.layoutTime) << " ms"
+                << "  paint " << milliseconds(result.paintTime) << " ms"
+                << "  write " << milliseconds(result.writeTime) << " ms" << Qt::endl;
+        }
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    renderer.render(jobs);
+    const qreal seconds = timer.nsecsElapsed() / 1e9;
+
+    out << jobs.count() << " jobs on " << renderer.maxThreadCount() << " threads in "
+        << QString::number(seconds, 'f', 2) << " s ("
+        << QString::number(seconds > 0 ? jobs.count() / seconds : 0, 'f', 1) << " jobs/s), "
+        << failedJobs << " failed" << Qt::endl;
+    return failedJobs ? 1 : 0;
+}